@@ -1,13 +1,17 @@
 #include "pdptw/ages/ages_solver.hpp"
 #include "pdptw/construction/constructor.hpp"
+#include "pdptw/construction/insertion.hpp"
+#include "pdptw/io/instance_cache.hpp"
 #include "pdptw/io/li_lim_reader.hpp"
 #include "pdptw/io/sartori_buriol_reader.hpp"
 #include "pdptw/io/sintef_solution.hpp"
 #include "pdptw/lns/largescale/decomposition_lns.hpp"
 #include "pdptw/problem/pdptw.hpp"
+#include "pdptw/refn/ref_batch.hpp"
 #include "pdptw/solution/datastructure.hpp"
 #include "pdptw/solution/description.hpp"
 #include "pdptw/solver/lns_solver.hpp"
+#include "pdptw/solver/parallel_lns_solver.hpp"
 #include "pdptw/utils/logging.hpp"
 #include "pdptw/utils/time_limit.hpp"
 #include "pdptw/utils/validator.hpp"
@@ -48,11 +52,22 @@ int main(int argc, char **argv) {
     bool use_k_ejection = true;
     bool use_perturbation = true;
 
+    size_t granular_k = 0;
+    double blink_rate = 0.05;
+    bool repair_cutoff = false;
+    bool deterministic = false;
+    std::string operator_selection = "round-robin"; // round-robin, adaptive
+    size_t lns_threads = 1;
+    size_t speculative_candidates = 1;
+    int sync_interval = 500;
+    std::string insertion_backend = "scalar"; // scalar, batch, avx2
+
     // Solution metadata
     std::string authors = "PDPTW Solver";
     std::string reference = "LNS with SA/RTR";
 
     size_t max_vehicles = 0;
+    std::string instance_cache_dir;
 
     app.add_option("-i,--instance", instance_file, "Instance file path (Li-Lim/SINTEF format)")
         ->required()
@@ -65,6 +80,9 @@ int main(int argc, char **argv) {
     app.add_option("-o,--output", output_dir, "Output directory for solutions")
         ->default_val("solutions");
 
+    app.add_option("--instance-cache", instance_cache_dir,
+                   "Directory for preprocessed binary instances (.pdptwbin), reused when the source file is unchanged");
+
     app.add_option("--iterations", max_iterations, "Maximum LNS iterations")
         ->default_val(100000);
 
@@ -114,6 +132,48 @@ int main(int argc, char **argv) {
     app.add_flag("--k-ejection,!--no-k-ejection", use_k_ejection, "Enable/Disable k-ejection in AGES (default: enabled)");
     app.add_flag("--perturbation,!--no-perturbation", use_perturbation, "Enable/Disable perturbation in AGES (default: enabled)");
 
+    app.add_option("--granular-k", granular_k,
+                   "Granular insertion: k nearest time-compatible neighbors per node (0=off)")
+        ->default_val(0);
+
+    app.add_option("--blink-rate", blink_rate,
+                   "Blink repair: probability of skipping each insertion position")
+        ->default_val(0.05)
+        ->check(CLI::Range(0.0, 1.0));
+
+    app.add_flag("--deterministic", deterministic,
+                 "Reproducible search: per-operator RNG streams from --seed "
+                 "(runs bounded by --iterations, not --time-limit)");
+
+    app.add_flag("--repair-cutoff,!--no-repair-cutoff", repair_cutoff,
+                 "Stop LNS repair early once the solution can no longer be accepted; only exact when "
+                 "the travel matrix satisfies the triangle inequality (default: disabled)");
+
+    app.add_option("--operator-selection", operator_selection,
+                   "LNS operator selection: round-robin, adaptive (roulette on improvement per use)")
+        ->default_val("round-robin")
+        ->check(CLI::IsMember({"adaptive", "round-robin"}));
+
+    app.add_option("--insertion-backend", insertion_backend,
+                   "Insertion evaluation: scalar, batch (SoA kernel), avx2 (falls back to batch if unavailable)")
+        ->default_val("scalar")
+        ->check(CLI::IsMember({"scalar", "batch", "avx2"}));
+
+    app.add_option("--threads", lns_threads,
+                   "LNS workers with different seeds/acceptance sharing the best solution (1=single solver)")
+        ->default_val(1)
+        ->check(CLI::Range(1, 256));
+
+    app.add_option("--sync-interval", sync_interval,
+                   "Parallel LNS: iterations between restarts from the shared best (0=never)")
+        ->default_val(500)
+        ->check(CLI::NonNegativeNumber);
+
+    app.add_option("--speculative", speculative_candidates,
+                   "LNS candidates generated in parallel from the current solution per iteration (1=off)")
+        ->default_val(1)
+        ->check(CLI::Range(1, 256));
+
     app.add_option("--max-vehicles", max_vehicles, "Maximum vehicles (0=auto)")
         ->default_val(0);
 
@@ -151,22 +211,39 @@ int main(int argc, char **argv) {
 
     auto start_time = std::chrono::high_resolution_clock::now();
 
+    if (insertion_backend == "batch") {
+        construction::Insertion::set_evaluation_backend(construction::EvaluationBackend::Batch);
+    } else if (insertion_backend == "avx2") {
+        if (!refn::avx2_available()) {
+            spdlog::warn("AVX2 kernel not available (build with -DENABLE_AVX2=ON on an AVX2 CPU), using batch");
+        }
+        construction::Insertion::set_evaluation_backend(construction::EvaluationBackend::BatchAvx2);
+    }
+
     // Load Instance
     spdlog::info("Loading instance: {}", instance_file);
 
-    problem::PDPTWInstance instance;
-    try {
+    auto parse_instance = [&]() -> problem::PDPTWInstance {
         if (format == "lilim") {
-            instance = io::load_li_lim_instance(instance_file, max_vehicles);
+            return io::load_li_lim_instance(instance_file, max_vehicles);
         } else if (format == "sartori") {
-            instance = io::load_sartori_buriol_instance(instance_file, max_vehicles);
+            return io::load_sartori_buriol_instance(instance_file, max_vehicles);
+        }
+        try {
+            return io::load_li_lim_instance(instance_file, max_vehicles);
+        } catch (const std::exception &e) {
+            spdlog::info("Failed to load as Li & Lim format ({}), trying Sartori & Buriol format...", e.what());
+            return io::load_sartori_buriol_instance(instance_file, max_vehicles);
+        }
+    };
+
+    problem::PDPTWInstance instance;
+    try {
+        if (!instance_cache_dir.empty()) {
+            instance = io::load_instance_with_cache(instance_file, instance_cache_dir,
+                                                    max_vehicles, parse_instance);
         } else {
-            try {
-                instance = io::load_li_lim_instance(instance_file, max_vehicles);
-            } catch (const std::exception &e) {
-                spdlog::info("Failed to load as Li & Lim format ({}), trying Sartori & Buriol format...", e.what());
-                instance = io::load_sartori_buriol_instance(instance_file, max_vehicles);
-            }
+            instance = parse_instance();
         }
     } catch (const std::exception &e) {
         spdlog::error("Failed to load instance: {}", e.what());
@@ -175,7 +252,8 @@ int main(int argc, char **argv) {
 
     std::string instance_name = fs::path(instance_file).stem().string();
 
-    spdlog::info("Instance: {} ({} requests, {} vehicles)", instance_name, instance.num_requests(), instance.num_vehicles());
+    spdlog::info("Instance: {} ({} requests, {} vehicles, traits: {})", instance_name, instance.num_requests(),
+                 instance.num_vehicles(), problem::to_string(instance.traits()));
 
     // Construct Initial Solution
     construction::ConstructionStrategy strategy = construction::ConstructionStrategy::SequentialInsertion;
@@ -210,6 +288,17 @@ int main(int argc, char **argv) {
         lns_params.max_destroy_requests = max_destroy_count;
     }
     lns_params.seed = seed;
+    lns_params.granular_k = granular_k;
+    lns_params.blink_rate = blink_rate;
+    lns_params.repair_cutoff = repair_cutoff;
+    lns_params.deterministic = deterministic;
+    if (deterministic && time_limit_seconds > 0.0) {
+        spdlog::warn("--deterministic with --time-limit: the run stops at a load-dependent iteration");
+    }
+    lns_params.speculative_candidates = speculative_candidates;
+    lns_params.operator_selection = operator_selection == "round-robin"
+                                        ? LNSSolverParams::OperatorSelection::ROUND_ROBIN
+                                        : LNSSolverParams::OperatorSelection::ADAPTIVE;
     lns_params.verbose = (log_level == "info" || log_level == "debug" || log_level == "trace");
     lns_params.log_frequency = 50;
 
@@ -243,6 +332,7 @@ int main(int argc, char **argv) {
     ages_params.shift_probability = 0.5;
     ages_params.use_k_ejection = use_k_ejection;
     ages_params.use_perturbation = use_perturbation;
+    ages_params.granular_k = granular_k;
 
     ages::AGESSolver ages_solver(instance, ages_params);
     utils::TimeLimit *limit_ptr = overall_time_limit ? &*overall_time_limit : nullptr;
@@ -273,9 +363,19 @@ int main(int argc, char **argv) {
     if (!skip_lns) {
         spdlog::info("Starting LNS optimization...");
 
-        LNSSolver solver(instance, lns_params);
-        final_solution = solver.solve(initial_solution);
-        stats = solver.get_statistics();
+        if (lns_threads > 1) {
+            ParallelLNSSolverParams parallel_params;
+            parallel_params.base = lns_params;
+            parallel_params.num_threads = lns_threads;
+            parallel_params.sync_interval = sync_interval;
+            ParallelLNSSolver solver(instance, parallel_params);
+            final_solution = solver.solve(initial_solution);
+            stats = solver.get_statistics();
+        } else {
+            LNSSolver solver(instance, lns_params);
+            final_solution = solver.solve(initial_solution);
+            stats = solver.get_statistics();
+        }
         ran_lns = true;
 
         // Large-scale decomposition LNS for instances >= 150 requests
@@ -0,0 +1,159 @@
+#pragma once
+
+#include "pdptw/io/sartori_buriol_reader.hpp"
+#include "pdptw/problem/pdptw.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#endif
+
+namespace pdptw::bench {
+
+// Peak resident set size của process (byte), 0 nếu không đo được
+inline size_t peak_rss_bytes() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters{};
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return counters.PeakWorkingSetSize;
+    }
+    return 0;
+#else
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.rfind("VmHWM:", 0) == 0) {
+            return static_cast<size_t>(std::strtoull(line.c_str() + 6, nullptr, 10)) * 1024;
+        }
+    }
+    return 0;
+#endif
+}
+
+// Đồng hồ bấm giờ đơn giản cho benchmark
+class Stopwatch {
+public:
+    Stopwatch() : start_(std::chrono::steady_clock::now()) {}
+
+    void reset() { start_ = std::chrono::steady_clock::now(); }
+
+    double elapsed_ms() const {
+        return std::chrono::duration<double, std::milli>(
+                   std::chrono::steady_clock::now() - start_)
+            .count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point start_;
+};
+
+// Ghi instance tổng hợp theo định dạng Sartori & Buriol:
+// các cụm điểm trong vùng 60x60 phút, ma trận nguyên, time == distance
+inline void write_synthetic_sartori(const std::string &path,
+                                    size_t num_requests,
+                                    unsigned seed = 7) {
+    const size_t num_nodes = 2 * num_requests + 1;
+    const int horizon = 480;
+    const int window = 60;
+    const int service = 15;
+
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> coord(0.0, 60.0);
+    std::normal_distribution<double> spread(0.0, 4.0);
+
+    std::vector<std::pair<double, double>> centers(12);
+    for (auto &c : centers) {
+        c = {coord(rng), coord(rng)};
+    }
+
+    std::vector<std::pair<double, double>> pos(num_nodes);
+    pos[0] = {30.0, 30.0};
+    std::uniform_int_distribution<size_t> pick_center(0, centers.size() - 1);
+    for (size_t i = 1; i < num_nodes; ++i) {
+        const auto &c = centers[pick_center(rng)];
+        pos[i] = {std::clamp(c.first + spread(rng), 0.0, 60.0),
+                  std::clamp(c.second + spread(rng), 0.0, 60.0)};
+    }
+
+    auto travel = [&](size_t a, size_t b) {
+        double dx = pos[a].first - pos[b].first;
+        double dy = pos[a].second - pos[b].second;
+        return static_cast<int>(std::lround(std::sqrt(dx * dx + dy * dy)));
+    };
+
+    std::ofstream out(path);
+    out << "NAME: synthetic-n" << num_requests << "\n"
+        << "LOCATION: Synthetic\n"
+        << "COMMENT: generated by pdptw benchmarks\n"
+        << "TYPE: PDPTW\n"
+        << "SIZE: " << num_nodes << "\n"
+        << "DISTRIBUTION: cluster\n"
+        << "DEPOT: central\n"
+        << "ROUTE-TIME: " << horizon << "\n"
+        << "TIME-WINDOW: " << window << "\n"
+        << "CAPACITY: 100\n"
+        << "NODES\n";
+    out << "0 " << pos[0].first << " " << pos[0].second << " 0 0 " << horizon << " 0 0 0\n";
+
+    std::uniform_int_distribution<int> demand(5, 30);
+    std::vector<std::string> lines(num_nodes);
+    for (size_t r = 0; r < num_requests; ++r) {
+        size_t p = r + 1;
+        size_t d = r + 1 + num_requests;
+        int t0p = travel(0, p);
+        int tpd = travel(p, d);
+        int td0 = travel(d, 0);
+        int latest_start = horizon - window - t0p - tpd - td0 - 2 * service;
+        std::uniform_int_distribution<int> start(0, std::max(0, latest_start));
+        int ep = t0p + start(rng);
+        int ed = ep + service + tpd;
+        int q = demand(rng);
+        lines[p] = std::to_string(p) + " " + std::to_string(pos[p].first) + " " +
+                   std::to_string(pos[p].second) + " " + std::to_string(q) + " " +
+                   std::to_string(ep) + " " + std::to_string(ep + window) + " " +
+                   std::to_string(service) + " 0 " + std::to_string(d);
+        lines[d] = std::to_string(d) + " " + std::to_string(pos[d].first) + " " +
+                   std::to_string(pos[d].second) + " " + std::to_string(-q) + " " +
+                   std::to_string(ed) + " " + std::to_string(ed + window) + " " +
+                   std::to_string(service) + " " + std::to_string(p) + " 0";
+    }
+    for (size_t i = 1; i < num_nodes; ++i) {
+        out << lines[i] << "\n";
+    }
+
+    out << "EDGES\n";
+    for (size_t i = 0; i < num_nodes; ++i) {
+        for (size_t j = 0; j < num_nodes; ++j) {
+            out << travel(i, j) << (j + 1 < num_nodes ? " " : "\n");
+        }
+    }
+}
+
+// Trả về đường dẫn instance: argv[1] nếu có, ngược lại sinh file tổng hợp trong thư mục tạm
+inline std::string instance_path_from_args(int argc, char **argv, size_t default_requests) {
+    if (argc > 1) {
+        return argv[1];
+    }
+    auto path = std::filesystem::temp_directory_path() /
+                ("pdptw-bench-n" + std::to_string(default_requests) + ".txt");
+    if (!std::filesystem::exists(path)) {
+        std::printf("Generating synthetic instance with %zu requests: %s\n",
+                    default_requests, path.string().c_str());
+        write_synthetic_sartori(path.string(), default_requests);
+    }
+    return path.string();
+}
+
+} // namespace pdptw::bench
@@ -0,0 +1,180 @@
+// Benchmark đánh giá chèn: tra cứu ma trận, find_best_insertion và các backend đánh giá
+//
+// Usage: bench_insertion [instance.txt] [rounds]
+//   Không có instance → sinh instance tổng hợp 1000 request (định dạng Sartori)
+
+#include "bench_common.hpp"
+
+#include "pdptw/construction/constructor.hpp"
+#include "pdptw/construction/insertion.hpp"
+#include "pdptw/problem/granular_neighborhood.hpp"
+#include "pdptw/refn/ref_batch.hpp"
+#include "pdptw/solution/datastructure.hpp"
+
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace pdptw;
+
+namespace {
+
+// Layout cũ (vector lồng nhau theo node, hai ma trận riêng) để so sánh
+struct NestedMatrix {
+    std::vector<std::vector<double>> distances;
+    std::vector<std::vector<double>> times;
+};
+
+NestedMatrix copy_to_nested(const problem::PDPTWInstance &instance) {
+    size_t n = instance.nodes().size();
+    NestedMatrix nested{std::vector<std::vector<double>>(n, std::vector<double>(n)),
+                        std::vector<std::vector<double>>(n, std::vector<double>(n))};
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+            nested.distances[i][j] = instance.distance(i, j);
+            nested.times[i][j] = instance.time(i, j);
+        }
+    }
+    return nested;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    std::string path = bench::instance_path_from_args(argc, argv, 1000);
+    int rounds = argc > 2 ? std::atoi(argv[2]) : 5;
+
+    bench::Stopwatch load_timer;
+    auto instance = io::load_sartori_buriol_instance(path);
+    std::printf("Instance %s: %zu requests, %zu vehicles, loaded in %.1f ms\n",
+                instance.name().c_str(), instance.num_requests(), instance.num_vehicles(),
+                load_timer.elapsed_ms());
+
+    // 1. Tra cứu (distance, time) theo thứ tự ngẫu nhiên giữa các request node
+    NestedMatrix nested = copy_to_nested(instance);
+    const size_t first_request_node = 2 * instance.num_vehicles();
+    const size_t num_nodes = instance.nodes().size();
+
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<size_t> pick(first_request_node, num_nodes - 1);
+    std::vector<std::pair<size_t, size_t>> pairs(1 << 20);
+    for (auto &p : pairs) {
+        p = {pick(rng), pick(rng)};
+    }
+
+    double sink = 0.0;
+    bench::Stopwatch timer;
+    for (int r = 0; r < rounds; ++r) {
+        for (const auto &[from, to] : pairs) {
+            sink += nested.distances.at(from).at(to) + nested.times.at(from).at(to);
+        }
+    }
+    double nested_ms = timer.elapsed_ms();
+
+    timer.reset();
+    for (int r = 0; r < rounds; ++r) {
+        for (const auto &[from, to] : pairs) {
+            auto dt = instance.distance_and_time(from, to);
+            sink += dt.distance + dt.time;
+        }
+    }
+    double flat_ms = timer.elapsed_ms();
+
+    double lookups = static_cast<double>(pairs.size()) * rounds;
+    std::printf("Arc lookups: nested+checked %.2f ns/lookup, flat+unchecked %.2f ns/lookup (%.2fx)\n",
+                nested_ms * 1e6 / lookups, flat_ms * 1e6 / lookups, nested_ms / flat_ms);
+
+    // 2. Đánh giá chèn trên giải pháp đã xây dựng
+    timer.reset();
+    auto solution = construction::Constructor::sequential_construction(instance);
+    std::printf("Sequential construction: %.1f ms, %zu routes, %zu unassigned\n",
+                timer.elapsed_ms(), solution.number_of_non_empty_routes(),
+                solution.unassigned_requests().count());
+
+    // Gỡ 10% request để làm tập cần chèn lại
+    std::vector<size_t> removed;
+    for (size_t r = 0; r < instance.num_requests(); r += 10) {
+        size_t pickup = instance.pickup_id_of_request(r);
+        if (solution.is_request_assigned(r)) {
+            solution.unassign_request(pickup);
+            removed.push_back(r);
+        }
+    }
+
+    timer.reset();
+    size_t feasible = 0;
+    construction::InsertionStats stats;
+    for (int r = 0; r < rounds; ++r) {
+        for (size_t request : removed) {
+            auto candidate = construction::Insertion::find_best_insertion(
+                solution, request, construction::InsertionStrategy::BestCost, &stats);
+            feasible += candidate.feasible ? 1 : 0;
+        }
+    }
+    double eval_ms = timer.elapsed_ms();
+    double evaluations = static_cast<double>(removed.size()) * rounds;
+    std::printf("find_best_insertion: %zu requests x %d rounds, %.1f us/request (%zu feasible)\n",
+                removed.size(), rounds, eval_ms * 1e3 / evaluations, feasible);
+    std::printf("  routes scanned %zu, pruned %zu; positions checked %zu, pruned %zu\n",
+                stats.routes_scanned, stats.routes_pruned, stats.positions_checked, stats.positions_pruned);
+
+    // Granular: chỉ các khe kề k láng giềng gần nhất
+    const size_t granular_k = 20;
+    timer.reset();
+    problem::GranularNeighborhood granular(instance, granular_k);
+    double granular_build_ms = timer.elapsed_ms();
+
+    timer.reset();
+    size_t granular_feasible = 0;
+    construction::InsertionStats granular_stats;
+    for (int r = 0; r < rounds; ++r) {
+        for (size_t request : removed) {
+            auto candidate = construction::Insertion::find_best_insertion(
+                solution, request, construction::InsertionStrategy::BestCost, &granular_stats, &granular);
+            granular_feasible += candidate.feasible ? 1 : 0;
+            sink += candidate.feasible ? candidate.cost_increase : 0.0;
+        }
+    }
+    double granular_ms = timer.elapsed_ms();
+    std::printf("granular k=%zu (built in %.1f ms): %.1f us/request (%zu feasible), positions checked %zu\n",
+                granular_k, granular_build_ms, granular_ms * 1e3 / evaluations, granular_feasible,
+                granular_stats.positions_checked);
+
+    // Backend đánh giá: vị trí (pickup_after, delivery_after) đã đánh giá mỗi giây trên mọi route
+    struct BackendRun {
+        const char *name;
+        construction::EvaluationBackend backend;
+    };
+    std::vector<BackendRun> backend_runs = {{"scalar", construction::EvaluationBackend::Scalar},
+                                            {"batch", construction::EvaluationBackend::Batch}};
+    if (refn::avx2_available()) {
+        backend_runs.push_back({"avx2", construction::EvaluationBackend::BatchAvx2});
+    } else {
+        std::printf("AVX2 kernel not available (build with -DENABLE_AVX2=ON)\n");
+    }
+
+    std::vector<construction::InsertionCandidate> scratch;
+    for (const auto &run : backend_runs) {
+        construction::Insertion::set_evaluation_backend(run.backend);
+        size_t positions = 0;
+        size_t found = 0;
+        timer.reset();
+        for (int r = 0; r < rounds; ++r) {
+            for (size_t request : removed) {
+                for (size_t v = 0; v < instance.num_vehicles(); ++v) {
+                    scratch.clear();
+                    positions += construction::Insertion::find_insertions_in_route(solution, request, v, scratch);
+                    found += scratch.size();
+                    sink += scratch.empty() ? 0.0 : scratch.front().cost_increase;
+                }
+            }
+        }
+        double backend_ms = timer.elapsed_ms();
+        std::printf("backend %-6s: %.2f M positions/s (%zu positions, %zu feasible, %.1f ms)\n",
+                    run.name, positions / (backend_ms * 1e3), positions, found, backend_ms);
+    }
+    construction::Insertion::set_evaluation_backend(construction::EvaluationBackend::Scalar);
+
+    std::printf("(checksum %.1f)\n", sink);
+    return 0;
+}
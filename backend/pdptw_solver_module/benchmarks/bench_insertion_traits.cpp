@@ -0,0 +1,92 @@
+// Benchmark các biến thể đánh giá chèn chuyên biệt theo InstanceTraits
+//
+// Usage: bench_insertion_traits [instance.txt] [rounds]
+//   Không có instance → sinh instance tổng hợp 1000 request (định dạng Sartori)
+//   Với từng tập trait (chỉ giữ các trait instance thực sự có), gỡ 10% request khỏi lời
+//   giải sequential rồi đo find_top_insertions: đường tổng quát so với biến thể chuyên biệt
+
+#include "bench_common.hpp"
+
+#include "pdptw/construction/constructor.hpp"
+#include "pdptw/construction/insertion.hpp"
+#include "pdptw/solution/datastructure.hpp"
+
+#include <cstdio>
+#include <utility>
+#include <vector>
+
+using namespace pdptw;
+
+namespace {
+
+double time_top_insertions(const solution::Solution &solution, const std::vector<size_t> &requests,
+                           int rounds, double &checksum) {
+    construction::InsertionTopK top(3);
+    bench::Stopwatch timer;
+    for (int r = 0; r < rounds; ++r) {
+        for (size_t request : requests) {
+            construction::Insertion::find_top_insertions(solution, request, top);
+            for (size_t i = 0; i < top.size(); ++i) {
+                checksum += top[i].cost_increase;
+            }
+        }
+    }
+    return timer.elapsed_ms() / rounds;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    std::string path = bench::instance_path_from_args(argc, argv, 1000);
+    int rounds = argc > 2 ? std::atoi(argv[2]) : 3;
+
+    auto instance = io::load_sartori_buriol_instance(path);
+    std::printf("Instance %s: %zu requests, traits: %s\n", instance.name().c_str(),
+                instance.num_requests(), problem::to_string(instance.traits()).c_str());
+
+    problem::InstanceTraits all;
+    all.capacity_unbounded = all.symmetric = all.time_equals_distance = true;
+    problem::InstanceTraits capacity;
+    capacity.capacity_unbounded = true;
+    problem::InstanceTraits symmetric;
+    symmetric.symmetric = true;
+    problem::InstanceTraits time_is_distance;
+    time_is_distance.time_equals_distance = true;
+    const std::vector<std::pair<const char *, problem::InstanceTraits>> configs = {
+        {"none", problem::InstanceTraits()},
+        {"capacity unbounded", capacity},
+        {"symmetric", symmetric},
+        {"time == distance", time_is_distance},
+        {"all detected", all},
+    };
+
+    const bool saved = construction::Insertion::specialized_evaluation();
+    std::printf("%-20s %-40s %12s %14s %8s\n", "config", "active traits", "generic ms", "specialized ms",
+                "speedup");
+    for (const auto &[label, mask] : configs) {
+        auto restricted = instance;
+        restricted.restrict_traits(mask);
+        auto solution = construction::Constructor::sequential_construction(restricted);
+
+        std::vector<size_t> removed;
+        for (size_t r = 0; r < restricted.num_requests(); r += 10) {
+            if (solution.is_request_assigned(r)) {
+                solution.unassign_request(restricted.pickup_id_of_request(r));
+                removed.push_back(r);
+            }
+        }
+
+        double generic_sum = 0.0;
+        double specialized_sum = 0.0;
+        construction::Insertion::set_specialized_evaluation(false);
+        double generic_ms = time_top_insertions(solution, removed, rounds, generic_sum);
+        construction::Insertion::set_specialized_evaluation(true);
+        double specialized_ms = time_top_insertions(solution, removed, rounds, specialized_sum);
+
+        std::printf("%-20s %-40s %12.2f %14.2f %7.2fx%s\n", label,
+                    problem::to_string(restricted.traits()).c_str(), generic_ms, specialized_ms,
+                    generic_ms / specialized_ms, generic_sum == specialized_sum ? "" : "  (checksum mismatch)");
+    }
+    construction::Insertion::set_specialized_evaluation(saved);
+    return 0;
+}
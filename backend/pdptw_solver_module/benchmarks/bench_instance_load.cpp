@@ -0,0 +1,41 @@
+// Benchmark khởi động: thời gian load instance, kích thước ma trận và peak RSS
+//
+// Usage: bench_instance_load [instance.txt] [max_vehicles]
+//   Thử định dạng Li & Lim trước, sau đó Sartori & Buriol (giống pdptw_solver -f auto)
+
+#include "bench_common.hpp"
+
+#include "pdptw/io/li_lim_reader.hpp"
+
+#include <cstdio>
+#include <exception>
+
+using namespace pdptw;
+
+int main(int argc, char **argv) {
+    std::string path = bench::instance_path_from_args(argc, argv, 1000);
+    size_t max_vehicles = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 0;
+
+    size_t rss_before = bench::peak_rss_bytes();
+    bench::Stopwatch timer;
+
+    problem::PDPTWInstance instance;
+    try {
+        instance = io::load_li_lim_instance(path, max_vehicles);
+    } catch (const std::exception &) {
+        instance = io::load_sartori_buriol_instance(path, max_vehicles);
+    }
+    double load_ms = timer.elapsed_ms();
+
+    const auto &matrix = instance.travel_matrix();
+    std::printf("Instance %s: %zu requests, %zu vehicles, %zu nodes\n",
+                instance.name().c_str(), instance.num_requests(), instance.num_vehicles(),
+                instance.nodes().size());
+    std::printf("Load time:   %.1f ms\n", load_ms);
+    std::printf("Matrix:      %zux%zu, %.2f MiB\n", matrix.size(), matrix.size(),
+                matrix.memory_bytes() / (1024.0 * 1024.0));
+    std::printf("Peak RSS:    %.2f MiB (%.2f MiB before load)\n",
+                bench::peak_rss_bytes() / (1024.0 * 1024.0),
+                rss_before / (1024.0 * 1024.0));
+    return 0;
+}
@@ -0,0 +1,128 @@
+// Benchmark parser ma trận EDGES: istringstream (cách cũ) so với from_chars song song
+//
+// Usage: bench_matrix_parse [size] [--skip-legacy]
+//   Sinh khối SIZE x SIZE số nguyên (mặc định 10000) trong thư mục tạm, mmap file,
+//   rồi so sánh với một lượt memchr qua cùng buffer làm mốc băng thông bộ nhớ.
+
+#include "bench_common.hpp"
+
+#include "pdptw/io/matrix_parser.hpp"
+#include "pdptw/utils/mapped_file.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif
+
+using namespace pdptw;
+
+namespace {
+
+std::string matrix_path(size_t size) {
+    auto path = std::filesystem::temp_directory_path() /
+                ("pdptw-bench-edges-" + std::to_string(size) + ".txt");
+    if (std::filesystem::exists(path)) {
+        return path.string();
+    }
+
+    std::printf("Generating %zux%zu matrix: %s\n", size, size, path.string().c_str());
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<int> value(0, 480);
+    std::ofstream out(path, std::ios::binary);
+    std::string row;
+    for (size_t i = 0; i < size; ++i) {
+        row.clear();
+        for (size_t j = 0; j < size; ++j) {
+            row += std::to_string(i == j ? 0 : value(rng));
+            row += (j + 1 < size ? ' ' : '\n');
+        }
+        out << row;
+    }
+    return path.string();
+}
+
+// Cách cũ của reader Sartori: getline + istringstream vào vector<vector<double>>, rồi set_arc
+double legacy_parse_ms(const char *begin, const char *end, size_t size) {
+    bench::Stopwatch timer;
+    std::istringstream file(std::string(begin, end));
+    std::string line;
+    std::vector<std::vector<double>> raw_matrix(size, std::vector<double>(size));
+    for (size_t i = 0; i < size; ++i) {
+        std::getline(file, line);
+        std::istringstream iss(line);
+        for (size_t j = 0; j < size; ++j) {
+            iss >> raw_matrix[i][j];
+        }
+    }
+    problem::TravelMatrix matrix(size, {problem::MatrixPrecision::UInt32, true});
+    for (size_t u = 0; u < size; ++u) {
+        for (size_t v = 0; v < size; ++v) {
+            matrix.set_arc(u, v, raw_matrix[u][v], raw_matrix[u][v]);
+        }
+    }
+    return timer.elapsed_ms();
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    size_t size = 10000;
+    bool skip_legacy = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--skip-legacy") == 0) {
+            skip_legacy = true;
+        } else {
+            size = std::strtoul(argv[i], nullptr, 10);
+        }
+    }
+
+    auto file = utils::MappedFile::open(matrix_path(size));
+    const char *begin = reinterpret_cast<const char *>(file->data());
+    const char *end = begin + file->size();
+    const double mib = file->size() / (1024.0 * 1024.0);
+
+    int threads = 1;
+#ifdef USE_OPENMP
+    threads = omp_get_max_threads();
+#endif
+    std::printf("Matrix %zux%zu, %.1f MiB of text, %d thread(s)\n", size, size, mib, threads);
+
+    // Mốc: một lượt memchr qua toàn bộ buffer (đồng thời làm nóng page cache)
+    bench::Stopwatch timer;
+    size_t lines = 0;
+    for (const char *p = begin; p < end; ++lines) {
+        const void *newline = std::memchr(p, '\n', static_cast<size_t>(end - p));
+        p = newline ? static_cast<const char *>(newline) + 1 : end;
+    }
+    double scan_ms = timer.elapsed_ms();
+    std::printf("memchr scan:      %9.1f ms  (%7.1f MiB/s, %zu lines)\n", scan_ms,
+                mib / (scan_ms / 1000.0), lines);
+
+    double best_ms = 0.0;
+    for (int run = 0; run < 3; ++run) {
+        timer.reset();
+        auto result = io::parse_square_matrix(begin, end, size);
+        double ms = timer.elapsed_ms();
+        if (run == 0 || ms < best_ms) {
+            best_ms = ms;
+        }
+        if (run == 0) {
+            std::printf("Parsed storage:   %s, %.1f MiB\n",
+                        problem::to_string(result.matrix->storage()).c_str(),
+                        result.matrix->memory_bytes() / (1024.0 * 1024.0));
+        }
+    }
+    std::printf("from_chars:       %9.1f ms  (%7.1f MiB/s, best of 3)\n", best_ms,
+                mib / (best_ms / 1000.0));
+
+    if (!skip_legacy) {
+        double ms = legacy_parse_ms(begin, end, size);
+        std::printf("istringstream:    %9.1f ms  (%7.1f MiB/s, %.1fx slower)\n", ms,
+                    mib / (ms / 1000.0), ms / best_ms);
+    }
+    std::printf("Peak RSS:         %.1f MiB\n", bench::peak_rss_bytes() / (1024.0 * 1024.0));
+    return 0;
+}
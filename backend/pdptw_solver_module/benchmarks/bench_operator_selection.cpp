@@ -0,0 +1,89 @@
+// Benchmark chọn operator của LNSSolver: xoay vòng so với trọng số thích nghi (ALNS)
+//
+// Usage: bench_operator_selection [instance.txt ...]
+//   Không có instance → sinh instance tổng hợp 200 request (định dạng Sartori)
+//   Mỗi instance chạy LNS kIterations iteration với kSeeds seed cho cả hai cách chọn, từ
+//   cùng lời giải sequential. Target = best cuối kém hơn của hai cách (cùng seed) nên cả
+//   hai đều đạt; in trung vị thời gian đạt target và best cuối trung bình.
+
+#include "bench_common.hpp"
+
+#include "pdptw/construction/constructor.hpp"
+#include "pdptw/io/li_lim_reader.hpp"
+#include "pdptw/solver/lns_solver.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace pdptw;
+
+namespace {
+
+constexpr int kIterations = 2000;
+constexpr unsigned kSeeds = 5;
+
+problem::PDPTWInstance load_instance(const std::string &path) {
+    try {
+        return io::load_li_lim_instance(path);
+    } catch (const std::exception &) {
+        return io::load_sartori_buriol_instance(path);
+    }
+}
+
+double median(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    return values[values.size() / 2];
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; ++i) {
+        paths.push_back(argv[i]);
+    }
+    if (paths.empty()) {
+        paths.push_back(bench::instance_path_from_args(argc, argv, 200));
+    }
+
+    std::printf("%-20s %12s %12s %8s %12s %12s\n", "instance", "rr ttt s", "adaptive s", "speedup",
+                "rr best", "adaptive best");
+    for (const auto &path : paths) {
+        auto instance = load_instance(path);
+        auto initial = construction::Constructor::sequential_construction(instance);
+
+        std::vector<double> rr_times, adaptive_times;
+        double rr_best = 0.0, adaptive_best = 0.0;
+        for (unsigned seed = 1; seed <= kSeeds; ++seed) {
+            LNSSolverParams params;
+            params.max_iterations = kIterations;
+            params.max_non_improving_iterations = kIterations;
+            params.verbose = false;
+            params.seed = seed;
+
+            params.operator_selection = LNSSolverParams::OperatorSelection::ROUND_ROBIN;
+            LNSSolver round_robin(instance, params);
+            round_robin.solve(initial);
+            const auto &rr = round_robin.get_statistics();
+
+            params.operator_selection = LNSSolverParams::OperatorSelection::ADAPTIVE;
+            LNSSolver adaptive(instance, params);
+            adaptive.solve(initial);
+            const auto &ad = adaptive.get_statistics();
+
+            Num target = std::max(rr.best_objective, ad.best_objective);
+            rr_times.push_back(rr.time_to_target(target));
+            adaptive_times.push_back(ad.time_to_target(target));
+            rr_best += rr.best_objective / kSeeds;
+            adaptive_best += ad.best_objective / kSeeds;
+        }
+
+        double rr_ttt = median(rr_times);
+        double adaptive_ttt = median(adaptive_times);
+        std::printf("%-20s %12.3f %12.3f %7.2fx %12.1f %12.1f\n", instance.name().c_str(), rr_ttt,
+                    adaptive_ttt, adaptive_ttt > 0.0 ? rr_ttt / adaptive_ttt : 0.0, rr_best, adaptive_best);
+    }
+    return 0;
+}
@@ -0,0 +1,74 @@
+// Benchmark khả năng mở rộng của tìm kiếm chèn trên pool worker dùng chung
+//
+// Usage: bench_parallel_insertion [instance.txt] [rounds] [max_threads]
+//   Không có instance → sinh instance tổng hợp 1000 request (định dạng Sartori)
+//   Đo calculate_regret (song song theo request) và find_best_insertion (song song
+//   theo route) với 1, 2, 4, ... max_threads thread (mặc định 32)
+
+#include "bench_common.hpp"
+
+#include "pdptw/construction/constructor.hpp"
+#include "pdptw/construction/insertion.hpp"
+#include "pdptw/solution/datastructure.hpp"
+#include "pdptw/utils/thread_pool.hpp"
+
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+using namespace pdptw;
+
+int main(int argc, char **argv) {
+    std::string path = bench::instance_path_from_args(argc, argv, 1000);
+    int rounds = argc > 2 ? std::atoi(argv[2]) : 3;
+    size_t max_threads = argc > 3 ? static_cast<size_t>(std::atoi(argv[3])) : 32;
+
+    auto instance = io::load_sartori_buriol_instance(path);
+    auto solution = construction::Constructor::sequential_construction(instance);
+
+    // Gỡ 10% request để làm tập cần chèn lại
+    std::vector<size_t> removed;
+    for (size_t r = 0; r < instance.num_requests(); r += 10) {
+        if (solution.is_request_assigned(r)) {
+            solution.unassign_request(instance.pickup_id_of_request(r));
+            removed.push_back(r);
+        }
+    }
+    std::printf("Instance %s: %zu requests, %zu routes, %zu to reinsert, %u hardware threads\n",
+                instance.name().c_str(), instance.num_requests(), solution.number_of_non_empty_routes(),
+                removed.size(), std::thread::hardware_concurrency());
+    std::printf("%8s %14s %8s %14s %8s\n", "threads", "regret ms", "speedup", "best ms", "speedup");
+
+    double regret_base = 0.0;
+    double best_base = 0.0;
+    double sink = 0.0;
+    for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+        utils::ThreadPool::set_global_threads(threads);
+
+        bench::Stopwatch timer;
+        for (int r = 0; r < rounds; ++r) {
+            auto regret = construction::Insertion::calculate_regret(solution, removed, 2);
+            sink += regret.empty() ? 0.0 : regret.front().cost_increase;
+        }
+        double regret_ms = timer.elapsed_ms() / rounds;
+
+        timer.reset();
+        for (int r = 0; r < rounds; ++r) {
+            for (size_t request : removed) {
+                auto best = construction::Insertion::find_best_insertion(solution, request);
+                sink += best.feasible ? best.cost_increase : 0.0;
+            }
+        }
+        double best_ms = timer.elapsed_ms() / rounds;
+
+        if (threads == 1) {
+            regret_base = regret_ms;
+            best_base = best_ms;
+        }
+        std::printf("%8zu %14.2f %7.2fx %14.2f %7.2fx\n", threads, regret_ms, regret_base / regret_ms,
+                    best_ms, best_base / best_ms);
+    }
+
+    std::printf("(checksum %.1f)\n", sink);
+    return 0;
+}
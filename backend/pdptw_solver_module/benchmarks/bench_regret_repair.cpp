@@ -0,0 +1,107 @@
+// Benchmark thời gian một lần repair regret-k: vòng lặp tính lại regret của mọi request
+// sau mỗi lần chèn (cách cũ) so với RegretHeap (chỉ cập nhật request bị ảnh hưởng)
+//
+// Usage: bench_regret_repair [instance.txt] [rounds]
+//   Không có instance → sinh instance tổng hợp 1000 request (định dạng Sartori)
+//   Gỡ 10% và 30% request khỏi lời giải sequential rồi chèn lại với k = 2, 3, 4
+
+#include "bench_common.hpp"
+
+#include "pdptw/construction/constructor.hpp"
+#include "pdptw/construction/insertion_cache.hpp"
+#include "pdptw/construction/regret_heap.hpp"
+#include "pdptw/solution/datastructure.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+using namespace pdptw;
+
+namespace {
+
+// Repair regret trước RegretHeap: calculate_regret cho mọi request còn lại mỗi vòng
+// (chọn max theo cùng thứ tự với heap để hai cách cho cùng lời giải)
+void repair_full_recompute(solution::Solution &solution, construction::InsertionCache &cache, size_t k) {
+    auto &bank = solution.unassigned_requests();
+    while (bank.count() > 0) {
+        auto candidates = cache.calculate_regret(solution, bank.iter_request_ids(), k);
+        auto best = std::max_element(candidates.begin(), candidates.end(),
+                                     [](const construction::InsertionCandidate &a,
+                                        const construction::InsertionCandidate &b) {
+                                         if (a.regret_value != b.regret_value) {
+                                             return a.regret_value < b.regret_value;
+                                         }
+                                         if (a.cost_increase != b.cost_increase) {
+                                             return a.cost_increase > b.cost_increase;
+                                         }
+                                         return a.request_id > b.request_id;
+                                     });
+        if (!best->feasible) {
+            break;
+        }
+        construction::Insertion::insert_request(solution, *best);
+    }
+}
+
+void repair_heap(solution::Solution &solution, construction::InsertionCache &cache,
+                 construction::RegretHeap &heap) {
+    heap.reset(solution, solution.unassigned_requests().iter_request_ids(), &cache);
+    while (!heap.empty() && heap.top().feasible) {
+        heap.insert_top(solution);
+    }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    std::string path = bench::instance_path_from_args(argc, argv, 1000);
+    int rounds = argc > 2 ? std::atoi(argv[2]) : 3;
+
+    auto instance = io::load_sartori_buriol_instance(path);
+    auto base = construction::Constructor::sequential_construction(instance);
+    std::printf("Instance %s: %zu requests, %zu routes\n", instance.name().c_str(),
+                instance.num_requests(), base.number_of_non_empty_routes());
+    std::printf("%8s %3s %10s %14s %14s %8s %14s\n", "removed", "k", "requests", "recompute ms",
+                "heap ms", "speedup", "cost delta");
+
+    for (size_t percent : {10, 30}) {
+        auto destroyed = base;
+        size_t step = 100 / percent;
+        for (size_t r = 0; r < instance.num_requests(); r += step) {
+            if (destroyed.is_request_assigned(r)) {
+                destroyed.unassign_request(instance.pickup_id_of_request(r));
+            }
+        }
+        const size_t removed = destroyed.unassigned_requests().count();
+
+        for (size_t k = 2; k <= construction::InsertionTopK::kMaxK; ++k) {
+            double recompute_cost = 0.0;
+            double heap_cost = 0.0;
+
+            // Mỗi vòng dùng cache mới để cả hai cách cùng bắt đầu từ cache rỗng
+            bench::Stopwatch timer;
+            for (int round = 0; round < rounds; ++round) {
+                auto solution = destroyed;
+                construction::InsertionCache cache;
+                repair_full_recompute(solution, cache, k);
+                recompute_cost = solution.total_cost();
+            }
+            double recompute_ms = timer.elapsed_ms() / rounds;
+
+            construction::RegretHeap heap(k);
+            timer.reset();
+            for (int round = 0; round < rounds; ++round) {
+                auto solution = destroyed;
+                construction::InsertionCache cache;
+                repair_heap(solution, cache, heap);
+                heap_cost = solution.total_cost();
+            }
+            double heap_ms = timer.elapsed_ms() / rounds;
+
+            std::printf("%7zu%% %3zu %10zu %14.2f %14.2f %7.2fx %14.6f\n", percent, k, removed,
+                        recompute_ms, heap_ms, recompute_ms / heap_ms, heap_cost - recompute_cost);
+        }
+    }
+    return 0;
+}
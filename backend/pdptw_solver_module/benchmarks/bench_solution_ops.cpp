@@ -0,0 +1,72 @@
+// Benchmark thao tác trên Solution: gỡ/chèn lại request, tra route và copy
+//
+// Usage: bench_solution_ops [instance.txt] [rounds]
+//   Không có instance → sinh instance tổng hợp 1000 request (định dạng Sartori)
+
+#include "bench_common.hpp"
+
+#include "pdptw/construction/constructor.hpp"
+#include "pdptw/solution/datastructure.hpp"
+
+#include <cstdio>
+#include <vector>
+
+using namespace pdptw;
+
+int main(int argc, char **argv) {
+    std::string path = bench::instance_path_from_args(argc, argv, 1000);
+    int rounds = argc > 2 ? std::atoi(argv[2]) : 20;
+
+    auto instance = io::load_sartori_buriol_instance(path);
+    auto solution = construction::Constructor::sequential_construction(instance);
+    std::printf("Instance %s: %zu requests, %zu routes\n",
+                instance.name().c_str(), instance.num_requests(),
+                solution.number_of_non_empty_routes());
+
+    // 1. Gỡ rồi chèn lại từng request vào đúng vị trí cũ
+    size_t ops = 0;
+    size_t route_sum = 0;
+    bench::Stopwatch timer;
+    for (int r = 0; r < rounds; ++r) {
+        for (size_t request = 0; request < instance.num_requests(); ++request) {
+            if (!solution.is_request_assigned(request)) {
+                continue;
+            }
+            size_t pickup = instance.pickup_id_of_request(request);
+            size_t route_id = solution.route_of_request(request);
+            size_t pickup_after = solution.pred(pickup);
+            size_t delivery_before = solution.succ(pickup + 1);
+
+            solution.unassign_request(pickup);
+            solution.relink_when_inserting_pd(route_id * 2, pickup, pickup_after, delivery_before);
+            solution.validate_between(pickup_after, delivery_before);
+            solution.unassigned_requests().remove(pickup);
+
+            route_sum += solution.route_of_node(pickup + 1);
+            ++ops;
+        }
+    }
+    double ops_ms = timer.elapsed_ms();
+    std::printf("remove+reinsert: %zu ops, %.2f us/op\n", ops, ops_ms * 1e3 / ops);
+
+    // 2. Copy toàn bộ Solution
+    timer.reset();
+    double objective_sum = 0.0;
+    for (int r = 0; r < rounds; ++r) {
+        solution::Solution copy = solution;
+        objective_sum += copy.objective();
+    }
+    std::printf("Solution copy: %.1f us/copy\n", timer.elapsed_ms() * 1e3 / rounds);
+
+    // 3. Truy vấn objective / danh sách route (LNS gọi nhiều lần mỗi iteration)
+    timer.reset();
+    const size_t queries = static_cast<size_t>(rounds) * 10000;
+    for (size_t q = 0; q < queries; ++q) {
+        objective_sum += solution.objective() * 1e-9;
+        route_sum += solution.iter_route_ids().size() + solution.number_of_non_empty_routes();
+    }
+    std::printf("objective + iter_route_ids: %.3f us/query\n", timer.elapsed_ms() * 1e3 / queries);
+
+    std::printf("(checksum %zu %.1f)\n", route_sum, objective_sum);
+    return 0;
+}
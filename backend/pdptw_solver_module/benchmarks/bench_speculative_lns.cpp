@@ -0,0 +1,100 @@
+// Benchmark LNS speculative: K ứng viên destroy/repair song song mỗi iteration so với tuần tự
+//
+// Usage: bench_speculative_lns [seconds] [instance.txt ...]
+//   Không có instance → sinh instance tổng hợp 200 request (định dạng Sartori)
+//   Mỗi instance chạy LNS trong `seconds` giây (mặc định 5) với kSeeds seed cho từng K, từ
+//   cùng lời giải sequential. Target = best cuối kém nhất giữa các K (cùng seed) nên mọi cấu
+//   hình đều đạt; in trung vị thời gian đạt target, best cuối trung bình và số iteration.
+//   Speculative chỉ có lợi khi pool có nhiều thread (ThreadPool::default_threads()).
+
+#include "bench_common.hpp"
+
+#include "pdptw/construction/constructor.hpp"
+#include "pdptw/io/li_lim_reader.hpp"
+#include "pdptw/solver/lns_solver.hpp"
+#include "pdptw/utils/thread_pool.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace pdptw;
+
+namespace {
+
+constexpr unsigned kSeeds = 3;
+
+problem::PDPTWInstance load_instance(const std::string &path) {
+    try {
+        return io::load_li_lim_instance(path);
+    } catch (const std::exception &) {
+        return io::load_sartori_buriol_instance(path);
+    }
+}
+
+double median(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    return values[values.size() / 2];
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    double seconds = argc > 1 ? std::atof(argv[1]) : 5.0;
+    std::vector<std::string> paths;
+    for (int i = 2; i < argc; ++i) {
+        paths.push_back(argv[i]);
+    }
+    if (paths.empty()) {
+        paths.push_back(bench::instance_path_from_args(0, argv, 200));
+    }
+
+    const size_t threads = utils::ThreadPool::default_threads();
+    std::vector<size_t> candidates = {1, 2, 4};
+    if (threads > 4) {
+        candidates.push_back(threads);
+    }
+
+    std::printf("pool threads: %zu, budget %.1f s\n", threads, seconds);
+    std::printf("%-20s %4s %12s %12s %12s\n", "instance", "K", "ttt s", "best", "iterations");
+    for (const auto &path : paths) {
+        auto instance = load_instance(path);
+        auto initial = construction::Constructor::sequential_construction(instance);
+
+        std::vector<std::vector<LNSStatistics>> runs(candidates.size());
+        for (unsigned seed = 1; seed <= kSeeds; ++seed) {
+            for (size_t c = 0; c < candidates.size(); ++c) {
+                LNSSolverParams params;
+                params.max_iterations = 1000000;
+                params.max_non_improving_iterations = 1000000;
+                params.time_limit_seconds = seconds;
+                params.verbose = false;
+                params.seed = seed;
+                params.speculative_candidates = candidates[c];
+
+                LNSSolver solver(instance, params);
+                solver.solve(initial);
+                runs[c].push_back(solver.get_statistics());
+            }
+        }
+
+        for (size_t c = 0; c < candidates.size(); ++c) {
+            std::vector<double> times;
+            double best = 0.0;
+            double iterations = 0.0;
+            for (unsigned s = 0; s < kSeeds; ++s) {
+                Num target = 0.0;
+                for (const auto &config : runs) {
+                    target = std::max(target, config[s].best_objective);
+                }
+                times.push_back(runs[c][s].time_to_target(target));
+                best += runs[c][s].best_objective / kSeeds;
+                iterations += static_cast<double>(runs[c][s].total_iterations) / kSeeds;
+            }
+            std::printf("%-20s %4zu %12.3f %12.1f %12.0f\n", instance.name().c_str(), candidates[c],
+                        median(times), best, iterations);
+        }
+    }
+    return 0;
+}
@@ -1,9 +1,11 @@
 #pragma once
 
 #include "pdptw/lns/absence_counter.hpp"
+#include "pdptw/problem/granular_neighborhood.hpp"
 #include "pdptw/problem/pdptw.hpp"
 #include "pdptw/solution/datastructure.hpp"
 #include "pdptw/utils/time_limit.hpp"
+#include <memory>
 #include <optional>
 #include <random>
 
@@ -19,6 +21,7 @@ struct AGESParameters {
     double shift_probability = 0.5;                  // Xác suất shift vs exchange
     bool use_k_ejection = true;                      // Sử dụng k-ejection
     bool use_perturbation = true;                    // Sử dụng perturbation
+    size_t granular_k = 0;                           // Láng giềng granular khi chèn (0 = tắt)
 
     static AGESParameters default_params(size_t num_requests) {
         return AGESParameters{};
@@ -41,6 +44,7 @@ public:
 private:
     const problem::PDPTWInstance *instance_;
     AGESParameters params_;
+    std::shared_ptr<const problem::GranularNeighborhood> granular_;
 
     // Thử chèn request bằng cách loại bỏ (eject) 1-2 request khác
     void eject_and_insert(
@@ -1,13 +1,17 @@
 #ifndef PDPTW_CONSTRUCTION_INSERTION_HPP
 #define PDPTW_CONSTRUCTION_INSERTION_HPP
 
+#include "../problem/granular_neighborhood.hpp"
 #include "../problem/pdptw.hpp"
 #include "../solution/datastructure.hpp"
+#include <algorithm>
+#include <array>
 #include <limits>
 #include <vector>
 
 namespace pdptw::construction {
 
+using pdptw::problem::GranularNeighborhood;
 using pdptw::problem::Num;
 using pdptw::problem::PDPTWInstance;
 
@@ -16,9 +20,17 @@ enum class InsertionStrategy {
     BestCost,  // Tối thiểu hóa tăng chi phí
     Regret2,   // 2-regret (chênh lệch giữa tốt nhất và tốt thứ 2)
     Regret3,   // 3-regret (chênh lệch giữa tốt nhất và tốt thứ 3)
+    Regret4,   // 4-regret (chênh lệch giữa tốt nhất và tốt thứ 4)
     Sequential // Chèn tuần tự đơn giản
 };
 
+// Cách đánh giá các vị trí delivery trong find_insertions_in_route
+enum class EvaluationBackend {
+    Scalar,   // Từng cặp một qua REFData
+    Batch,    // Gom theo pickup_after, kernel vô hướng trên SoA (refn::DeliveryBatch)
+    BatchAvx2 // Như Batch, kernel AVX2 nếu build với ENABLE_AVX2 và CPU hỗ trợ
+};
+
 // Ứng viên chèn cho một request
 struct InsertionCandidate {
     size_t request_id;     // Request cần chèn
@@ -46,14 +58,93 @@ struct InsertionCandidate {
     }
 };
 
+// Top-k vị trí chèn rẻ nhất với dung lượng cố định: không cấp phát, dùng lại được giữa
+// các lần tìm. Thứ tự: cost tăng dần; bằng nhau thì vehicle nhỏ hơn đứng trước, cùng
+// vehicle giữ thứ tự duyệt (giống std::min_element trên danh sách theo thứ tự vehicle).
+class InsertionTopK {
+public:
+    static constexpr size_t kMaxK = 4;
+
+    explicit InsertionTopK(size_t k = 1) { reset(k); }
+
+    // Xoá và đặt k mới (kẹp vào [1, kMaxK])
+    void reset(size_t k) {
+        k_ = std::clamp<size_t>(k, 1, kMaxK);
+        size_ = 0;
+    }
+    void clear() { size_ = 0; }
+
+    void push(const InsertionCandidate &candidate) {
+        size_t pos = size_;
+        while (pos > 0 && before(candidate, items_[pos - 1])) {
+            --pos;
+        }
+        if (pos >= k_) {
+            return;
+        }
+        for (size_t i = std::min(size_, k_ - 1); i > pos; --i) {
+            items_[i] = items_[i - 1];
+        }
+        items_[pos] = candidate;
+        size_ = std::min(size_ + 1, k_);
+    }
+
+    // Gộp top-k khác (của các vehicle khác) vào
+    void merge(const InsertionTopK &other) {
+        for (size_t i = 0; i < other.size_; ++i) {
+            push(other.items_[i]);
+        }
+    }
+
+    size_t k() const { return k_; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    const InsertionCandidate &operator[](size_t i) const { return items_[i]; }
+    const InsertionCandidate &best() const { return items_[0]; }
+
+    // k-regret: vị trí tốt thứ k (ít hơn k thì vị trí cuối) trừ vị trí tốt nhất
+    Num regret() const {
+        return size_ > 1 ? items_[size_ - 1].cost_increase - items_[0].cost_increase : 0.0;
+    }
+
+private:
+    static bool before(const InsertionCandidate &a, const InsertionCandidate &b) {
+        return a.cost_increase < b.cost_increase ||
+               (a.cost_increase == b.cost_increase && a.vehicle_id < b.vehicle_id);
+    }
+
+    std::array<InsertionCandidate, kMaxK> items_;
+    size_t k_ = 1;
+    size_t size_ = 0;
+};
+
+// Bộ đếm pruning của tìm kiếm vị trí chèn (một cặp = (pickup_after, delivery_after))
+struct InsertionStats {
+    size_t routes_scanned = 0;    // Route được duyệt vị trí
+    size_t routes_pruned = 0;     // Route bị loại cả route (capacity, time window, route rỗng cùng lớp xe)
+    size_t positions_checked = 0; // Cặp vị trí đã đánh giá
+    size_t positions_pruned = 0;  // Cặp vị trí bị bỏ qua không cần đánh giá
+
+    InsertionStats &operator+=(const InsertionStats &other) {
+        routes_scanned += other.routes_scanned;
+        routes_pruned += other.routes_pruned;
+        positions_checked += other.positions_checked;
+        positions_pruned += other.positions_pruned;
+        return *this;
+    }
+};
+
 // Heuristic chèn request vào giải pháp PDPTW
 class Insertion {
 public:
-    // Tìm vị trí chèn tốt nhất cho request
+    // Tìm vị trí chèn tốt nhất cho request (stats: cộng dồn bộ đếm pruning nếu khác nullptr;
+    // granular: chỉ xét các khe kề láng giềng của pickup/delivery)
     static InsertionCandidate find_best_insertion(
         const solution::Solution &solution,
         size_t request_id,
-        InsertionStrategy strategy = InsertionStrategy::BestCost);
+        InsertionStrategy strategy = InsertionStrategy::BestCost,
+        InsertionStats *stats = nullptr,
+        const GranularNeighborhood *granular = nullptr);
 
     // Tính tăng chi phí khi chèn request vào vị trí cụ thể
     static Num calculate_insertion_cost(
@@ -71,28 +162,101 @@ public:
         size_t pickup_after,
         size_t delivery_after);
 
+    // Liệt kê mọi vị trí chèn khả thi của request vào một route, thêm vào out.
+    // Kết quả giống hệt is_feasible_insertion + calculate_insertion_cost trên từng cặp,
+    // nhưng mỗi cặp (pickup_after, delivery_after) chỉ tốn O(1): REF data của đoạn
+    // pickup..delivery được mở rộng dần và nối với bw_data() ở cuối.
+    // Các cặp chắc chắn vi phạm time window/capacity bị bỏ qua mà không đánh giá.
+    // Với granular, route không chứa láng giềng nào của pickup bị loại cả route.
+    // Trả về số cặp vị trí đã xét.
+    static size_t find_insertions_in_route(
+        const solution::Solution &solution,
+        size_t request_id,
+        size_t vehicle_id,
+        std::vector<InsertionCandidate> &out,
+        InsertionStats *stats = nullptr,
+        const GranularNeighborhood *granular = nullptr);
+
+    // Backend đánh giá dùng chung cho mọi lời gọi (mặc định Scalar). Mọi backend cho
+    // cùng danh sách ứng viên và cùng chi phí.
+    static void set_evaluation_backend(EvaluationBackend backend);
+    static EvaluationBackend evaluation_backend();
+
+    // Backend Scalar: dùng biến thể đánh giá chuyên biệt theo InstanceTraits của instance
+    // (bỏ kiểm tra capacity khi route không thể vượt tải, đọc một giá trị cho mỗi cung khi
+    // time == distance, đọc theo hàng của pickup/delivery khi ma trận đối xứng). Mặc định
+    // bật; tắt thì luôn dùng đường tổng quát. Kết quả giống hệt nhau.
+    static void set_specialized_evaluation(bool enabled);
+    static bool specialized_evaluation();
+
+    // Ngưỡng song song (số cặp vị trí ước lượng): find_best_insertion chia route cho pool
+    // worker khi một request có ít nhất chừng này cặp, calculate_regret chia request khi
+    // tổng số cặp của các request đạt ngưỡng. Dưới ngưỡng chạy tuần tự.
+    static void set_parallel_cutoff(size_t pairs);
+    static size_t parallel_cutoff();
+
+    // Như trên nhưng đẩy thẳng vào top (không xoá top trước), không tạo danh sách ứng viên
+    static size_t find_insertions_in_route(
+        const solution::Solution &solution,
+        size_t request_id,
+        size_t vehicle_id,
+        InsertionTopK &top,
+        InsertionStats *stats = nullptr,
+        const GranularNeighborhood *granular = nullptr);
+
+    // top.k() vị trí chèn rẻ nhất trên mọi route (xoá top trước). Không cấp phát: dùng
+    // lại top giữa các request. Route rỗng cùng lớp xe chỉ được đánh giá một lần; solution
+    // lớn (>= parallel_cutoff() cặp vị trí) được chia route cho pool worker, mỗi worker
+    // giữ top-k riêng. Kết quả không phụ thuộc số thread.
+    static void find_top_insertions(
+        const solution::Solution &solution,
+        size_t request_id,
+        InsertionTopK &top,
+        InsertionStats *stats = nullptr,
+        const GranularNeighborhood *granular = nullptr);
+
     // Thực hiện chèn request theo ứng viên đã chọn
     static void insert_request(
         solution::Solution &solution,
         const InsertionCandidate &candidate);
 
-    // Tính k-regret cho các request chưa gán
+    // Tính k-regret cho các request chưa gán (k kẹp vào [1, InsertionTopK::kMaxK])
     static std::vector<InsertionCandidate> calculate_regret(
         const solution::Solution &solution,
         const std::vector<size_t> &unassigned_requests,
-        size_t k = 2);
+        size_t k = 2,
+        InsertionStats *stats = nullptr,
+        const GranularNeighborhood *granular = nullptr);
 
 private:
-    /**
-     * @brief Find all feasible insertions for a request
-     *
-     * @param solution Current solution
-     * @param request_id Request to insert
-     * @return Vector of all feasible insertion candidates
-     */
-    static std::vector<InsertionCandidate> find_all_insertions(
+    // find_top_insertions với số cặp vị trí đã ước lượng sẵn (dùng lại giữa các request)
+    static void find_top_insertions(
+        const solution::Solution &solution,
+        size_t request_id,
+        InsertionTopK &top,
+        size_t route_pairs,
+        InsertionStats *stats,
+        const GranularNeighborhood *granular);
+
+    // Duyệt vị trí chèn của find_insertions_in_route, gọi emit cho từng vị trí khả thi
+    // (chọn biến thể đánh giá rồi gọi scan_route_variant)
+    template <typename Emit>
+    static size_t scan_route(
         const solution::Solution &solution,
-        size_t request_id);
+        size_t request_id,
+        size_t vehicle_id,
+        InsertionStats *stats,
+        const GranularNeighborhood *granular,
+        Emit &&emit);
+
+    template <typename Variant, typename Emit>
+    static size_t scan_route_variant(
+        const solution::Solution &solution,
+        size_t request_id,
+        size_t vehicle_id,
+        InsertionStats *stats,
+        const GranularNeighborhood *granular,
+        Emit &emit);
 
     /**
      * @brief Get VN ID for a request's pickup node
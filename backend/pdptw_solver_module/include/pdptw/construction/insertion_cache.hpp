@@ -0,0 +1,161 @@
+#ifndef PDPTW_CONSTRUCTION_INSERTION_CACHE_HPP
+#define PDPTW_CONSTRUCTION_INSERTION_CACHE_HPP
+
+#include "insertion.hpp"
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace pdptw::construction {
+
+/**
+ * @brief Cache các vị trí chèn tốt nhất theo (request, route)
+ *
+ * Mỗi entry giữ kRouteTopK vị trí rẻ nhất của một request trong một route, kèm
+ * route_version() lúc tính. Kết quả chèn chỉ phụ thuộc vào nội dung route, nên sau
+ * một lần relink chỉ entry của các route vừa bị chạm mới phải tính lại.
+ *
+ * Như Insertion::find_top_insertions, mọi route rỗng cùng lớp xe dùng chung một entry:
+ * bộ nhớ là O(request × (route không rỗng + số lớp xe)) thay vì O(request × vehicle).
+ *
+ * Cache gắn với một Solution (uid()); khi dùng với Solution khác thì toàn bộ bị xoá.
+ * Kết quả giống Insertion::find_best_insertion / calculate_regret (k <= kRouteTopK)
+ * với cùng granular neighborhood.
+ */
+class InsertionCache {
+public:
+    static constexpr size_t kRouteTopK = 2;
+    static_assert(kRouteTopK <= InsertionTopK::kMaxK, "route top-k must fit InsertionTopK");
+
+    // Nhóm route được xét khi gộp kết quả
+    enum class RouteScope {
+        All,
+        NonEmpty, // Chỉ route đang chạy
+        Empty     // Chỉ route rỗng (mỗi route rỗng mang kết quả của lớp xe)
+    };
+
+    /**
+     * @brief Vị trí chèn tốt nhất trên mọi route (như find_best_insertion với BestCost)
+     */
+    InsertionCandidate find_best_insertion(const solution::Solution &solution, size_t request_id);
+
+    /**
+     * @brief Như Insertion::calculate_regret; k > kRouteTopK thì tính lại không qua cache
+     */
+    std::vector<InsertionCandidate> calculate_regret(
+        const solution::Solution &solution,
+        const std::vector<size_t> &unassigned_requests,
+        size_t k = 2);
+
+    /**
+     * @brief top-k của nhiều request một lần (tops[i] cho requests[i], k = tops[i].k())
+     *
+     * Như Insertion::find_top_insertions cho từng request; k > kRouteTopK thì tính lại
+     * không qua cache. Song song theo request khi có nhiều route phải tính lại.
+     */
+    void find_top_insertions(
+        const solution::Solution &solution,
+        const std::vector<size_t> &requests,
+        std::vector<InsertionTopK> &tops);
+
+    /**
+     * @brief top.k() vị trí rẻ nhất của một request trên các route thuộc scope (xoá top trước)
+     *
+     * top.k() phải <= kRouteTopK. Dùng cho repair chỉ mở route rỗng khi các route đang
+     * chạy không còn chỗ (BlinkInsertionOperator).
+     */
+    void find_top_insertions(
+        const solution::Solution &solution,
+        size_t request_id,
+        InsertionTopK &top,
+        RouteScope scope);
+
+    // Cộng bộ đếm của các lần tìm ngoài cache (vd. RegretHeap chỉ quét route vừa đổi)
+    void add_stats(const InsertionStats &stats) { stats_ += stats; }
+
+    void clear();
+
+    // Giới hạn vị trí chèn theo láng giềng granular (nullptr: xét mọi vị trí); xoá cache
+    void set_granular(std::shared_ptr<const GranularNeighborhood> granular);
+    const GranularNeighborhood *granular() const { return granular_.get(); }
+
+    // Số entry mỗi request đang cấp (lớp xe + route không rỗng, gồm cả slot trống để dùng lại)
+    size_t slot_capacity() const { return slot_capacity_; }
+
+    size_t hits() const { return hits_; }
+    size_t misses() const { return misses_; }
+
+    // Bộ đếm pruning cộng dồn của các lần tính lại route
+    const InsertionStats &stats() const { return stats_; }
+
+private:
+    static constexpr uint64_t kInvalidVersion = std::numeric_limits<uint64_t>::max();
+
+    struct RouteEntry {
+        uint64_t route_version = kInvalidVersion;
+        size_t count = 0; // Số vị trí khả thi hợp lệ trong top (<= kRouteTopK)
+        std::array<InsertionCandidate, kRouteTopK> top;
+    };
+
+    // Bộ đệm và counter riêng của một worker trong pool (gộp lại sau mỗi lời gọi)
+    struct WorkerState {
+        std::vector<size_t> stale;
+        size_t hits = 0;
+        size_t misses = 0;
+        InsertionStats stats;
+    };
+
+    // Ước lượng số cặp vị trí của một entry cũ khi quyết định có song song hay không
+    static constexpr size_t kStaleEntryPairs = 64;
+
+    static constexpr size_t kNoSlot = std::numeric_limits<size_t>::max();
+
+    void bind(const solution::Solution &solution);
+    // Route vừa có/hết request thì nhận/trả slot riêng; tính lại danh sách route đại diện
+    void sync_slots(const solution::Solution &solution);
+    size_t allocate_slot();
+    void grow_slots(size_t capacity);
+    // Entry còn đúng với nội dung hiện tại của route đại diện không
+    bool is_fresh(const solution::Solution &solution, size_t request_id, size_t vehicle_id) const;
+    void refresh_request(const solution::Solution &solution, size_t request_id, WorkerState &state);
+    void merge_workers();
+    void refresh_route(const solution::Solution &solution, size_t request_id, size_t vehicle_id,
+                       InsertionStats &stats);
+    // Gộp top của các route trong scope (theo thứ tự vehicle như Insertion::find_top_insertions)
+    void collect(const solution::Solution &solution, size_t request_id, InsertionTopK &top,
+                 RouteScope scope = RouteScope::All) const;
+
+    // Route rỗng dùng slot của lớp xe (slot < num_classes_), route không rỗng có slot riêng
+    RouteEntry &entry(size_t request_id, size_t vehicle_id) {
+        return entries_[request_id * slot_capacity_ + route_slots_[vehicle_id]];
+    }
+    const RouteEntry &entry(size_t request_id, size_t vehicle_id) const {
+        return entries_[request_id * slot_capacity_ + route_slots_[vehicle_id]];
+    }
+
+    uint64_t solution_uid_ = 0;
+    size_t num_vehicles_ = 0;
+    size_t num_requests_ = 0;
+    size_t num_classes_ = 0;
+    size_t slot_capacity_ = 0;
+    size_t num_slots_ = 0;
+    std::vector<size_t> route_slots_;      ///< Slot của từng vehicle
+    std::vector<size_t> free_slots_;       ///< Slot riêng đã trả lại, dùng lại trước khi cấp mới
+    std::vector<size_t> representatives_;  ///< Một vehicle cho mỗi slot đang dùng, theo thứ tự vehicle
+    std::vector<bool> class_listed_;
+    std::vector<RouteEntry> entries_;      ///< [request_id * slot_capacity_ + slot]
+    std::vector<WorkerState> workers_;
+    std::vector<size_t> stale_routes_;
+    std::vector<InsertionTopK> regret_tops_;
+    std::shared_ptr<const GranularNeighborhood> granular_;
+
+    size_t hits_ = 0;
+    size_t misses_ = 0;
+    InsertionStats stats_;
+};
+
+} // namespace pdptw::construction
+
+#endif // PDPTW_CONSTRUCTION_INSERTION_CACHE_HPP
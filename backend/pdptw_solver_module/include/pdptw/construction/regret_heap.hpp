@@ -0,0 +1,117 @@
+#ifndef PDPTW_CONSTRUCTION_REGRET_HEAP_HPP
+#define PDPTW_CONSTRUCTION_REGRET_HEAP_HPP
+
+#include "insertion.hpp"
+#include "insertion_cache.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace pdptw::construction {
+
+/**
+ * @brief Hàng đợi ưu tiên theo k-regret cho chèn regret lặp (regret-2/3/4)
+ *
+ * Mỗi request chờ chèn giữ top-k vị trí rẻ nhất; max-heap sắp theo regret giảm dần,
+ * cost tăng dần, request_id tăng dần. Sau khi chèn vào route r:
+ *  - request có top-k chứa r: tìm lại toàn bộ (qua InsertionCache nếu có, khi đó chỉ
+ *    entry của r phải tính lại);
+ *  - request còn lại: chỉ quét r rồi gộp vào top-k cũ (các route khác không đổi nên
+ *    kết quả giống hệt tìm lại toàn bộ).
+ * Request chỉ được đẩy lại vào heap khi khoá (regret, cost) đổi; entry cũ bị bỏ qua
+ * lúc lấy ra (lazy deletion). Thứ tự chèn giống vòng lặp calculate_regret + chọn max.
+ */
+class RegretHeap {
+public:
+    // k kẹp vào [1, InsertionTopK::kMaxK]
+    explicit RegretHeap(size_t k = 2);
+
+    /**
+     * @brief Nạp lại tập request chờ chèn và tính top-k ban đầu
+     *
+     * @param cache Dùng cho các lần tìm lại toàn bộ và granular neighborhood (nullptr:
+     *              tìm trực tiếp, xét mọi vị trí). Lần quét một route không đi qua cache;
+     *              bộ đếm của chúng nằm trong stats().
+     */
+    void reset(const solution::Solution &solution,
+               const std::vector<size_t> &requests,
+               InsertionCache *cache = nullptr);
+
+    bool empty() const { return pending_.empty(); }
+    size_t size() const { return pending_.size(); }
+    size_t k() const { return k_; }
+
+    // Request có regret lớn nhất: vị trí tốt nhất kèm regret_value; feasible = false
+    // (regret vô cùng) nếu request không còn vị trí khả thi. Chỉ gọi khi !empty().
+    const InsertionCandidate &top() const { return top_; }
+
+    // Bỏ request đứng đầu mà không chèn
+    void pop();
+
+    // Chèn request đứng đầu (phải khả thi) rồi cập nhật các request còn lại
+    void insert_top(solution::Solution &solution);
+
+    // Bộ đếm từ lần reset() gần nhất; stats() chỉ gồm các lần tìm không qua cache
+    const InsertionStats &stats() const { return stats_; }
+    size_t full_refreshes() const { return full_refreshes_; }   // Request phải tìm lại toàn bộ
+    size_t route_refreshes() const { return route_refreshes_; } // Request chỉ quét route vừa đổi
+    size_t heap_pushes() const { return heap_pushes_; }
+
+private:
+    struct Entry {
+        Num regret;
+        Num cost;
+        size_t request_id;
+        uint32_t version;
+    };
+
+    // Thứ tự của std::push_heap: a đứng sau b
+    static bool lower_priority(const Entry &a, const Entry &b) {
+        if (a.regret != b.regret) {
+            return a.regret < b.regret;
+        }
+        if (a.cost != b.cost) {
+            return a.cost > b.cost;
+        }
+        return a.request_id > b.request_id;
+    }
+
+    // Tìm lại toàn bộ top-k của các request (song song theo request khi đủ việc)
+    void search_full(const solution::Solution &solution, const std::vector<size_t> &requests);
+    // Chỉ quét một route rồi gộp vào top-k đang có
+    void search_route(const solution::Solution &solution, const std::vector<size_t> &requests,
+                      size_t vehicle_id);
+    // Tính lại khoá từ tops_; đẩy entry mới nếu khoá đổi (force: luôn đẩy)
+    void update_key(size_t request_id, bool force);
+    void remove_pending(size_t request_id);
+    void settle_top(); // Bỏ entry cũ ở đỉnh heap (dựng lại heap nếu quá nhiều), cập nhật top_
+
+    static constexpr size_t kNotPending = static_cast<size_t>(-1);
+
+    size_t k_;
+    InsertionCache *cache_ = nullptr;
+    const GranularNeighborhood *granular_ = nullptr;
+
+    std::vector<InsertionTopK> tops_; ///< [request_id]
+    std::vector<Num> regret_;         ///< [request_id] khoá hiện tại trong heap
+    std::vector<Num> cost_;
+    std::vector<uint32_t> version_;
+    std::vector<size_t> slot_;        ///< [request_id] vị trí trong pending_, kNotPending nếu đã xong
+    std::vector<size_t> pending_;
+    std::vector<Entry> heap_;
+    InsertionCandidate top_;
+
+    // Bộ đệm dùng lại giữa các lần cập nhật
+    std::vector<size_t> full_;
+    std::vector<size_t> partial_;
+    std::vector<InsertionTopK> full_tops_;
+    std::vector<InsertionStats> worker_stats_;
+
+    InsertionStats stats_;
+    size_t full_refreshes_ = 0;
+    size_t route_refreshes_ = 0;
+    size_t heap_pushes_ = 0;
+};
+
+} // namespace pdptw::construction
+
+#endif // PDPTW_CONSTRUCTION_REGRET_HEAP_HPP
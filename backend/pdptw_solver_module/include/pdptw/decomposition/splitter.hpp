@@ -2,6 +2,7 @@
 
 #include "pdptw/problem/pdptw.hpp"
 #include "pdptw/solution/datastructure.hpp"
+#include <memory>
 #include <optional>
 #include <random>
 #include <vector>
@@ -9,12 +10,14 @@
 namespace pdptw::decomposition {
 
 struct PartialInstance {
-    problem::PDPTWInstance instance;
+    // Giữ instance qua shared_ptr để địa chỉ không đổi khi PartialInstance bị move
+    // (initial_solution trỏ tới instance này)
+    std::shared_ptr<const problem::PDPTWInstance> instance;
     solution::Solution initial_solution;
     std::vector<size_t> partial_to_full_nodes;
     std::vector<size_t> original_request_ids;
 
-    PartialInstance(problem::PDPTWInstance inst,
+    PartialInstance(std::shared_ptr<const problem::PDPTWInstance> inst,
                     solution::Solution init,
                     std::vector<size_t> mapping,
                     std::vector<size_t> requests)
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "pdptw/problem/pdptw.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+
+/**
+ * @file instance_cache.hpp
+ * @brief Versioned binary cache (.pdptwbin) for preprocessed instances
+ *
+ * Layout (native little-endian, all sections 64-byte aligned):
+ *   CacheHeader   magic "PDPTWBIN", format version, source file hash,
+ *                 requested max_vehicles, counts, matrix storage mode,
+ *                 matrix traits (symmetric, time == distance), section offsets
+ *   name          instance name (UTF-8, not NUL-terminated)
+ *   nodes         NodeRecord[num_nodes]  (time windows already tightened)
+ *   vehicles      VehicleRecord[num_vehicles]
+ *   locations     uint32_t[num_nodes]    (node -> matrix location)
+ *   matrix        raw TravelMatrix storage, mapped zero-copy on load
+ *
+ * A cache file is only used when its version, source hash and
+ * max_vehicles all match; otherwise the text instance is parsed again
+ * and the cache file is rewritten.
+ */
+
+namespace pdptw::io {
+
+/**
+ * @brief Hash the content of a file (64-bit, stable across runs/platforms)
+ * @throws std::runtime_error if the file cannot be read
+ */
+uint64_t hash_file(const std::string &filepath);
+
+/**
+ * @brief Cache file path for a source instance inside cache_dir
+ *
+ * Name: <stem>-<hash>-v<max_vehicles>.pdptwbin
+ */
+std::string instance_cache_path(const std::string &cache_dir,
+                                const std::string &source_path,
+                                uint64_t source_hash,
+                                size_t max_vehicles);
+
+/**
+ * @brief Write a preprocessed instance to a .pdptwbin file
+ *
+ * Writes to a temporary file first and renames it, so concurrent solver
+ * processes never observe a partially written cache.
+ * @throws std::runtime_error on I/O failure
+ */
+void write_instance_cache(const std::string &cache_path,
+                          const problem::PDPTWInstance &instance,
+                          uint64_t source_hash,
+                          size_t max_vehicles);
+
+/**
+ * @brief Load an instance from a .pdptwbin file
+ *
+ * The travel matrix points directly into the memory-mapped file.
+ * @return std::nullopt if the file is missing, stale or malformed
+ */
+std::optional<problem::PDPTWInstance> load_instance_cache(const std::string &cache_path,
+                                                          uint64_t source_hash,
+                                                          size_t max_vehicles);
+
+/**
+ * @brief Load through the cache directory, parsing the text file on a miss
+ *
+ * A cache hit refreshes the file's modification time, so the mtime is the
+ * last use. The solver never deletes cache files; whoever owns the cache
+ * directory must bound it (the backend prunes by age and total size).
+ *
+ * @param parse Loader for the text instance (e.g. load_sartori_buriol_instance)
+ */
+problem::PDPTWInstance load_instance_with_cache(
+    const std::string &source_path,
+    const std::string &cache_dir,
+    size_t max_vehicles,
+    const std::function<problem::PDPTWInstance()> &parse);
+
+} // namespace pdptw::io
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "pdptw/problem/travel_matrix.hpp"
+
+#include <cstddef>
+#include <memory>
+
+namespace pdptw::io {
+
+// Kết quả parse khối ma trận: ma trận và vị trí ngay sau dòng cuối cùng đã đọc
+struct MatrixParseResult {
+    std::shared_ptr<problem::TravelMatrix> matrix;
+    const char *end = nullptr;
+};
+
+/**
+ * @brief Parse a SIZE x SIZE text matrix (one row per line, whitespace separated)
+ *        directly into a TravelMatrix with shared time/distance
+ *
+ * Row starts are located with one memchr pass, then rows are parsed in parallel
+ * (OpenMP) with std::from_chars. Integer matrices are written straight into uint32
+ * storage; any other value triggers a float64 pass that is narrowed in place to the
+ * most compact exact mode. Values past SIZE on a line are ignored.
+ *
+ * @param begin First character of the first matrix row
+ * @param end One past the last character of the buffer
+ * @param size Number of rows and columns
+ * @return Parsed matrix and the position after the last row
+ * @throws std::runtime_error if a row is missing or a value cannot be parsed
+ */
+MatrixParseResult parse_square_matrix(const char *begin, const char *end, size_t size);
+
+} // namespace pdptw::io
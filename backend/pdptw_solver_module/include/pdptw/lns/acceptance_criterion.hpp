@@ -22,7 +22,8 @@ class AcceptanceCriterion {
 public:
     explicit AcceptanceCriterion(
         AcceptanceType type = AcceptanceType::SimulatedAnnealing,
-        double initial_temperature = 10.0);
+        double initial_temperature = 10.0,
+        unsigned seed = std::random_device{}());
 
     // Quyết định có chấp nhận solution mới không
     bool should_accept(
@@ -49,7 +50,7 @@ private:
     double cooling_rate_ = 0.99975; // Tốc độ làm lạnh (slow cooling)
     double threshold_ = 0.05;       // Ngưỡng cho threshold accepting
 
-    std::mt19937 rng_{std::random_device{}()};
+    std::mt19937 rng_;
     std::uniform_real_distribution<double> dist_{0.0, 1.0};
 };
 
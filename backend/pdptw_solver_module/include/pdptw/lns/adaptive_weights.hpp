@@ -0,0 +1,55 @@
+#pragma once
+
+#include <random>
+#include <vector>
+
+namespace pdptw {
+namespace lns {
+
+// Tham số của AdaptiveOperatorWeights
+struct AdaptiveWeightsParams {
+    size_t segment_length = 100; // Số lần record mỗi segment
+    double reaction = 0.2;       // Tỷ lệ trọng số mới lấy từ segment vừa xong
+    double min_weight = 0.05;    // Sàn trọng số (giữ khả năng khám phá)
+    // true: reward theo ms đo được (kết quả phụ thuộc tải máy, không tái lập được với cùng seed);
+    // mặc định reward theo lần dùng
+    bool per_millisecond = false;
+};
+
+// Trọng số chọn operator kiểu ALNS: chọn theo roulette, cập nhật theo segment
+// Mỗi segment (segment_length lần record) tính reward = tổng cải thiện / tổng chi phí của từng
+// operator (số lần dùng, hoặc thời gian ms khi per_millisecond), chuẩn hoá theo reward lớn nhất trong segment rồi trộn vào trọng số:
+//   w = (1 - reaction) * w + reaction * reward / max_reward   (kẹp vào [min_weight, 1])
+// Operator không được dùng trong segment giữ nguyên trọng số; segment không có cải thiện
+// nào thì không cập nhật.
+class AdaptiveOperatorWeights {
+public:
+    explicit AdaptiveOperatorWeights(size_t num_operators = 0,
+                                     const AdaptiveWeightsParams &params = AdaptiveWeightsParams());
+
+    // Chọn operator theo roulette trên trọng số hiện tại
+    size_t select(std::mt19937 &rng) const;
+
+    // Ghi nhận một lần dùng operator: improvement >= 0 (objective giảm), elapsed_ms là thời
+    // gian của cả iteration (LNSSolver truyền 1 khi per_millisecond = false). Hết segment thì
+    // cập nhật trọng số.
+    void record(size_t op, double improvement, double elapsed_ms);
+
+    const std::vector<double> &weights() const { return weights_; }
+    size_t size() const { return weights_.size(); }
+    size_t segments() const { return segments_; }
+
+private:
+    void end_segment();
+
+    AdaptiveWeightsParams params_;
+    std::vector<double> weights_;
+    std::vector<double> segment_improvement_;
+    std::vector<double> segment_ms_;
+    std::vector<size_t> segment_used_;
+    size_t segment_records_ = 0;
+    size_t segments_ = 0;
+};
+
+} // namespace lns
+} // namespace pdptw
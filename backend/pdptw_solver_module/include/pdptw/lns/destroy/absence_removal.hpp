@@ -15,13 +15,13 @@ public:
 
     void destroy(
         solution::Solution &solution,
-        size_t num_to_remove) override;
+        size_t num_to_remove,
+        std::mt19937 &rng) override;
 
     std::string name() const override { return "AbsenceRemoval"; }
 
 private:
     AbsenceCounter &absence_counter_;
-    std::mt19937 rng_;
     double randomization_factor_ = 4.0;
 };
 
@@ -16,7 +16,8 @@ public:
 
     void destroy(
         solution::Solution &solution,
-        size_t num_to_remove) override;
+        size_t num_to_remove,
+        std::mt19937 &rng) override;
 
     std::string name() const override { return "AdjacentString"; }
 
@@ -27,8 +28,6 @@ private:
         size_t req1,
         size_t req2);
 
-    std::mt19937 rng_;
-
     // Trọng số tính độ liên quan: khoảng cách, thời gian, demand
     double distance_weight_ = 9.0;
     double time_weight_ = 3.0;
@@ -2,6 +2,7 @@
 #define PDPTW_LNS_DESTROY_OPERATOR_HPP
 
 #include "pdptw/solution/datastructure.hpp"
+#include <random>
 #include <string>
 #include <vector>
 
@@ -9,6 +10,8 @@ namespace pdptw {
 namespace lns {
 
 // Destroy operator: Loại bỏ các request khỏi solution để tạo "lỗ hổng" cho repair operator
+// Không giữ trạng thái giữa các lần gọi (rng do nơi gọi truyền vào) nên một instance
+// operator dùng chung được cho nhiều thread, mỗi thread một solution và một rng
 class DestroyOperator {
 public:
     virtual ~DestroyOperator() = default;
@@ -16,7 +19,8 @@ public:
     // Loại bỏ requests khỏi solution
     virtual void destroy(
         solution::Solution &solution,
-        size_t num_to_remove) = 0;
+        size_t num_to_remove,
+        std::mt19937 &rng) = 0;
 
     virtual std::string name() const = 0;
 
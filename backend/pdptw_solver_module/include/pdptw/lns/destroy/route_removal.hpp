@@ -14,12 +14,10 @@ public:
 
     void destroy(
         solution::Solution &solution,
-        size_t num_to_remove) override;
+        size_t num_to_remove,
+        std::mt19937 &rng) override;
 
     std::string name() const override { return "RouteRemoval"; }
-
-private:
-    std::mt19937 rng_;
 };
 
 } // namespace lns
@@ -16,7 +16,8 @@ public:
 
     void destroy(
         solution::Solution &solution,
-        size_t num_to_remove) override;
+        size_t num_to_remove,
+        std::mt19937 &rng) override;
 
     std::string name() const override { return "WorstRemoval"; }
 
@@ -25,7 +26,6 @@ private:
     std::vector<std::pair<size_t, problem::Num>> calculate_contributions(
         const solution::Solution &solution);
 
-    std::mt19937 rng_;
     double randomization_factor_ = 6.0; // Độ ngẫu nhiên
 };
 
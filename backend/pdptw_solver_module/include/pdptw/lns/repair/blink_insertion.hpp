@@ -0,0 +1,37 @@
+#pragma once
+
+#include "pdptw/construction/insertion.hpp"
+#include "pdptw/lns/repair/operator.hpp"
+#include <vector>
+
+namespace pdptw {
+namespace lns {
+namespace repair {
+
+// Greedy Insertion with blinks (SISR): chèn lần lượt theo thứ tự của sort_unassigned_customers,
+// mỗi vị trí chèn bị bỏ qua với xác suất blink_rate. Không regret, không tìm lại sau mỗi lần
+// chèn; route rỗng chỉ được mở khi các route đang chạy không còn vị trí nào (một route rỗng mỗi
+// vehicle class, không blink). Vị trí chèn lấy qua InsertionCache dùng chung, nên route không
+// đổi từ lần repair trước không phải quét lại.
+class BlinkInsertionOperator : public RepairOperator {
+public:
+    // blink_rate kẹp vào [0, 1] (0: greedy thuần trên các route đang chạy)
+    explicit BlinkInsertionOperator(double blink_rate = 0.05);
+
+    void repair(solution::Solution &solution, Random &rng) override;
+
+    double blink_rate() const { return blink_rate_; }
+
+private:
+    // Vị trí rẻ nhất không bị blink trên các route đang chạy (nullptr nếu tất cả bị bỏ qua)
+    const construction::InsertionCandidate *pick_with_blinks(solution::Solution &solution, size_t request_id,
+                                                             construction::InsertionStats &stats, Random &rng);
+
+    double blink_rate_;
+    construction::InsertionTopK top_;
+    std::vector<construction::InsertionCandidate> candidates_;
+};
+
+} // namespace repair
+} // namespace lns
+} // namespace pdptw
@@ -7,14 +7,16 @@ namespace pdptw {
 namespace lns {
 namespace repair {
 
+// Sắp xếp unassigned customers theo thứ tự chèn (có ngẫu nhiên): random, demand, far, close,
+// độ rộng time window, đầu và cuối time window (dùng chung cho các repair kiểu greedy)
+std::vector<size_t> sort_unassigned_customers(const solution::Solution &solution, Random &rng);
+
 // Greedy Insertion: Chèn request vào vị trí có chi phí tốt nhất (with blinks - có tính ngẫu nhiên)
 class GreedyInsertionOperator : public RepairOperator {
 public:
     void repair(solution::Solution &solution, Random &rng) override;
 
 private:
-    // Sắp xếp unassigned customers theo thứ tự chèn (có ngẫu nhiên)
-    std::vector<size_t> sort_unassigned_customers(solution::Solution &solution, Random &rng);
     // Tìm route trống đầu tiên và chèn request vào
     void find_first_empty_route_and_insert(solution::Solution &solution, size_t pickup_id, Random &rng);
 };
@@ -1,7 +1,10 @@
 #pragma once
 
+#include "pdptw/construction/insertion_cache.hpp"
 #include "pdptw/lns/absence_counter.hpp"
 #include "pdptw/solution/datastructure.hpp"
+#include <memory>
+#include <optional>
 #include <random>
 
 namespace pdptw {
@@ -10,8 +13,60 @@ namespace repair {
 
 using Random = std::mt19937;
 
+// Cache vị trí chèn theo (request, route), dùng chung giữa các repair operator
+// (LNSSolver gán cùng một cache cho tất cả; operator đứng riêng tự tạo cache của mình)
+class InsertionCacheUser {
+public:
+    void set_insertion_cache(std::shared_ptr<construction::InsertionCache> cache) {
+        insertion_cache_ = std::move(cache);
+    }
+
+protected:
+    construction::InsertionCache &insertion_cache() {
+        if (!insertion_cache_) {
+            insertion_cache_ = std::make_shared<construction::InsertionCache>();
+        }
+        return *insertion_cache_;
+    }
+
+private:
+    std::shared_ptr<construction::InsertionCache> insertion_cache_;
+};
+
+// Ngưỡng objective của một lần repair (thường là acceptance_bound() của acceptance
+// criterion): lời giải có objective vượt ngưỡng chắc chắn bị từ chối. Chèn thêm request
+// không làm route ngắn đi (bất đẳng thức tam giác) nên total_cost() của lời giải đang
+// sửa là cận dưới của objective cuối; vượt ngưỡng thì operator dừng, để lại các request
+// chưa chèn và đánh dấu aborted(). Không có bất đẳng thức tam giác thì có thể bỏ lỡ lời giải
+// lẽ ra được chấp nhận, nên LNSSolver chỉ bật khi LNSParameters::repair_cutoff.
+class RepairCostCutoff {
+public:
+    // nullopt: không giới hạn. Xoá cờ aborted của lần repair trước.
+    void set_cost_cutoff(std::optional<double> cutoff) {
+        cost_cutoff_ = cutoff;
+        aborted_ = false;
+    }
+    std::optional<double> cost_cutoff() const { return cost_cutoff_; }
+
+    // Lần repair gần nhất dừng sớm vì vượt ngưỡng (lời giải dở dang, phải rollback)
+    bool aborted() const { return aborted_; }
+
+protected:
+    // Gọi sau mỗi lần chèn: true (và đánh dấu aborted) nếu đã vượt ngưỡng
+    bool exceeds_cost_cutoff(const solution::Solution &solution) {
+        if (cost_cutoff_ && solution.total_cost() > *cost_cutoff_) {
+            aborted_ = true;
+        }
+        return aborted_;
+    }
+
+private:
+    std::optional<double> cost_cutoff_;
+    bool aborted_ = false;
+};
+
 // Repair operator: Chèn các request chưa assign trở lại solution
-class RepairOperator {
+class RepairOperator : public InsertionCacheUser, public RepairCostCutoff {
 public:
     virtual ~RepairOperator() = default;
 
@@ -21,7 +76,7 @@ public:
 };
 
 // Repair operator có sử dụng absence counter (đếm số lần request vắng mặt)
-class AbsenceAwareRepairOperator {
+class AbsenceAwareRepairOperator : public InsertionCacheUser, public RepairCostCutoff {
 public:
     virtual ~AbsenceAwareRepairOperator() = default;
 
@@ -1,15 +1,25 @@
 #pragma once
 
+#include "pdptw/construction/regret_heap.hpp"
 #include "pdptw/lns/repair/operator.hpp"
 
 namespace pdptw {
 namespace lns {
 namespace repair {
 
-// K-Regret Insertion: Chèn request có regret cao nhất (chênh lệch giữa vị trí tốt nhất và tốt thứ 2)
+// K-Regret Insertion: Chèn request có regret cao nhất (chênh lệch giữa vị trí tốt nhất và tốt thứ k)
+// Dùng RegretHeap: sau mỗi lần chèn chỉ cập nhật request bị route vừa đổi ảnh hưởng
 class RegretInsertionOperator : public RepairOperator {
 public:
+    // k kẹp vào [1, 4]
+    explicit RegretInsertionOperator(size_t k = 2) : heap_(k) {}
+
     void repair(solution::Solution &solution, Random &rng) override;
+
+    size_t k() const { return heap_.k(); }
+
+private:
+    construction::RegretHeap heap_;
 };
 
 } // namespace repair
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "pdptw/problem/pdptw.hpp"
+
+#include <cstddef>
+#include <vector>
+
+namespace pdptw::problem {
+
+// Láng giềng granular: mỗi node pickup/delivery giữ k node request gần nhất tương thích
+// time window (đi được i -> j hoặc j -> i mà không trễ due). Tìm kiếm chèn granular chỉ
+// xét các khe (pred, succ) có một đầu là láng giềng của node được chèn.
+class GranularNeighborhood {
+public:
+    GranularNeighborhood(const PDPTWInstance &instance, size_t k);
+
+    size_t k() const { return k_; }
+
+    // Láng giềng của node (sắp theo id, không gồm node cặp); rỗng với depot
+    const std::vector<NodeId> &neighbors(NodeId node_id) const { return neighbors_[node_id]; }
+
+    bool is_neighbor(NodeId node_id, NodeId other) const;
+
+    // Khe pred -> succ hợp lệ cho node: một đầu là láng giềng hoặc node cặp,
+    // hoặc khe là route rỗng (depot -> depot)
+    bool allows_gap(NodeId node_id, NodeId pred, NodeId succ) const {
+        if (pred < num_depot_nodes_ && succ < num_depot_nodes_) {
+            return true;
+        }
+        const NodeId pair = node_id ^ 1; // pickup 2V+2r, delivery 2V+2r+1
+        return pred == pair || succ == pair || is_neighbor(node_id, pred) || is_neighbor(node_id, succ);
+    }
+
+private:
+    size_t k_;
+    size_t num_depot_nodes_;
+    std::vector<std::vector<NodeId>> neighbors_;
+};
+
+} // namespace pdptw::problem
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "pdptw/problem/travel_matrix.hpp"
+
 #include <cstdint>
 #include <memory>
 #include <string>
@@ -9,13 +11,12 @@
 
 namespace pdptw::problem {
 
-class TravelMatrix;
-
 using Num = double;       // Kiểu số cho time/distance
 using Capacity = int16_t; // Kiểu capacity của vehicle
 using RequestId = size_t;
 using NodeId = size_t;
 using VehicleId = size_t;
+using LocationId = uint32_t; // Chỉ số địa điểm vật lý (hàng/cột của TravelMatrix)
 
 // Loại node
 enum class NodeType {
@@ -96,13 +97,27 @@ struct DistanceAndTime {
     Num time;
 };
 
+// Đặc điểm của instance, phát hiện một lần khi tạo instance. Tìm vị trí chèn dùng chúng
+// để chọn biến thể đánh giá bỏ bớt phần việc không cần (xem Insertion)
+struct InstanceTraits {
+    bool capacity_unbounded = false;   // Tổng demand mọi request không vượt capacity xe nhỏ nhất
+    bool symmetric = false;            // distance và time đối xứng (a->b bằng b->a)
+    bool time_equals_distance = false; // time bằng distance trên mọi cung
+
+    bool any() const { return capacity_unbounded || symmetric || time_equals_distance; }
+};
+
+std::string to_string(const InstanceTraits &traits);
+
 // PDPTW problem instance
 class PDPTWInstance {
 public:
     PDPTWInstance() = default;
+    // node_locations: node -> địa điểm trong travel_matrix (rỗng: node i là địa điểm i)
     PDPTWInstance(std::string name, size_t num_requests, size_t num_vehicles,
                   std::vector<Node> nodes, std::vector<Vehicle> vehicles,
-                  std::shared_ptr<TravelMatrix> travel_matrix);
+                  std::shared_ptr<TravelMatrix> travel_matrix,
+                  std::vector<LocationId> node_locations = {});
 
     const std::string &name() const { return name_; }
     size_t num_requests() const { return num_requests_; }
@@ -110,15 +125,44 @@ public:
     const std::vector<Node> &nodes() const { return nodes_; }
     const std::vector<Vehicle> &vehicles() const { return vehicles_; }
 
-    // Truy cập travel matrix
-    Num distance(NodeId from, NodeId to) const;
-    Num time(NodeId from, NodeId to) const;
-    DistanceAndTime distance_and_time(NodeId from, NodeId to) const;
+    // Truy cập travel matrix (hot path: không kiểm tra biên, node id phải hợp lệ)
+    Num distance(NodeId from, NodeId to) const noexcept {
+        return travel_matrix_->arc(node_locations_[from], node_locations_[to]).distance;
+    }
+    Num time(NodeId from, NodeId to) const noexcept {
+        return travel_matrix_->arc(node_locations_[from], node_locations_[to]).time;
+    }
+    DistanceAndTime distance_and_time(NodeId from, NodeId to) const noexcept {
+        const TravelArc arc = travel_matrix_->arc(node_locations_[from], node_locations_[to]);
+        return DistanceAndTime{arc.distance, arc.time};
+    }
+    // Như distance_and_time với precision của ma trận chọn trước (with_matrix_precision)
+    template <MatrixPrecision P>
+    DistanceAndTime distance_and_time_as(NodeId from, NodeId to) const noexcept {
+        const TravelArc arc = travel_matrix_->arc_as<P>(node_locations_[from], node_locations_[to]);
+        return DistanceAndTime{arc.distance, arc.time};
+    }
+    const TravelMatrix &travel_matrix() const { return *travel_matrix_; }
+    const std::shared_ptr<TravelMatrix> &shared_travel_matrix() const { return travel_matrix_; }
+
+    // Địa điểm vật lý của node (các depot dùng chung một địa điểm)
+    LocationId location_of(NodeId node_id) const { return node_locations_[node_id]; }
+    const std::vector<LocationId> &node_locations() const { return node_locations_; }
 
     // Truy cập vehicle
     const Vehicle &vehicle_from_vn_id(NodeId vn_id) const;
     NodeId vn_id_of(VehicleId v_id) const;
 
+    // Lớp xe: cùng capacity, shift_length, địa điểm và time window của depot.
+    // Route rỗng của các xe cùng lớp cho kết quả chèn giống hệt nhau.
+    size_t vehicle_class(VehicleId v_id) const { return vehicle_classes_[v_id]; }
+    size_t num_vehicle_classes() const { return num_vehicle_classes_; }
+
+    // Đặc điểm phát hiện khi tạo instance (travel matrix phải đã đầy đủ lúc đó)
+    const InstanceTraits &traits() const { return traits_; }
+    // Chỉ giữ các trait có trong allowed (tắt bớt để so sánh/đo đạc; không bật thêm được)
+    void restrict_traits(const InstanceTraits &allowed);
+
     // Kiểm tra loại node
     NodeType node_type(NodeId id) const;
     bool is_request(NodeId node_id) const;
@@ -142,6 +186,13 @@ private:
     std::vector<Node> nodes_;
     std::vector<Vehicle> vehicles_;
     std::shared_ptr<TravelMatrix> travel_matrix_;
+    std::vector<LocationId> node_locations_;
+    std::vector<size_t> vehicle_classes_;
+    size_t num_vehicle_classes_ = 0;
+    InstanceTraits traits_;
+
+    void compute_vehicle_classes();
+    void compute_traits();
 };
 
 // Tạo PDPTW instance với preprocessing (time window tightening, etc.)
@@ -151,6 +202,7 @@ PDPTWInstance create_instance_with(
     size_t num_requests,
     std::vector<Vehicle> vehicles,
     std::vector<Node> nodes,
-    std::shared_ptr<TravelMatrix> travel_matrix);
+    std::shared_ptr<TravelMatrix> travel_matrix,
+    std::vector<LocationId> node_locations = {});
 
 } // namespace pdptw::problem
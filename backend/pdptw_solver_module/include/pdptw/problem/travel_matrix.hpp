@@ -1,30 +1,204 @@
 #pragma once
 
+#include "pdptw/utils/aligned_allocator.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <string>
+#include <type_traits>
 #include <vector>
 
 namespace pdptw::problem {
 
+// Một cung from -> to: distance và time của cung
+struct TravelArc {
+    double distance;
+    double time;
+};
+
+// Kiểu số dùng để lưu giá trị trong ma trận
+enum class MatrixPrecision : uint8_t {
+    Float64, // double, luôn chính xác
+    Float32, // float, chỉ dùng khi mọi giá trị biểu diễn chính xác bằng float
+    UInt32   // fixed-point scale 1, cho instance có giá trị nguyên không âm
+};
+
+// Chế độ lưu trữ: kiểu số + có dùng chung một mảng cho time và distance không
+struct MatrixStorage {
+    MatrixPrecision precision = MatrixPrecision::Float64;
+    bool shared_time_distance = false;
+
+    bool operator==(const MatrixStorage &other) const {
+        return precision == other.precision &&
+               shared_time_distance == other.shared_time_distance;
+    }
+    bool operator!=(const MatrixStorage &other) const { return !(*this == other); }
+};
+
+std::string to_string(const MatrixStorage &storage);
+
+// Tính chất của các giá trị trong ma trận (xem TravelMatrix::traits)
+struct MatrixTraits {
+    bool symmetric = false;            // distance và time đối xứng (a->b bằng b->a)
+    bool time_equals_distance = false; // time bằng distance trên mọi cung
+};
+
+// Kiểu C++ lưu một giá trị của ma trận theo precision
+template <MatrixPrecision P>
+struct MatrixValue {
+    using type = double;
+};
+template <>
+struct MatrixValue<MatrixPrecision::Float32> {
+    using type = float;
+};
+template <>
+struct MatrixValue<MatrixPrecision::UInt32> {
+    using type = uint32_t;
+};
+template <MatrixPrecision P>
+using matrix_value_t = typename MatrixValue<P>::type;
+
+// Gọi fn với precision dưới dạng hằng biên dịch (std::integral_constant), chọn một lần
+// ngoài vòng lặp để bên trong dùng TravelMatrix::arc_as<P>()
+template <typename Fn>
+decltype(auto) with_matrix_precision(MatrixPrecision precision, Fn &&fn) {
+    switch (precision) {
+    case MatrixPrecision::Float32:
+        return fn(std::integral_constant<MatrixPrecision, MatrixPrecision::Float32>{});
+    case MatrixPrecision::UInt32:
+        return fn(std::integral_constant<MatrixPrecision, MatrixPrecision::UInt32>{});
+    case MatrixPrecision::Float64:
+    default:
+        return fn(std::integral_constant<MatrixPrecision, MatrixPrecision::Float64>{});
+    }
+}
+
+// Quan sát các giá trị của ma trận để chọn chế độ lưu trữ gọn nhất mà không mất độ chính xác
+class MatrixStorageDetector {
+public:
+    void observe(double distance, double time) {
+        shared_ &= (distance == time);
+        observe_value(distance);
+        observe_value(time);
+    }
+
+    void merge(const MatrixStorageDetector &other) {
+        shared_ &= other.shared_;
+        fits_float_ &= other.fits_float_;
+        fits_uint32_ &= other.fits_uint32_;
+    }
+
+    MatrixStorage storage() const;
+
+private:
+    void observe_value(double value) {
+        fits_float_ &= (static_cast<double>(static_cast<float>(value)) == value);
+        fits_uint32_ &= (value >= 0.0 && value <= 4294967295.0 &&
+                         static_cast<double>(static_cast<uint32_t>(value)) == value);
+    }
+
+    bool shared_ = true;
+    bool fits_float_ = true;
+    bool fits_uint32_ = true;
+};
+
 // Ma trận lưu trữ thời gian và khoảng cách di chuyển giữa các địa điểm
+// Lưu row-major trong một buffer liên tục, căn chỉnh theo cache line.
+// Mỗi ô gồm 1 (shared) hoặc 2 (distance, time) giá trị kiểu precision.
 class TravelMatrix {
 public:
     TravelMatrix() = default;
-    explicit TravelMatrix(size_t size);
+    explicit TravelMatrix(size_t size, MatrixStorage storage = {});
+
+    // Ma trận chỉ đọc trên vùng nhớ bên ngoài (ví dụ file .pdptwbin đã mmap)
+    // owner giữ cho vùng nhớ còn sống chừng nào ma trận còn được dùng
+    // Ném std::invalid_argument nếu data không căn chỉnh theo kiểu giá trị của precision
+    static TravelMatrix borrow(size_t size, MatrixStorage storage,
+                               const std::byte *data, std::shared_ptr<const void> owner);
 
-    // Lấy thời gian/khoảng cách di chuyển
+    TravelMatrix(const TravelMatrix &other);
+    TravelMatrix(TravelMatrix &&other) noexcept;
+    TravelMatrix &operator=(const TravelMatrix &other);
+    TravelMatrix &operator=(TravelMatrix &&other) noexcept;
+
+    // Lấy thời gian/khoảng cách di chuyển (có kiểm tra biên, dùng cho I/O)
     double get_time(size_t from, size_t to) const;
     double get_distance(size_t from, size_t to) const;
 
+    // Truy cập không kiểm tra biên với precision biết lúc biên dịch (hot path của solver)
+    // Caller phải đảm bảo from, to < size() và P == storage().precision
+    template <MatrixPrecision P>
+    TravelArc arc_as(size_t from, size_t to) const noexcept {
+        // time nằm ngay sau distance, hoặc trùng ô khi dùng chung (lanes_ == 1)
+        const auto *values = reinterpret_cast<const matrix_value_t<P> *>(data_);
+        const size_t idx = (from * size_ + to) * lanes_;
+        return TravelArc{static_cast<double>(values[idx]), static_cast<double>(values[idx + lanes_ - 1])};
+    }
+
+    // Như arc_as nhưng chọn precision ở mỗi lần gọi; vòng lặp nóng nên chọn precision một
+    // lần bằng with_matrix_precision rồi gọi arc_as<P>()
+    TravelArc arc(size_t from, size_t to) const noexcept {
+        switch (storage_.precision) {
+        case MatrixPrecision::Float32:
+            return arc_as<MatrixPrecision::Float32>(from, to);
+        case MatrixPrecision::UInt32:
+            return arc_as<MatrixPrecision::UInt32>(from, to);
+        case MatrixPrecision::Float64:
+        default:
+            return arc_as<MatrixPrecision::Float64>(from, to);
+        }
+    }
+
     // Đặt thời gian/khoảng cách di chuyển
+    // Ở chế độ shared, set_time và set_distance ghi cùng một ô
     void set_time(size_t from, size_t to, double time);
     void set_distance(size_t from, size_t to, double distance);
 
+    // Đặt cả hai giá trị của một cung (ném lỗi nếu không biểu diễn được ở chế độ hiện tại)
+    void set_arc(size_t from, size_t to, double distance, double time);
+
     size_t size() const;
+    const MatrixStorage &storage() const { return storage_; }
+
+    // Dữ liệu thô của ma trận (memory_bytes() byte, row-major)
+    const std::byte *data() const { return data_; }
+    size_t memory_bytes() const;
+
+    // true nếu ma trận trỏ vào vùng nhớ bên ngoài (không ghi được)
+    bool is_borrowed() const { return owner_ != nullptr; }
+
+    // Dữ liệu thô để ghi trực tiếp (parser). Ném std::logic_error nếu ma trận là borrow
+    std::byte *mutable_data();
+
+    // Tính chất của ma trận: quét O(n^2) ở lần gọi đầu rồi cache trên ma trận, nên các
+    // instance dùng chung ma trận (sub-instance của splitter) không quét lại.
+    // Ghi vào ma trận (set_*, mutable_data) xoá cache
+    MatrixTraits traits() const;
+    // Đặt sẵn kết quả đã biết (ví dụ đọc từ header .pdptwbin) để bỏ qua lần quét
+    void set_traits(const MatrixTraits &traits);
+
+    // Thu gọn tại chỗ ma trận float64 sang precision nhỏ hơn. Không cấp phát lại: bộ nhớ
+    // đỉnh là buffer float64 và capacity được giữ nguyên (memory_bytes() là phần đang dùng)
+    // Caller phải đảm bảo mọi giá trị biểu diễn chính xác được (xem MatrixStorageDetector)
+    void narrow_to(MatrixPrecision precision);
 
 private:
-    std::vector<std::vector<double>> times_;
-    std::vector<std::vector<double>> distances_;
+    void check_bounds(size_t from, size_t to) const;
+    void store(size_t idx, double value);
+    MatrixTraits scan_traits() const;
+
+    std::vector<std::byte, utils::AlignedAllocator<std::byte>> buffer_;
+    std::shared_ptr<const void> owner_; // Chủ sở hữu vùng nhớ khi borrow
+    const std::byte *data_ = nullptr;   // buffer_.data() hoặc vùng nhớ borrow
     size_t size_ = 0;
+    size_t lanes_ = 2;
+    MatrixStorage storage_;
+    // Cache của traits(): 0 = chưa tính, ngược lại kTraitsKnown | các bit tính chất.
+    // Atomic vì nhiều luồng có thể tạo instance trên cùng ma trận; tính trùng là vô hại
+    mutable std::atomic<uint8_t> traits_{0};
 };
 
 } // namespace pdptw::problem
@@ -0,0 +1,129 @@
+#ifndef PDPTW_REFN_REF_BATCH_HPP
+#define PDPTW_REFN_REF_BATCH_HPP
+
+#include "pdptw/refn/ref_data.hpp"
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace pdptw {
+namespace refn {
+
+// Backend của kernel đánh giá theo lô
+enum class BatchBackend {
+    Scalar, // Vòng lặp vô hướng trên SoA
+    Avx2    // 4 lane double mỗi lệnh; rơi về Scalar nếu không build kèm hoặc CPU không hỗ trợ
+};
+
+// AVX2 dùng được không (build với ENABLE_AVX2 và CPU hỗ trợ)
+bool avx2_available();
+
+namespace detail {
+
+// Con trỏ thô vào dữ liệu SoA của một lô. Kernel AVX2 được biên dịch với -mavx2 nên
+// chỉ làm việc trên struct này, không gọi hàm inline/template dùng chung với TU khác.
+struct DeliveryLanes {
+    size_t size;
+
+    Num delivery_ready;
+    Num delivery_due;
+    Num delivery_service;
+    Num delivery_demand;
+    Num capacity;
+
+    const Num *pickup_new_cost;
+    const Num *pickup_old_cost;
+    const Num *segment_completion;
+    const Num *segment_load;
+    const Num *segment_max_load;
+    const Num *time_in;
+    const Num *time_out;
+    const Num *next_latest_start;
+    const Num *next_max_load;
+    const Num *dist_in;
+    const Num *dist_out;
+    const Num *removed_new;
+    const Num *removed_old;
+
+    Num *cost;
+    uint8_t *feasible;
+};
+
+void evaluate_delivery_lanes_scalar(const DeliveryLanes &lanes, size_t begin, size_t end);
+void evaluate_delivery_lanes_avx2(const DeliveryLanes &lanes);
+
+} // namespace detail
+
+// Lô các vị trí chèn delivery của một request vào một route, lưu dạng SoA.
+// Lane i: segment_i = [depot_start .. pickup .. last_i], rồi delivery, rồi bw_data(next_i).
+// feasible/cost của mỗi lane giống hệt extend_forward_into_target + concat_into_target +
+// check_capacity và Insertion::calculate_insertion_cost trên từng vị trí.
+class DeliveryBatch {
+public:
+    // Bắt đầu lô mới cho delivery này trên xe có capacity đã cho
+    void reset(const REFNode &delivery, Capacity capacity);
+
+    // Thêm lane. pickup_new_cost/pickup_old_cost: pickup_after -> pickup -> pickup_before
+    // thay cho pickup_after -> pickup_before. dist_in/time_in: last -> delivery,
+    // dist_out/time_out: delivery -> next. removed_new: cạnh pickup -> pickup_before bị thay
+    // khi delivery ngay sau pickup, removed_old: cạnh last -> next trong các trường hợp còn lại.
+    void push(const REFData &segment, const REFData &next,
+              Num pickup_new_cost, Num pickup_old_cost,
+              Num time_in, Num time_out, Num dist_in, Num dist_out,
+              Num removed_new, Num removed_old);
+
+    size_t size() const { return segment_completion_.size(); }
+
+    void evaluate(BatchBackend backend);
+
+    bool feasible(size_t lane) const { return feasible_[lane] != 0; }
+    Num cost(size_t lane) const { return cost_[lane]; }
+
+private:
+    REFNode delivery_;
+    Capacity capacity_ = 0;
+
+    std::vector<Num> pickup_new_cost_;
+    std::vector<Num> pickup_old_cost_;
+    std::vector<Num> segment_completion_;
+    std::vector<Num> segment_load_;
+    std::vector<Num> segment_max_load_;
+    std::vector<Num> time_in_;
+    std::vector<Num> time_out_;
+    std::vector<Num> next_latest_start_; // -inf khi segment hoặc bw_data(next) không khả thi
+    std::vector<Num> next_max_load_;
+    std::vector<Num> dist_in_;
+    std::vector<Num> dist_out_;
+    std::vector<Num> removed_new_;
+    std::vector<Num> removed_old_;
+
+    std::vector<Num> cost_;
+    std::vector<uint8_t> feasible_;
+};
+
+// Inline: được gọi cho mọi cặp vị trí trong vòng lặp nóng của find_insertions_in_route
+inline void DeliveryBatch::push(const REFData &segment, const REFData &next,
+                                Num pickup_new_cost, Num pickup_old_cost,
+                                Num time_in, Num time_out, Num dist_in, Num dist_out,
+                                Num removed_new, Num removed_old) {
+    pickup_new_cost_.push_back(pickup_new_cost);
+    pickup_old_cost_.push_back(pickup_old_cost);
+    segment_completion_.push_back(segment.earliest_completion);
+    segment_load_.push_back(segment.current_load);
+    segment_max_load_.push_back(segment.max_load);
+    time_in_.push_back(time_in);
+    time_out_.push_back(time_out);
+    next_latest_start_.push_back(segment.tw_feasible && next.tw_feasible
+                                     ? next.latest_start
+                                     : -std::numeric_limits<Num>::infinity());
+    next_max_load_.push_back(next.max_load);
+    dist_in_.push_back(dist_in);
+    dist_out_.push_back(dist_out);
+    removed_new_.push_back(removed_new);
+    removed_old_.push_back(removed_old);
+}
+
+} // namespace refn
+} // namespace pdptw
+
+#endif // PDPTW_REFN_REF_BATCH_HPP
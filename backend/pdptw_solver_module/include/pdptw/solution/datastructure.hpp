@@ -5,8 +5,8 @@
 #include "pdptw/solution/blocknode.hpp"
 #include "pdptw/solution/ref_node_vec.hpp"
 #include "pdptw/solution/requestbank.hpp"
+#include <cstdint>
 #include <memory>
-#include <unordered_map>
 #include <vector>
 
 /**
@@ -132,14 +132,14 @@ public:
      * @param node_id Node ID
      * @return ID of predecessor node
      */
-    size_t pred(size_t node_id) const;
+    size_t pred(size_t node_id) const { return fw_data_.pred(node_id); }
 
     /**
      * @brief Get successor of a node
      * @param node_id Node ID
      * @return ID of successor node
      */
-    size_t succ(size_t node_id) const;
+    size_t succ(size_t node_id) const { return fw_data_.succ(node_id); }
 
     /**
      * @brief Get predecessor and successor pair
@@ -153,7 +153,7 @@ public:
      * @param node_id Node ID
      * @return Vehicle node ID (start of route)
      */
-    size_t vn_id(size_t node_id) const;
+    size_t vn_id(size_t node_id) const { return fw_data_.vn_id(node_id); }
 
     // ============================================================
     // Solution modification
@@ -280,9 +280,9 @@ public:
 
     /**
      * @brief Calculate total travel distance/cost
-     * @return Sum of distances across all routes
+     * @return Sum of distances across all routes (maintained on every route update, O(1))
      */
-    double total_cost() const;
+    double total_cost() const { return total_distance_; }
 
     /**
      * @brief Calculate total waiting time
@@ -292,7 +292,7 @@ public:
 
     /**
      * @brief Calculate solution objective value
-     * @return Total cost + penalty for unassigned requests
+     * @return Total cost + penalty for unassigned requests (O(1))
      */
     double objective() const;
 
@@ -300,7 +300,7 @@ public:
      * @brief Count non-empty routes currently in use
      * @return Number of routes that contain at least one pickup/delivery
      */
-    size_t number_of_non_empty_routes() const;
+    size_t number_of_non_empty_routes() const { return non_empty_routes_.size(); }
 
     // ============================================================
     // Route iteration
@@ -321,10 +321,10 @@ public:
     std::vector<size_t> iter_route_by_vn_id(size_t vn_id) const;
 
     /**
-     * @brief Iterate through all route IDs
-     * @return Vector of route indices (0 to num_vehicles-1)
+     * @brief Iterate through non-empty route IDs
+     * @return Vector of non-empty route indices in ascending order
      */
-    std::vector<size_t> iter_route_ids() const;
+    std::vector<size_t> iter_route_ids() const { return non_empty_routes_; }
 
     /**
      * @brief Iterate through empty route IDs
@@ -361,6 +361,17 @@ public:
      */
     void unassign_complete_route(size_t route_id);
 
+    /**
+     * @brief Make the given routes identical to the same routes of another Solution
+     * @param source Solution of the same instance
+     * @param route_ids Routes to copy (must contain every route whose requests differ)
+     *
+     * Unassigns the routes, relinks them with source's itineraries and removes their
+     * requests from the bank. Costs O(length of the routes) instead of a full copy,
+     * and keeps this object's uid() so insertion caches stay bound to it.
+     */
+    void replay_routes(const Solution &source, const std::vector<size_t> &route_ids);
+
     /**
      * @brief Reduce maximum available vehicles to current usage
      *
@@ -383,13 +394,14 @@ public:
     SolutionDescription to_description() const;
 
     // ============================================================
-    // Cache lookup methods (O(1) operations)
+    // Route lookup (O(1), derived from the vn_id of the forward links)
     // ============================================================
 
     /**
      * @brief Get route ID for a node (O(1))
-     * @param node_id Node ID to lookup
-     * @return Route ID if found, otherwise searches linearly (fallback)
+     * @param node_id Node ID to lookup (depot nodes map to their own vehicle)
+     * @return Route ID of the node
+     * @throws std::runtime_error if the node is unassigned
      */
     size_t route_of_node(size_t node_id) const;
 
@@ -408,36 +420,146 @@ public:
      */
     bool is_request_assigned(size_t request_id) const;
 
+    /**
+     * @brief Position of a node in its route (start depot = 0)
+     *
+     * Renumbered for the whole route whenever its blocks are revalidated, i.e.
+     * after every validate_between()/set(). Only meaningful for assigned nodes.
+     */
+    size_t position(size_t node_id) const { return positions_[node_id]; }
+
+    /**
+     * @brief Check whether node a comes strictly before node b in the same route (O(1))
+     * @pre Both nodes are depots or assigned nodes of validated routes
+     */
+    bool is_before(size_t a, size_t b) const {
+        return fw_data_.vn_id(a) == fw_data_.vn_id(b) && positions_[a] < positions_[b];
+    }
+
+    // ============================================================
+    // Undo journal (LNS destroy/repair in place)
+    // ============================================================
+
+    /**
+     * @brief Start recording an undo journal
+     *
+     * Every mutation made through Solution's methods or the RequestBank saves the
+     * previous state of each touched node/route once, so rollback_transaction()
+     * costs O(changed nodes) instead of a full Solution copy. Direct writes through
+     * the non-const fw_data()/bw_data()/blocks() accessors are not journaled.
+     *
+     * @throws std::logic_error if a transaction is already active
+     */
+    void begin_transaction();
+
+    /**
+     * @brief Keep all changes made since begin_transaction()
+     */
+    void commit_transaction();
+
+    /**
+     * @brief Restore the state at begin_transaction()
+     */
+    void rollback_transaction();
+
+    bool in_transaction() const { return journal_active_; }
+
+    /**
+     * @brief Number of nodes saved in the active journal
+     */
+    size_t journaled_nodes() const { return node_undo_.size(); }
+
+    /**
+     * @brief Routes touched in the active transaction (each once)
+     */
+    std::vector<size_t> journaled_routes() const;
+
+    /**
+     * @brief Version of a route's content
+     *
+     * Changes whenever the route is modified and is restored by rollback, so equal
+     * (uid(), route_version()) pairs always mean identical itineraries.
+     */
+    uint64_t route_version(size_t route_id) const { return route_versions_[route_id]; }
+
+    /**
+     * @brief Identity of this Solution object (a copy gets a new uid)
+     */
+    uint64_t uid() const { return uid_.value; }
+
 private:
-    // Cache management
-    void update_cache_on_insert(size_t pickup_id, size_t delivery_id, size_t route_id);
-    void update_cache_on_remove(size_t pickup_id, size_t delivery_id);
-    void rebuild_cache();
+    // Undo journal: lưu trạng thái cũ trước khi ghi (mỗi node/route một lần mỗi transaction)
+    void touch_node(size_t node_id);
+    void touch_route(size_t route_id);
+    void touch_all();
+
+    void reset_depot_positions();
+
+    // Tổng hợp theo route: đồng bộ distance/trạng thái rỗng của route với fw_data_ của depot cuối,
+    // trả về true nếu có thay đổi (khi đó gọi recompute_total_distance)
+    bool sync_route_summary(size_t route_id);
+    void sync_all_route_summaries();
+    void recompute_total_distance();
 
     const PDPTWInstance *instance_; ///< Problem instance
 
     REFNodeVec fw_data_; ///< Forward REF data
     REFNodeVec bw_data_; ///< Backward REF data
     BlockNodes blocks_;  ///< Block structures
+    std::vector<LinkIndex> positions_; ///< Vị trí của node trong route (đánh lại khi revalidate)
 
     std::vector<bool> empty_route_ids_; ///< Tracks empty routes
+
+    // Duy trì ở mỗi lần cập nhật route (revalidate_blocks, clear, set, rollback)
+    std::vector<double> route_distances_; ///< Distance của route đã đồng bộ với depot cuối
+    std::vector<size_t> non_empty_routes_; ///< Các route không rỗng, tăng dần
+    double total_distance_ = 0.0;           ///< Tổng distance của các route không rỗng
     RequestBank unassigned_requests_;   ///< Unassigned requests
 
     size_t max_num_vehicles_available_; ///< Maximum vehicles
     size_t num_requests_;               ///< Number of requests
 
     // ============================================================
-    // CACHING STRUCTURES
+    // UNDO JOURNAL
     // ============================================================
 
-    struct RequestAssignment {
+    struct NodeUndo {
+        size_t node_id;
+        REFNodeVec::State fw;
+        REFNodeVec::State bw;
+        LinkIndex position;
+        BlockNode block;
+        bool block_start;
+    };
+
+    struct RouteUndo {
         size_t route_id;
-        size_t pickup_position; // Position in route iteration
-        size_t delivery_position;
+        bool empty;
+        uint64_t version;
+    };
+
+    // Định danh của đối tượng Solution: bản copy luôn nhận định danh mới
+    struct ObjectUid {
+        uint64_t value;
+        ObjectUid();
+        ObjectUid(const ObjectUid &) : ObjectUid() {}
+        ObjectUid &operator=(const ObjectUid &) {
+            value = ObjectUid().value;
+            return *this;
+        }
     };
 
-    std::unordered_map<size_t, size_t> node_to_route_;                  ///< O(1) lookup: node_id -> route_id
-    std::unordered_map<size_t, RequestAssignment> request_assignments_; ///< O(1) lookup: request_id -> assignment
+    bool journal_active_ = false;
+    uint32_t journal_epoch_ = 0;
+    std::vector<uint32_t> node_stamps_;  ///< node_stamps_[i] == journal_epoch_: node đã được lưu
+    std::vector<uint32_t> route_stamps_; ///< Tương tự cho route
+    std::vector<NodeUndo> node_undo_;
+    std::vector<RouteUndo> route_undo_;
+    size_t saved_max_num_vehicles_ = 0;
+
+    std::vector<uint64_t> route_versions_; ///< Phiên bản nội dung của từng route
+    uint64_t route_version_counter_ = 0;
+    ObjectUid uid_;
 };
 
 } // namespace pdptw::solution
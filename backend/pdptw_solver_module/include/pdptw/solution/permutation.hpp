@@ -1,5 +1,6 @@
 #pragma once
 
+#include "pdptw/problem/granular_neighborhood.hpp"
 #include "pdptw/problem/pdptw.hpp"
 #include "pdptw/solution/datastructure.hpp"
 #include <array>
@@ -66,10 +67,12 @@ class PermutationOps {
 public:
     // Tìm random feasible insertion cho request (bất kỳ route nào)
     // Dùng reservoir sampling để chọn 1 random feasible insertion
+    // granular: chỉ xét các khe kề láng giềng của pickup/delivery
     static std::optional<PDInsertion> find_random_insert_for_request(
         const Solution &sol,
         size_t pickup_id,
-        std::mt19937 &rng);
+        std::mt19937 &rng,
+        const problem::GranularNeighborhood *granular = nullptr);
 
     // Tìm random feasible insertion trong route cụ thể
     static ReservoirSampling find_random_insert_in_route(
@@ -77,7 +80,8 @@ public:
         size_t pickup_id,
         size_t route_id,
         std::mt19937 &rng,
-        ReservoirSampling sampling);
+        ReservoirSampling sampling,
+        const problem::GranularNeighborhood *granular = nullptr);
 
     // Tìm tất cả feasible insertions cho request trong route
     static std::vector<PDInsertion> find_all_inserts_for_request_in_route(
@@ -2,32 +2,66 @@
 #define PDPTW_SOLUTION_REF_NODE_VEC_HPP
 
 #include "pdptw/problem/pdptw.hpp"
-#include "pdptw/solution/ref_list_node.hpp"
+#include "pdptw/refn/ref_data.hpp"
+#include "pdptw/refn/ref_node.hpp"
 #include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
 #include <vector>
 
 namespace pdptw {
 namespace solution {
 
+// Chỉ số node trong các mảng liên kết (32 bit là đủ cho mọi instance)
+using LinkIndex = uint32_t;
+
+// Mảng REFNode chỉ đọc, dùng chung giữa fw/bw và giữa các bản copy của Solution
+using SharedREFNodes = std::shared_ptr<const std::vector<refn::REFNode>>;
+
 // REF Node Vector: Lưu trữ chính cho route representation của solution
-// - Vector storage với O(1) random access by node ID
-// - Doubly-linked list qua succ/pred pointers
-// - REF data propagation cho feasibility checking
+// - Structure-of-arrays: succ/pred/vn_id và REF data nằm ở các mảng riêng,
+//   nên việc duyệt route chỉ kéo mảng succ (4 byte/node) qua cache
+// - Thông tin tĩnh của node (REFNode) nằm trong một mảng dùng chung
+// - operator[] trả về proxy tham chiếu có cùng các trường như REFListNode
 //
 // Invariants:
-// - data[i*2] là start depot của vehicle i
-// - data[i*2+1] là end depot của vehicle i
+// - node i*2 là start depot của vehicle i
+// - node i*2+1 là end depot của vehicle i
 // - Unassigned requests: vn_id = node_id, succ = pred = node_id
 class REFNodeVec {
-private:
-    std::vector<REFListNode> data;
-
 public:
+    // Proxy tham chiếu tới một node (Link/Data là const với truy cập const)
+    template <typename Link, typename Data>
+    struct NodeRef {
+        const refn::REFNode &node;
+        Link &succ;
+        Link &pred;
+        Link &vn_id;
+        Data &data;
+    };
+    using Reference = NodeRef<LinkIndex, refn::REFData>;
+    using ConstReference = NodeRef<const LinkIndex, const refn::REFData>;
+
+    // Trạng thái thay đổi được của một node (dùng cho undo journal)
+    struct State {
+        LinkIndex succ;
+        LinkIndex pred;
+        LinkIndex vn_id;
+        refn::REFData data;
+    };
+
     // Khởi tạo từ PDPTW instance (vehicle depots linked, requests unassigned)
     explicit REFNodeVec(const problem::PDPTWInstance &instance);
 
-    size_t size() const { return data.size(); }
-    bool empty() const { return data.empty(); }
+    // Như trên nhưng dùng lại mảng REFNode đã có (xem make_nodes())
+    REFNodeVec(const problem::PDPTWInstance &instance, SharedREFNodes nodes);
+
+    // Tạo mảng REFNode cho instance
+    static SharedREFNodes make_nodes(const problem::PDPTWInstance &instance);
+
+    size_t size() const { return succ_.size(); }
+    bool empty() const { return succ_.empty(); }
 
     // Reset về initial state (all unassigned)
     void reset(const problem::PDPTWInstance &instance);
@@ -43,24 +77,78 @@ public:
     void extend_backward_unchecked(size_t from, size_t to,
                                    const problem::PDPTWInstance &instance);
 
+    // Truy cập trực tiếp từng mảng (hot path)
+    size_t succ(size_t index) const { return succ_[index]; }
+    size_t pred(size_t index) const { return pred_[index]; }
+    size_t vn_id(size_t index) const { return vn_id_[index]; }
+    const refn::REFData &data(size_t index) const { return data_[index]; }
+    refn::REFData &data(size_t index) { return data_[index]; }
+    const refn::REFNode &node(size_t index) const { return (*nodes_)[index]; }
+    const SharedREFNodes &shared_nodes() const { return nodes_; }
+
+    State state(size_t index) const {
+        return State{succ_[index], pred_[index], vn_id_[index], data_[index]};
+    }
+    void restore(size_t index, const State &state) {
+        succ_[index] = state.succ;
+        pred_[index] = state.pred;
+        vn_id_[index] = state.vn_id;
+        data_[index] = state.data;
+    }
+
     // Array access operators
-    REFListNode &operator[](size_t index) { return data[index]; }
-    const REFListNode &operator[](size_t index) const { return data[index]; }
+    Reference operator[](size_t index) {
+        return Reference{(*nodes_)[index], succ_[index], pred_[index], vn_id_[index], data_[index]};
+    }
+    ConstReference operator[](size_t index) const {
+        return ConstReference{(*nodes_)[index], succ_[index], pred_[index], vn_id_[index], data_[index]};
+    }
+
+    // Iterator support (trả về proxy theo giá trị)
+    template <typename Vec, typename Ref>
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Ref;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = Ref;
+
+        Iterator(Vec *vec, size_t index) : vec_(vec), index_(index) {}
+
+        Ref operator*() const { return (*vec_)[index_]; }
+        Iterator &operator++() {
+            ++index_;
+            return *this;
+        }
+        Iterator operator++(int) {
+            Iterator copy = *this;
+            ++index_;
+            return copy;
+        }
+        bool operator==(const Iterator &other) const { return index_ == other.index_; }
+        bool operator!=(const Iterator &other) const { return index_ != other.index_; }
 
-    // Iterator support
-    using iterator = std::vector<REFListNode>::iterator;
-    using const_iterator = std::vector<REFListNode>::const_iterator;
+    private:
+        Vec *vec_;
+        size_t index_;
+    };
+    using iterator = Iterator<REFNodeVec, Reference>;
+    using const_iterator = Iterator<const REFNodeVec, ConstReference>;
 
-    iterator begin() { return data.begin(); }
-    iterator end() { return data.end(); }
-    const_iterator begin() const { return data.begin(); }
-    const_iterator end() const { return data.end(); }
-    const_iterator cbegin() const { return data.cbegin(); }
-    const_iterator cend() const { return data.cend(); }
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, size()); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, size()); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
 
 private:
-    // Helper cho extend operations: trả về (const source, mutable target)
-    std::pair<const REFListNode *, REFListNode *> get_pair_internal(size_t from, size_t to);
+    SharedREFNodes nodes_;
+    std::vector<LinkIndex> succ_;
+    std::vector<LinkIndex> pred_;
+    std::vector<LinkIndex> vn_id_;
+    std::vector<refn::REFData> data_;
 };
 
 } // namespace solution
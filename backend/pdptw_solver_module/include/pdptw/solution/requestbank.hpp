@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <utility>
 #include <vector>
 
 namespace pdptw {
@@ -31,8 +32,8 @@ public:
     bool contains(size_t pickup_id) const;
     bool contains_request(size_t request_id) const;
 
-    // Đếm số unassigned requests
-    size_t count() const;
+    // Đếm số unassigned requests (O(1), cập nhật ở mỗi lần đổi bit)
+    size_t count() const { return count_; }
 
     // Clear all (mark all as assigned)
     void clear();
@@ -50,11 +51,22 @@ public:
     // Tổng penalty = count * penalty_per_entry
     double total_penalty() const;
 
+    // Undo journal (dùng bởi Solution::begin_transaction): ghi lại các bit bị thay đổi
+    void begin_journal();
+    void commit_journal();
+    void rollback_journal();
+
 private:
     const problem::PDPTWInstance *instance_; // PDPTW instance reference
     std::vector<bool> requests_;             // Bitset cho unassigned requests
+    size_t count_ = 0;                       // Số bit đang bật trong requests_
     double penalty_per_entry_;               // Penalty per unassigned request
 
+    bool journal_active_ = false;
+    std::vector<std::pair<size_t, bool>> journal_; // (request_id, giá trị cũ), rollback theo thứ tự ngược
+
+    void set_bit(size_t request_id, bool value);
+
     // Convert giữa pickup node ID và request ID
     size_t pickup_to_request_id(size_t pickup_id) const;
     size_t request_to_pickup_id(size_t request_id) const;
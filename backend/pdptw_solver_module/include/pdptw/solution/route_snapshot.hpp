@@ -0,0 +1,36 @@
+#pragma once
+
+#include "pdptw/solution/datastructure.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace pdptw::solution {
+
+// Snapshot theo route của một Solution (giữ best solution trong LNS thay vì copy cả Solution)
+// capture() chỉ trích xuất lại các route có route_version() thay đổi kể từ lần capture trước
+// trên cùng đối tượng Solution; với đối tượng khác sẽ trích xuất lại toàn bộ.
+class RouteSnapshot {
+public:
+    RouteSnapshot() = default;
+
+    // Ghi lại itinerary của mọi route và objective của solution
+    void capture(const Solution &solution);
+
+    // Đặt solution về đúng các route đã ghi (clear() rồi set())
+    void restore_into(Solution &solution) const;
+
+    bool empty() const { return source_uid_ == 0; }
+    double objective() const { return objective_; }
+
+    // Số route đã trích xuất lại ở lần capture() gần nhất
+    size_t routes_copied() const { return routes_copied_; }
+
+private:
+    uint64_t source_uid_ = 0; // 0: chưa capture
+    std::vector<std::vector<size_t>> itineraries_; // Rỗng nếu route rỗng
+    std::vector<uint64_t> versions_;
+    double objective_ = 0.0;
+    size_t routes_copied_ = 0;
+};
+
+} // namespace pdptw::solution
@@ -3,15 +3,20 @@
 
 #include "pdptw/construction/constructor.hpp"
 #include "pdptw/lns/absence_counter.hpp"
+#include "pdptw/lns/adaptive_weights.hpp"
 #include "pdptw/lns/destroy/operator.hpp"
 #include "pdptw/lns/fleet_minimization.hpp"
 #include "pdptw/lns/repair/operator.hpp"
+#include "pdptw/problem/granular_neighborhood.hpp"
 #include "pdptw/problem/pdptw.hpp"
 #include "pdptw/solution/datastructure.hpp"
+#include "pdptw/solution/route_snapshot.hpp"
+#include <deque>
 #include <functional>
 #include <memory>
 #include <optional>
 #include <random>
+#include <utility>
 #include <vector>
 
 namespace pdptw {
@@ -39,6 +44,11 @@ public:
         Num best_obj,
         std::mt19937 &rng) = 0;
 
+    // Ngưỡng chấp nhận của lần accept() kế tiếp, gọi trước khi repair: accept() trả về
+    // false với mọi new_obj > ngưỡng. Ngưỡng luôn >= best_obj nên không bỏ lỡ best mới.
+    // SA rút trước số ngẫu nhiên mà accept() kế tiếp sẽ dùng.
+    virtual Num acceptance_bound(Num current_obj, Num best_obj, std::mt19937 &rng) = 0;
+
     // Lấy temperature/threshold hiện tại
     virtual double get_temperature() const = 0;
 };
@@ -50,12 +60,15 @@ private:
     double final_temp;
     double current_temp;
     double cooling_factor;
+    // Ngưỡng current - T*ln(u) với u đã rút trong acceptance_bound(), chờ accept() dùng
+    std::optional<Num> pending_bound;
 
 public:
     SimulatedAnnealing(double initial_temperature, double final_temperature, int max_iterations);
 
     void update(int iteration, int max_iterations) override;
     bool accept(Num new_obj, Num current_obj, Num best_obj, std::mt19937 &rng) override;
+    Num acceptance_bound(Num current_obj, Num best_obj, std::mt19937 &rng) override;
     double get_temperature() const override { return current_temp; }
 };
 
@@ -72,6 +85,7 @@ public:
 
     void update(int iteration, int max_iterations) override;
     bool accept(Num new_obj, Num current_obj, Num best_obj, std::mt19937 &rng) override;
+    Num acceptance_bound(Num current_obj, Num best_obj, std::mt19937 &rng) override;
     double get_temperature() const override { return current_threshold; }
 };
 
@@ -80,6 +94,7 @@ class OnlyImprovements : public AcceptanceCriterion {
 public:
     void update(int iteration, int max_iterations) override {}
     bool accept(Num new_obj, Num current_obj, Num best_obj, std::mt19937 &rng) override;
+    Num acceptance_bound(Num current_obj, Num, std::mt19937 &) override { return current_obj; }
     double get_temperature() const override { return 0.0; }
 };
 
@@ -92,6 +107,7 @@ struct LNSStatistics {
     int accepted_solutions = 0;
     int improving_solutions = 0;
     int new_best_solutions = 0;
+    int aborted_repairs = 0; // Repair dừng sớm vì vượt ngưỡng chấp nhận
 
     // Thống kê per-operator
     struct OperatorStats {
@@ -99,11 +115,16 @@ struct LNSStatistics {
         int times_improved = 0;
         int times_found_new_best = 0;
         double avg_improvement = 0.0; // Cải thiện trung bình khi improved
+        double total_ms = 0.0;        // Tổng thời gian các iteration dùng operator
+        double weight = 1.0;          // Trọng số chọn (ADAPTIVE) khi kết thúc solve
     };
 
     std::vector<OperatorStats> destroy_stats;
     std::vector<OperatorStats> repair_stats;
 
+    // Pruning của tìm kiếm vị trí chèn (qua cache dùng chung của repair operators)
+    construction::InsertionStats insertion_stats;
+
     // Objective values
     Num initial_objective = 0;
     Num best_objective = 0;
@@ -112,6 +133,12 @@ struct LNSStatistics {
     // Timing
     double total_time_seconds = 0.0;
 
+    // (giây từ đầu solve, objective) tại lời giải ban đầu và mỗi lần có best mới
+    std::vector<std::pair<double, Num>> best_trace;
+
+    // Thời điểm đầu tiên best <= target (giây), âm nếu chưa đạt
+    double time_to_target(Num target) const;
+
     void print_summary() const;
 };
 
@@ -144,6 +171,36 @@ struct LNSSolverParams {
     // Random seed
     unsigned int seed = 42;
 
+    // Speculative: mỗi iteration sinh song song K ứng viên destroy/repair từ current (mỗi ứng
+    // viên một lời giải scratch, rng và bộ repair riêng), acceptance xét ứng viên tốt nhất
+    // (hoà thì ứng viên chỉ số nhỏ hơn). 1 = destroy/repair tuần tự trên current.
+    size_t speculative_candidates = 1;
+
+    // Deterministic: mỗi destroy/repair operator có luồng rng riêng suy ra từ seed (rng của một
+    // operator không phụ thuộc các operator khác đã rút bao nhiêu số) và trọng số ADAPTIVE
+    // tính theo lần dùng thay vì thời gian đo. Cùng seed + cùng tham số cho cùng quỹ đạo tìm
+    // kiếm khi lần chạy giới hạn theo iteration (time limit vẫn dừng ở điểm phụ thuộc tải máy).
+    bool deterministic = false;
+
+    // Granular insertion: số láng giềng mỗi node khi tìm vị trí chèn (0 = xét mọi vị trí)
+    size_t granular_k = 0;
+
+    // Xác suất bỏ qua mỗi vị trí chèn của BlinkInsertionOperator
+    double blink_rate = 0.05;
+
+    // Dừng repair sớm khi cận dưới objective đã vượt ngưỡng chấp nhận của acceptance criterion.
+    // Cận dưới chỉ đúng khi ma trận thoả bất đẳng thức tam giác; ma trận đường bộ (EDGES của
+    // Sartori-Buriol) không đảm bảo điều đó nên mặc định tắt
+    bool repair_cutoff = false;
+
+    // Chọn cặp destroy/repair: xoay vòng (mặc định), hoặc roulette theo trọng số thích nghi
+    enum class OperatorSelection {
+        ROUND_ROBIN,
+        ADAPTIVE
+    };
+    OperatorSelection operator_selection = OperatorSelection::ROUND_ROBIN;
+    lns::AdaptiveWeightsParams adaptive_weights;
+
     // Logging
     bool verbose = true;
     int log_frequency = 100; // Log mỗi N iterations
@@ -161,7 +218,7 @@ private:
 
     // Operators
     std::vector<std::unique_ptr<lns::DestroyOperator>> destroy_operators;
-    // Standard repair operators: Greedy, Regret
+    // Standard repair operators: Greedy, Regret, Blink
     std::vector<std::unique_ptr<lns::repair::RepairOperator>> repair_operators;
     // Absence-aware repair operators: HardestFirst, AbsenceRegret
     std::vector<std::unique_ptr<lns::repair::AbsenceAwareRepairOperator>> absence_repair_operators;
@@ -169,33 +226,106 @@ private:
     // Absence counter: đếm số lần requests vắng mặt
     lns::AbsenceCounter absence_counter;
 
+    // Cache vị trí chèn dùng chung của mọi repair operator
+    std::shared_ptr<construction::InsertionCache> insertion_cache;
+
     // Current operator indices (cho rotation)
     size_t current_destroy_idx = 0;
     size_t current_repair_idx = 0;
 
+    // Trọng số chọn operator (OperatorSelection::ADAPTIVE); repair gồm standard + absence-aware
+    lns::AdaptiveOperatorWeights destroy_weights;
+    lns::AdaptiveOperatorWeights repair_weights;
+
+    // Luồng rng theo operator (LNSSolverParams::deterministic)
+    struct OperatorStreams {
+        std::vector<std::mt19937> destroy;
+        std::vector<std::mt19937> repair;
+    };
+    OperatorStreams operator_streams;
+    OperatorStreams make_operator_streams(unsigned lane) const;
+
+    // Lane của chế độ speculative: lời giải scratch (bằng current khi bắt đầu iteration),
+    // rng và bộ repair operator + cache riêng; destroy operator không trạng thái nên dùng chung
+    struct SpeculativeLane {
+        Solution scratch;
+        bool stale = true; // scratch cần copy lại toàn bộ từ current (lúc bắt đầu, sau restart)
+        std::mt19937 rng;
+        OperatorStreams streams;
+        std::vector<std::unique_ptr<lns::repair::RepairOperator>> repair_operators;
+        std::vector<std::unique_ptr<lns::repair::AbsenceAwareRepairOperator>> absence_repair_operators;
+        std::shared_ptr<construction::InsertionCache> insertion_cache;
+
+        // Kết quả của iteration hiện tại
+        size_t destroy_idx = 0;
+        size_t repair_idx = 0;
+        bool failed = false;
+        bool aborted = false;
+        Num objective = 0;
+        double elapsed_ms = 0.0;
+
+        SpeculativeLane(const PDPTWInstance &inst, unsigned seed) : scratch(inst), rng(seed) {}
+    };
+    std::deque<SpeculativeLane> speculative_lanes; // deque: lane không cần di chuyển được
+
     // Acceptance criterion
     std::unique_ptr<AcceptanceCriterion> acceptance_criterion;
 
     // Statistics
     LNSStatistics stats;
 
-    // Solutions
+    // Đồng bộ với solver khác (ParallelLNSSolver); rỗng = chạy độc lập
+    int sync_interval = 0;
+    std::function<const Solution *(int, const Solution &)> sync_callback;
+    std::function<void(Num)> new_best_callback;
+
+    // Solutions: destroy/repair chạy trực tiếp trên current_solution (undo journal),
+    // best chỉ lưu dạng snapshot theo route và được dựng lại khi kết thúc solve()
     Solution best_solution;
     Solution current_solution;
+    solution::RouteSnapshot best_snapshot;
 
     // Helper methods
     void initialize_operators();
     void initialize_acceptance_criterion();
     int compute_destroy_size(int iteration) const;
+    void create_repair_operators(
+        std::vector<std::unique_ptr<lns::repair::RepairOperator>> &standard,
+        std::vector<std::unique_ptr<lns::repair::AbsenceAwareRepairOperator>> &absence_aware,
+        std::shared_ptr<construction::InsertionCache> &cache,
+        const std::shared_ptr<const problem::GranularNeighborhood> &granular) const;
+    // Chạy repair thứ repair_idx (standard trước, absence-aware sau); trả về true nếu dừng sớm
+    bool apply_repair(
+        size_t repair_idx,
+        std::vector<std::unique_ptr<lns::repair::RepairOperator>> &standard,
+        std::vector<std::unique_ptr<lns::repair::AbsenceAwareRepairOperator>> &absence_aware,
+        Solution &solution,
+        std::optional<double> cutoff,
+        std::mt19937 &lane_rng);
+    // Sinh các ứng viên speculative song song; trả về lane được xét acceptance (nullopt nếu
+    // mọi lane lỗi). Mọi lane còn transaction mở cho tới finish_speculative().
+    std::optional<size_t> run_speculative_candidates(int destroy_size, std::optional<double> cutoff);
+    void run_speculative_lane(SpeculativeLane &lane, int destroy_size, std::optional<double> cutoff);
+    // Commit lane được chấp nhận, rollback các lane còn lại rồi chép các route lane thắng
+    // đã đổi vào current và các lane khác
+    void finish_speculative(std::optional<size_t> accepted_lane);
     void rotate_operators();
     bool should_accept(Num new_obj, Num current_obj) const;
     void update_statistics(
         int iteration,
-        const Solution &new_solution,
+        Num new_obj,
         bool accepted,
         bool improved,
         bool new_best);
-    void log_iteration(int iteration, const Solution &new_solution, bool accepted) const;
+    // Thống kê và trọng số của một cặp destroy/repair đã dùng
+    void record_operator_use(
+        size_t destroy_idx,
+        size_t repair_idx,
+        double improvement,
+        bool new_best,
+        double elapsed_ms);
+    void log_iteration(int iteration, Num new_obj, bool accepted) const;
+    bool synchronize(int iteration);
 
 public:
     LNSSolver(const PDPTWInstance &inst, const LNSSolverParams &params = LNSSolverParams());
@@ -205,6 +335,14 @@ public:
 
     // Lấy statistics từ lần solve cuối
     const LNSStatistics &get_statistics() const { return stats; }
+
+    // Mỗi interval iteration gọi callback(iteration, best hiện tại); callback trả về lời giải
+    // để current khởi động lại từ đó, hoặc nullptr để chạy tiếp
+    using SyncCallback = std::function<const Solution *(int iteration, const Solution &best)>;
+    void set_sync(int interval, SyncCallback callback);
+
+    // Gọi mỗi khi tìm được best mới (objective của best mới)
+    void set_new_best_callback(std::function<void(Num)> callback) { new_best_callback = std::move(callback); }
 };
 
 } // namespace pdptw
@@ -0,0 +1,93 @@
+#ifndef PDPTW_PARALLEL_LNS_SOLVER_HPP
+#define PDPTW_PARALLEL_LNS_SOLVER_HPP
+
+#include "pdptw/solver/lns_solver.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace pdptw {
+
+// ============================================================================
+// Parallel LNS Solver Parameters
+// ============================================================================
+
+struct ParallelLNSSolverParams {
+    // Tham số gốc; worker i dùng seed + i và acceptance đa dạng hoá theo i (xem worker_params)
+    LNSSolverParams base;
+
+    size_t num_threads = 2;
+
+    // Mỗi sync_interval iteration các worker gặp nhau; worker kém hơn best chung khởi động
+    // lại từ best chung (0 = chạy độc lập tới khi kết thúc)
+    int sync_interval = 500;
+
+    // Xen kẽ SA/RTR giữa các worker (dùng temperature mặc định của CLI cho kiểu còn lại)
+    bool mix_acceptance = true;
+};
+
+// ============================================================================
+// Parallel LNS Solver: N LNSSolver độc lập trên cùng instance (chỉ đọc)
+// ============================================================================
+//
+// Mỗi worker chạy trên std::thread riêng (không dùng ThreadPool::global() vì worker chờ nhau
+// ở điểm đồng bộ; parallel_for lồng bên trong tự chạy tuần tự khi pool đang bận).
+// Objective tốt nhất toàn cục là std::atomic cập nhật bằng CAS, worker chỉ khoá khi đồng bộ.
+// Kết quả tái lập được với cùng seed và num_threads khi lần chạy bị giới hạn theo iteration:
+// quyết định ở điểm đồng bộ chỉ phụ thuộc best của từng worker (hoà thì worker chỉ số nhỏ
+// thắng), không phụ thuộc thứ tự các thread tới. Có time limit thì không còn đảm bảo này.
+class ParallelLNSSolver {
+public:
+    ParallelLNSSolver(const PDPTWInstance &inst, const ParallelLNSSolverParams &params = ParallelLNSSolverParams());
+
+    Solution solve(const Solution &initial_solution);
+
+    // Objective tốt nhất toàn cục hiện tại (đọc được từ thread khác trong lúc solve)
+    Num best_objective() const { return global_best_objective_.load(std::memory_order_relaxed); }
+
+    // Thống kê của worker cho kết quả cuối, và của từng worker
+    const LNSStatistics &get_statistics() const { return worker_stats_[best_worker_]; }
+    const std::vector<LNSStatistics> &worker_statistics() const { return worker_stats_; }
+    size_t best_worker() const { return best_worker_; }
+
+    // Số lần worker khởi động lại từ best chung
+    size_t restarts() const { return restarts_; }
+
+    // Tham số của worker i
+    static LNSSolverParams worker_params(const ParallelLNSSolverParams &params, size_t worker);
+
+private:
+    // Điểm đồng bộ: trả về best chung nếu worker phải khởi động lại, ngược lại nullptr
+    const Solution *synchronize(size_t worker, const Solution &best);
+    // Worker kết thúc với kết quả cuối, không còn tham gia đồng bộ
+    void depart(size_t worker, Solution result);
+    // Gọi khi đang giữ sync_mutex_: nếu mọi worker còn chạy đã tới thì chọn best chung
+    void try_complete_round();
+    void publish_objective(Num objective);
+
+    const PDPTWInstance &instance_;
+    ParallelLNSSolverParams params_;
+
+    std::atomic<Num> global_best_objective_;
+
+    std::mutex sync_mutex_;
+    std::condition_variable sync_cv_;
+    size_t active_workers_ = 0;
+    size_t arrived_ = 0;
+    size_t generation_ = 0;
+    // Ứng viên của vòng hiện tại: best của worker đã tới (nếu không kém best toàn cục), hoặc
+    // kết quả cuối của worker đã kết thúc (giữ qua mọi vòng sau)
+    std::vector<std::optional<Solution>> candidates_;
+    std::vector<bool> finished_;
+    std::optional<Solution> shared_best_;
+    size_t restarts_ = 0;
+
+    std::vector<LNSStatistics> worker_stats_;
+    size_t best_worker_ = 0;
+};
+
+} // namespace pdptw
+
+#endif // PDPTW_PARALLEL_LNS_SOLVER_HPP
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+namespace pdptw::utils {
+
+// Kích thước cache line dùng để căn chỉnh các buffer nóng
+inline constexpr size_t kCacheLineSize = 64;
+
+// Allocator căn chỉnh bộ nhớ theo Alignment (mặc định: một cache line)
+template <typename T, size_t Alignment = kCacheLineSize>
+class AlignedAllocator {
+public:
+    using value_type = T;
+
+    template <typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() noexcept = default;
+
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment> &) noexcept {}
+
+    T *allocate(size_t n) {
+        return static_cast<T *>(::operator new(n * sizeof(T), std::align_val_t{Alignment}));
+    }
+
+    void deallocate(T *p, size_t) noexcept {
+        ::operator delete(p, std::align_val_t{Alignment});
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Alignment> &) const noexcept { return true; }
+
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U, Alignment> &) const noexcept { return false; }
+};
+
+} // namespace pdptw::utils
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace pdptw::utils {
+
+// File ánh xạ bộ nhớ chỉ đọc (mmap trên POSIX, MapViewOfFile trên Windows)
+// Vùng nhớ được giải phóng khi đối tượng bị hủy
+class MappedFile {
+public:
+    // Ném std::runtime_error nếu không mở/ánh xạ được file
+    static std::shared_ptr<const MappedFile> open(const std::string &path);
+
+    ~MappedFile();
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    const std::byte *data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    MappedFile() = default;
+
+    const std::byte *data_ = nullptr;
+    size_t size_ = 0;
+#ifdef _WIN32
+    void *file_handle_ = nullptr;
+    void *mapping_handle_ = nullptr;
+#endif
+};
+
+} // namespace pdptw::utils
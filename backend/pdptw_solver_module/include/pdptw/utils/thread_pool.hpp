@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace pdptw::utils {
+
+// Pool worker cố định cho các vòng lặp song song ngắn (tìm vị trí chèn, regret).
+// Thread được tạo một lần; mỗi parallel_for chỉ đánh thức worker thay vì fork/join.
+class ThreadPool {
+public:
+    // body(begin, end, worker): xử lý [begin, end), worker < num_threads()
+    // Tham chiếu không sở hữu tới callable (không cấp phát như std::function): callable
+    // chỉ cần sống hết lời gọi parallel_for
+    class RangeBody {
+    public:
+        template <typename Fn, typename = std::enable_if_t<!std::is_same_v<std::decay_t<Fn>, RangeBody>>>
+        RangeBody(Fn &&fn) noexcept
+            : callable_(const_cast<void *>(static_cast<const void *>(std::addressof(fn)))),
+              invoke_([](void *callable, size_t begin, size_t end, size_t worker) {
+                  (*static_cast<std::remove_reference_t<Fn> *>(callable))(begin, end, worker);
+              }) {}
+
+        void operator()(size_t begin, size_t end, size_t worker) const { invoke_(callable_, begin, end, worker); }
+
+    private:
+        void *callable_;
+        void (*invoke_)(void *callable, size_t begin, size_t end, size_t worker);
+    };
+
+    // num_threads tính cả thread gọi parallel_for (1 → chạy tuần tự)
+    explicit ThreadPool(size_t num_threads);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    size_t num_threads() const { return workers_.size() + 1; }
+
+    // Chia [0, n) thành các khối grain phần tử, phát động theo nhu cầu. Chạy tại chỗ
+    // (worker = 0) khi n <= grain, khi gọi lồng từ trong body, hoặc khi pool đang bận
+    // với lời gọi từ thread khác. Exception đầu tiên trong body được ném lại ở đây.
+    void parallel_for(size_t n, size_t grain, RangeBody body);
+
+    // Đang chạy bên trong body của một parallel_for (lời gọi lồng sẽ chạy tuần tự)
+    static bool in_parallel_region();
+
+    // Pool dùng chung (mặc định default_threads() thread, tạo khi dùng lần đầu)
+    static ThreadPool &global();
+
+    // Tạo lại pool dùng chung; chỉ gọi khi không có parallel_for nào đang chạy
+    static void set_global_threads(size_t num_threads);
+
+    // omp_get_max_threads() nếu có OpenMP, ngược lại hardware_concurrency()
+    static size_t default_threads();
+
+private:
+    void worker_loop(size_t worker);
+    void run_chunks(size_t worker);
+
+    std::vector<std::thread> workers_;
+
+    std::mutex submit_mutex_; // Một parallel_for tại một thời điểm
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    uint64_t generation_ = 0;
+    size_t active_ = 0;
+    bool stop_ = false;
+
+    const RangeBody *body_ = nullptr;
+    size_t size_ = 0;
+    size_t grain_ = 1;
+    std::atomic<size_t> next_{0};
+    std::exception_ptr error_;
+};
+
+} // namespace pdptw::utils
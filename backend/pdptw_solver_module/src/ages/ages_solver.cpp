@@ -18,7 +18,11 @@ using pdptw::solution::PermutationOps;
 AGESSolver::AGESSolver(
     const problem::PDPTWInstance &instance,
     const AGESParameters &params)
-    : instance_(&instance), params_(params) {}
+    : instance_(&instance), params_(params) {
+    if (params_.granular_k > 0) {
+        granular_ = std::make_shared<const problem::GranularNeighborhood>(instance, params_.granular_k);
+    }
+}
 
 solution::Solution AGESSolver::run(
     solution::Solution sol,
@@ -110,7 +114,7 @@ solution::Solution AGESSolver::run(
             } else if (!sol.unassigned_requests().contains(u)) {
                 sol.unassign_request(u);
             } // Thử chèn ngẫu nhiên
-            auto insertion = PermutationOps::find_random_insert_for_request(sol, u, rng);
+            auto insertion = PermutationOps::find_random_insert_for_request(sol, u, rng, granular_.get());
 
             if (insertion.has_value()) {
                 size_t route_id = insertion.value().vn_id / 2;
@@ -23,7 +23,7 @@ bool GeneticOperators::route_crossover(const Solution &parent1, const Solution &
         size_t num_remove = std::max(static_cast<size_t>(1), static_cast<size_t>(num_routes * dist(rng_)));
 
         lns::RouteRemovalOperator destroyer;
-        destroyer.destroy(offspring, num_remove);
+        destroyer.destroy(offspring, num_remove, rng_);
         lns::repair::GreedyInsertionOperator repairer;
         repairer.repair(offspring, rng_);
 
@@ -41,7 +41,7 @@ bool GeneticOperators::order_crossover(const Solution &parent1, const Solution &
     size_t num_remove = std::max(static_cast<size_t>(1), static_cast<size_t>(instance_.num_requests() * dist(rng_)));
 
     lns::WorstRemovalOperator destroyer;
-    destroyer.destroy(offspring, num_remove);
+    destroyer.destroy(offspring, num_remove, rng_);
     lns::repair::GreedyInsertionOperator repairer;
     repairer.repair(offspring, rng_);
 
@@ -60,7 +60,7 @@ bool GeneticOperators::best_route_crossover(const Solution &parent1, const Solut
         size_t num_remove = std::max(static_cast<size_t>(1), static_cast<size_t>(num_routes * dist(rng_)));
 
         lns::RouteRemovalOperator destroyer;
-        destroyer.destroy(offspring, num_remove);
+        destroyer.destroy(offspring, num_remove, rng_);
         lns::repair::GreedyInsertionOperator repairer;
         repairer.repair(offspring, rng_);
 
@@ -77,7 +77,7 @@ size_t GeneticOperators::mutate_relocate(Solution &solution, size_t num_mutation
         num_remove = 1;
 
     lns::WorstRemovalOperator destroyer;
-    destroyer.destroy(solution, num_remove);
+    destroyer.destroy(solution, num_remove, rng_);
     lns::repair::GreedyInsertionOperator repairer;
     repairer.repair(solution, rng_);
 
@@ -96,7 +96,7 @@ size_t GeneticOperators::mutate_swap(Solution &solution, size_t num_mutations) {
         num_remove = 1;
 
     lns::RouteRemovalOperator destroyer;
-    destroyer.destroy(solution, num_remove);
+    destroyer.destroy(solution, num_remove, rng_);
     lns::repair::GreedyInsertionOperator repairer;
     repairer.repair(solution, rng_);
 
@@ -115,7 +115,7 @@ size_t GeneticOperators::mutate_shuffle(Solution &solution, size_t num_mutations
     num_remove = std::min(num_remove, num_routes);
 
     lns::RouteRemovalOperator destroyer;
-    destroyer.destroy(solution, num_remove);
+    destroyer.destroy(solution, num_remove, rng_);
     lns::repair::GreedyInsertionOperator repairer;
     repairer.repair(solution, rng_);
 
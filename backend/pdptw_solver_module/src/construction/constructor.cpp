@@ -1,6 +1,8 @@
 #include "pdptw/construction/constructor.hpp"
+#include "pdptw/construction/regret_heap.hpp"
 #include <algorithm>
 #include <limits>
+#include <numeric>
 #include <spdlog/spdlog.h>
 #include <vector>
 
@@ -30,13 +32,12 @@ Solution Constructor::sequential_construction(
     spdlog::debug("Starting sequential construction for {} requests", instance.num_requests());
 
     size_t inserted_count = 0;
+    InsertionTopK top(1);
     for (size_t req_id = 0; req_id < instance.num_requests(); ++req_id) {
-        auto candidate = Insertion::find_best_insertion(
-            solution,
-            req_id,
-            InsertionStrategy::BestCost);
+        Insertion::find_top_insertions(solution, req_id, top);
 
-        if (candidate.feasible) {
+        if (!top.empty()) {
+            const auto &candidate = top.best();
             spdlog::debug("Request {}: Inserting at vehicle {}, pickup_after={}, delivery_after={}, cost={:.2f}",
                           req_id, candidate.vehicle_id, candidate.pickup_after,
                           candidate.delivery_after, candidate.cost_increase);
@@ -58,32 +59,17 @@ Solution Constructor::regret_construction(
     size_t k) {
     Solution solution(instance);
 
-    std::vector<size_t> uninserted;
-    for (size_t req_id = 0; req_id < instance.num_requests(); ++req_id) {
-        uninserted.push_back(req_id);
-    }
+    std::vector<size_t> requests(instance.num_requests());
+    std::iota(requests.begin(), requests.end(), 0);
 
-    while (!uninserted.empty()) {
-        auto regret_candidates = Insertion::calculate_regret(solution, uninserted, k);
-
-        if (regret_candidates.empty()) {
-            break;
+    RegretHeap heap(k);
+    heap.reset(solution, requests);
+    while (!heap.empty()) {
+        if (heap.top().feasible) {
+            heap.insert_top(solution);
+        } else {
+            heap.pop(); // Không còn vị trí khả thi: để lại trong bank
         }
-
-        std::sort(regret_candidates.begin(), regret_candidates.end(),
-                  [](const InsertionCandidate &a, const InsertionCandidate &b) {
-                      if (a.regret_value != b.regret_value) {
-                          return a.regret_value > b.regret_value;
-                      }
-                      return a.cost_increase < b.cost_increase;
-                  });
-
-        const auto &best = regret_candidates[0];
-        Insertion::insert_request(solution, best);
-
-        uninserted.erase(
-            std::remove(uninserted.begin(), uninserted.end(), best.request_id),
-            uninserted.end());
     }
 
     return solution;
@@ -114,44 +100,15 @@ void Constructor::build_route_for_vehicle(
     size_t vehicle_id,
     const std::vector<size_t> &requests) {
     
+    InsertionTopK top(1);
     for (size_t req_id : requests) {
         // Tìm vị trí chèn tốt nhất CHỈ trong vehicle_id được chỉ định
         // Không dùng Insertion::find_best_insertion vì nó tìm trên toàn bộ các xe
-        
-        InsertionCandidate best_candidate; // Default: cost = infinity, feasible = false
-
-        size_t depot_start = vehicle_id * 2;
-        size_t depot_end = vehicle_id * 2 + 1;
-
-        // Duyệt qua tất cả vị trí pickup có thể
-        size_t pickup_after = depot_start;
-        const size_t MAX_ITER = 1000; // Safety break
-        size_t pickup_iter = 0;
-
-        while (pickup_after != depot_end && pickup_iter++ < MAX_ITER) {
-            // Duyệt qua tất cả vị trí delivery có thể (phải sau pickup)
-            size_t delivery_after = pickup_after;
-            size_t delivery_iter = 0;
-
-            while (delivery_after != depot_end && delivery_iter++ < MAX_ITER) {
-                // Kiểm tra tính khả thi
-                if (Insertion::is_feasible_insertion(solution, req_id, vehicle_id, pickup_after, delivery_after)) {
-                    Num cost = Insertion::calculate_insertion_cost(solution, req_id, vehicle_id, pickup_after, delivery_after);
-                    
-                    if (cost < best_candidate.cost_increase) {
-                        best_candidate = InsertionCandidate(
-                            req_id, vehicle_id, pickup_after, delivery_after, cost, true);
-                    }
-                }
-
-                delivery_after = solution.succ(delivery_after);
-            }
-
-            pickup_after = solution.succ(pickup_after);
-        }
+        top.clear();
+        Insertion::find_insertions_in_route(solution, req_id, vehicle_id, top);
 
-        if (best_candidate.feasible) {
-            Insertion::insert_request(solution, best_candidate);
+        if (!top.empty()) {
+            Insertion::insert_request(solution, top.best());
         } else {
             spdlog::warn("BinPacking: Failed to insert request {} into assigned vehicle {}", req_id, vehicle_id);
         }
@@ -1,15 +1,121 @@
 #include "pdptw/construction/insertion.hpp"
+#include "pdptw/refn/ref_batch.hpp"
+#include "pdptw/utils/thread_pool.hpp"
 #include <algorithm>
+#include <atomic>
 #include <cmath>
-#include <iostream>
 #include <spdlog/spdlog.h>
 
-#ifdef USE_OPENMP
-#include <omp.h>
-#endif
-
 namespace pdptw::construction {
 
+namespace {
+
+std::atomic<EvaluationBackend> evaluation_backend_{EvaluationBackend::Scalar};
+std::atomic<size_t> parallel_cutoff_{4096};
+std::atomic<bool> specialized_evaluation_{true};
+
+// Biến thể đánh giá của scan_route, chọn theo InstanceTraits và route đang xét:
+//  - Generic: REFData đầy đủ + calculate_insertion_cost (và đường batch)
+//  - còn lại: segment chỉ giữ earliest_completion (cùng tải nếu CheckCapacity), chi phí
+//    tính từ các cung đã đọc. Symmetric đọc cung vào pickup/delivery theo hàng của chính
+//    node đó (mọi lần đọc của một request nằm trên hai hàng), TimeIsDistance đọc một giá
+//    trị cho mỗi cung. Precision của ma trận cũng được chọn trước nên mỗi lần đọc cung
+//    không phải rẽ nhánh theo kiểu lưu trữ.
+template <bool Generic, bool CheckCapacity, bool Symmetric, bool TimeIsDistance,
+          problem::MatrixPrecision Precision = problem::MatrixPrecision::Float64>
+struct EvaluatorVariant {
+    static constexpr bool kGeneric = Generic;
+    static constexpr bool kCheckCapacity = CheckCapacity;
+    static constexpr bool kSymmetric = Symmetric;
+    static constexpr bool kTimeIsDistance = TimeIsDistance;
+    static constexpr problem::MatrixPrecision kPrecision = Precision;
+};
+using GenericEvaluator = EvaluatorVariant<true, true, false, false>;
+
+template <typename Variant>
+inline problem::DistanceAndTime arc_of(const PDPTWInstance &instance, size_t from, size_t to) {
+    if constexpr (Variant::kGeneric) {
+        return instance.distance_and_time(from, to);
+    } else if constexpr (Variant::kTimeIsDistance) {
+        Num distance = instance.distance_and_time_as<Variant::kPrecision>(from, to).distance;
+        return problem::DistanceAndTime{distance, distance};
+    } else {
+        return instance.distance_and_time_as<Variant::kPrecision>(from, to);
+    }
+}
+
+template <typename Variant>
+inline Num distance_of(const PDPTWInstance &instance, size_t from, size_t to) {
+    if constexpr (Variant::kGeneric) {
+        return instance.distance(from, to);
+    } else {
+        return instance.distance_and_time_as<Variant::kPrecision>(from, to).distance;
+    }
+}
+
+// Cung vào node cố định to (pickup/delivery của request đang chèn)
+template <typename Variant>
+inline problem::DistanceAndTime arc_into(const PDPTWInstance &instance, size_t from, size_t to) {
+    if constexpr (Variant::kSymmetric) {
+        return arc_of<Variant>(instance, to, from);
+    } else {
+        return arc_of<Variant>(instance, from, to);
+    }
+}
+
+template <bool CheckCapacity, typename Fn>
+size_t with_matrix_variant(const PDPTWInstance &instance, Fn &&fn) {
+    const auto &traits = instance.traits();
+    return problem::with_matrix_precision(instance.travel_matrix().storage().precision, [&](auto precision) {
+        constexpr problem::MatrixPrecision P = decltype(precision)::value;
+        if (traits.symmetric) {
+            return traits.time_equals_distance ? fn(EvaluatorVariant<false, CheckCapacity, true, true, P>{})
+                                               : fn(EvaluatorVariant<false, CheckCapacity, true, false, P>{});
+        }
+        return traits.time_equals_distance ? fn(EvaluatorVariant<false, CheckCapacity, false, true, P>{})
+                                           : fn(EvaluatorVariant<false, CheckCapacity, false, false, P>{});
+    });
+}
+
+// Ước lượng số cặp vị trí cần đánh giá trên các route không rỗng
+size_t estimate_pairs(const solution::Solution &solution) {
+    const auto &instance = solution.instance();
+    size_t pairs = 0;
+    for (size_t v = 0; v < instance.num_vehicles(); ++v) {
+        if (!solution.is_route_empty(v)) {
+            size_t m = solution.position(instance.vn_id_of(v) + 1);
+            pairs += m * (m + 1) / 2;
+        }
+    }
+    return pairs;
+}
+
+} // namespace
+
+void Insertion::set_parallel_cutoff(size_t pairs) {
+    parallel_cutoff_.store(pairs, std::memory_order_relaxed);
+}
+
+size_t Insertion::parallel_cutoff() {
+    return parallel_cutoff_.load(std::memory_order_relaxed);
+}
+
+void Insertion::set_evaluation_backend(EvaluationBackend backend) {
+    evaluation_backend_.store(backend, std::memory_order_relaxed);
+}
+
+EvaluationBackend Insertion::evaluation_backend() {
+    return evaluation_backend_.load(std::memory_order_relaxed);
+}
+
+void Insertion::set_specialized_evaluation(bool enabled) {
+    specialized_evaluation_.store(enabled, std::memory_order_relaxed);
+}
+
+bool Insertion::specialized_evaluation() {
+    return specialized_evaluation_.load(std::memory_order_relaxed);
+}
+
 size_t Insertion::get_pickup_vn(const PDPTWInstance &instance, size_t request_id) {
     return instance.num_vehicles() * 2 + request_id * 2;
 }
@@ -21,25 +127,13 @@ size_t Insertion::get_delivery_vn(const PDPTWInstance &instance, size_t request_
 InsertionCandidate Insertion::find_best_insertion(
     const solution::Solution &solution,
     size_t request_id,
-    InsertionStrategy strategy) {
-    auto candidates = find_all_insertions(solution, request_id);
-
-    if (candidates.empty()) {
-        return InsertionCandidate();
-    }
-
-    switch (strategy) {
-    case InsertionStrategy::BestCost:
-    case InsertionStrategy::Sequential:
-        return *std::min_element(candidates.begin(), candidates.end());
-
-    case InsertionStrategy::Regret2:
-    case InsertionStrategy::Regret3: {
-        return *std::min_element(candidates.begin(), candidates.end());
-    }
-    }
-
-    return InsertionCandidate();
+    [[maybe_unused]] InsertionStrategy strategy, // Mọi chiến lược đều chọn vị trí rẻ nhất cho một request
+    InsertionStats *stats,
+    const GranularNeighborhood *granular) {
+    thread_local InsertionTopK top;
+    top.reset(1);
+    find_top_insertions(solution, request_id, top, estimate_pairs(solution), stats, granular);
+    return top.empty() ? InsertionCandidate() : top.best();
 }
 
 Num Insertion::calculate_insertion_cost(
@@ -74,8 +168,8 @@ Num Insertion::calculate_insertion_cost(
         old_cost += instance.distance(delivery_after_node, delivery_before_node);
         new_cost += instance.distance(delivery_after_node, delivery_node);
         new_cost += instance.distance(delivery_node, delivery_before_node);
-    } else if (delivery_after == pickup_vn) {
-        // Delivery right after pickup - no edge to remove
+    } else {
+        // Delivery right after pickup (pickup_after -> pickup -> delivery -> pickup_before)
         new_cost += instance.distance(pickup_node, delivery_node);
         new_cost += instance.distance(delivery_node, pickup_before_node);
         // Subtract the edge we already added (pickup -> pickup_before)
@@ -110,8 +204,8 @@ bool Insertion::is_feasible_insertion(
     //      → Both at same position, pickup inserted first, then delivery
     //   2. delivery_after == pickup_vn
     //      → Delivery right after the newly inserted pickup
-    //   3. delivery_after is reachable from pickup_after in the current route
-    //      → Delivery will be after pickup in final route
+    //   3. delivery_after comes after pickup_after in the current route
+    //      → Delivery will be after pickup in final route (O(1) via route positions)
 
     bool pickup_before_delivery = false;
 
@@ -123,25 +217,10 @@ bool Insertion::is_feasible_insertion(
         // This case handled during actual insertion
         pickup_before_delivery = true;
     } else {
-        // Case 3: Walk from pickup_after to see if we can reach delivery_after
-        size_t current = pickup_after;
-        int max_steps = 300; // Safety limit to avoid infinite loop
-        int steps = 0;
-
-        while (current != 0 && steps < max_steps) {
-            if (current == delivery_after) {
-                pickup_before_delivery = true;
-                break;
-            }
-            current = solution.succ(current);
-            steps++;
-
-            // Check if we've reached end of route (depot_end)
-            size_t depot_end = vehicle_id * 2 + 1;
-            if (current == depot_end) {
-                break;
-            }
-        }
+        // Case 3: So sánh vị trí trong route (không thể chèn sau depot_end)
+        size_t depot_end = vehicle_id * 2 + 1;
+        pickup_before_delivery = delivery_after != depot_end &&
+                                 solution.is_before(pickup_after, delivery_after);
     }
 
     if (!pickup_before_delivery) {
@@ -296,28 +375,22 @@ void Insertion::insert_request(
 
     // Validate route segment
     solution.validate_between(validate_start, validate_end);
-    // Double-check precedence
-    bool found_delivery = false;
-    size_t current = pickup_id;
-    size_t safety = 0;
-    const size_t MAX_WALK = static_cast<size_t>(instance.num_requests() * 2 + 10);
-
-    std::vector<size_t> walk_path; // For debugging
-
-    while (safety++ < MAX_WALK) {
-        walk_path.push_back(current);
-        if (current == delivery_id) {
-            found_delivery = true;
-            break;
-        }
-        size_t next = solution.succ(current);
-        if (next == vn_id + 1 || next == current) { // Reached depot end or cycle
-            break;
+    // Double-check precedence (O(1) qua vị trí vừa được đánh lại khi validate)
+    if (!solution.is_before(pickup_id, delivery_id)) {
+        // Chỉ duyệt route để ghi log khi có lỗi
+        std::vector<size_t> walk_path;
+        size_t current = pickup_id;
+        size_t safety = 0;
+        const size_t MAX_WALK = static_cast<size_t>(instance.num_requests() * 2 + 10);
+        while (safety++ < MAX_WALK) {
+            walk_path.push_back(current);
+            size_t next = solution.succ(current);
+            if (current == delivery_id || next == vn_id + 1 || next == current) { // Reached delivery, depot end or cycle
+                break;
+            }
+            current = next;
         }
-        current = next;
-    }
 
-    if (!found_delivery) {
         spdlog::error("PRECEDENCE VIOLATION after insert_request!");
         spdlog::error("  Request {}: pickup={}, delivery={}", candidate.request_id, pickup_id, delivery_id);
         spdlog::error("  Insertion: pickup_after={}, delivery_after={}", candidate.pickup_after, candidate.delivery_after);
@@ -337,206 +410,443 @@ void Insertion::insert_request(
 std::vector<InsertionCandidate> Insertion::calculate_regret(
     const solution::Solution &solution,
     const std::vector<size_t> &unassigned_requests,
-    size_t k) {
-    std::vector<InsertionCandidate> regret_candidates;
-
-    for (size_t request_id : unassigned_requests) {
-        // Find all feasible insertions for this request
-        auto candidates = find_all_insertions(solution, request_id);
-
-        if (candidates.empty()) {
-            // No feasible insertion - create infeasible candidate with high regret
-            InsertionCandidate inf_candidate;
-            inf_candidate.request_id = request_id;
-            inf_candidate.regret_value = std::numeric_limits<Num>::infinity();
-            regret_candidates.push_back(inf_candidate);
-            continue;
+    size_t k,
+    InsertionStats *stats,
+    const GranularNeighborhood *granular) {
+    std::vector<InsertionCandidate> regret_candidates(unassigned_requests.size());
+
+    auto &pool = utils::ThreadPool::global();
+    const size_t route_pairs = estimate_pairs(solution);
+    // Bộ đệm thread_local của thread gọi; lambda chạy trên worker khác nên phải dùng qua tham chiếu
+    thread_local std::vector<InsertionStats> worker_stats_buffer;
+    auto &worker_stats = worker_stats_buffer;
+    worker_stats.assign(pool.num_threads(), InsertionStats());
+
+    auto evaluate = [&](size_t begin, size_t end, size_t worker) {
+        InsertionTopK top(k);
+        for (size_t i = begin; i < end; ++i) {
+            size_t request_id = unassigned_requests[i];
+            find_top_insertions(solution, request_id, top, route_pairs, &worker_stats[worker], granular);
+
+            if (top.empty()) {
+                // No feasible insertion - create infeasible candidate with high regret
+                InsertionCandidate inf_candidate;
+                inf_candidate.request_id = request_id;
+                inf_candidate.regret_value = std::numeric_limits<Num>::infinity();
+                regret_candidates[i] = inf_candidate;
+                continue;
+            }
+
+            InsertionCandidate best = top.best();
+            best.regret_value = top.regret();
+            regret_candidates[i] = best;
         }
+    };
 
-        // Sort by cost
-        std::sort(candidates.begin(), candidates.end());
+    // Song song theo request (mỗi request tự tìm tuần tự trên các route) khi đủ việc
+    if (unassigned_requests.size() > 1 && unassigned_requests.size() * route_pairs >= parallel_cutoff()) {
+        pool.parallel_for(unassigned_requests.size(), 1, evaluate);
+    } else {
+        evaluate(0, unassigned_requests.size(), 0);
+    }
 
-        // Calculate regret: difference between best and k-th best
-        Num regret = 0.0;
-        if (candidates.size() >= k) {
-            regret = candidates[k - 1].cost_increase - candidates[0].cost_increase;
-        } else if (candidates.size() > 1) {
-            // Less than k candidates - use last available
-            regret = candidates.back().cost_increase - candidates[0].cost_increase;
-        } else {
-            // Only one candidate - regret is 0 (no alternative)
-            regret = 0.0;
+    if (stats) {
+        for (const auto &ws : worker_stats) {
+            *stats += ws;
         }
+    }
+    return regret_candidates;
+}
 
-        // Take best candidate and set its regret value
-        InsertionCandidate best = candidates[0];
-        best.regret_value = regret;
-        regret_candidates.push_back(best);
+template <typename Emit>
+size_t Insertion::scan_route(
+    const solution::Solution &solution,
+    size_t request_id,
+    size_t vehicle_id,
+    InsertionStats *stats,
+    const GranularNeighborhood *granular,
+    Emit &&emit) {
+    const auto &instance = solution.instance();
+    const auto &traits = instance.traits();
+    auto scan = [&](auto variant) {
+        return scan_route_variant<decltype(variant)>(solution, request_id, vehicle_id, stats, granular, emit);
+    };
+    if (evaluation_backend() != EvaluationBackend::Scalar || !specialized_evaluation()) {
+        return scan(GenericEvaluator{});
     }
 
-    return regret_candidates;
+    // Tải lớn nhất của route cộng demand của request vẫn vừa xe: route này không cần
+    // kiểm tra capacity (luôn đúng khi capacity_unbounded)
+    const size_t depot_end = instance.vn_id_of(vehicle_id) + 1;
+    const bool capacity_free =
+        traits.capacity_unbounded ||
+        solution.fw_data().data(depot_end).max_load + instance.nodes()[get_pickup_vn(instance, request_id)].demand() <=
+            instance.vehicles()[vehicle_id].seats();
+    if (capacity_free) {
+        return with_matrix_variant<false>(instance, scan);
+    }
+    if (traits.symmetric || traits.time_equals_distance) {
+        return with_matrix_variant<true>(instance, scan);
+    }
+    return scan(GenericEvaluator{});
 }
 
-std::vector<InsertionCandidate> Insertion::find_all_insertions(
+template <typename Variant, typename Emit>
+size_t Insertion::scan_route_variant(
     const solution::Solution &solution,
-    size_t request_id) {
-    std::vector<InsertionCandidate> candidates;
+    size_t request_id,
+    size_t vehicle_id,
+    InsertionStats *stats,
+    const GranularNeighborhood *granular,
+    Emit &emit) {
     const auto &instance = solution.instance();
+    const auto &fw_data = solution.fw_data();
+    const auto &bw_data = solution.bw_data();
+    const auto &vehicle = instance.vehicles()[vehicle_id];
 
-    size_t total_checks = 0;
-    size_t feasible_checks = 0;
+    const size_t pickup_vn = get_pickup_vn(instance, request_id);
+    const size_t delivery_vn = get_delivery_vn(instance, request_id);
+    const size_t depot_start = vehicle_id * 2;
+    const size_t depot_end = depot_start + 1;
+
+    const auto &ref_pickup = fw_data.node(pickup_vn);
+    const auto &ref_delivery = fw_data.node(delivery_vn);
+    const Num pickup_due = instance.nodes()[pickup_vn].due();
+    const Num delivery_due = instance.nodes()[delivery_vn].due();
+
+    // Số cặp có pickup_after ở vị trí >= pos (delivery_after chạy từ pickup_after tới trước depot_end)
+    const size_t end_position = solution.position(depot_end);
+    auto pairs_from = [end_position](size_t pos) {
+        size_t m = end_position - pos;
+        return m * (m + 1) / 2;
+    };
+
+    InsertionStats local_stats;
+    auto flush_stats = [&]() {
+        if (stats) {
+            *stats += local_stats;
+        }
+    };
+
+    // Loại cả route: request không vừa xe (tải ở depot luôn bằng 0 nên capacity slack
+    // của route chính là seats), hoặc route bắt đầu sau khi time window pickup đã đóng
+    bool pruned = std::abs(instance.nodes()[pickup_vn].demand()) > vehicle.seats() ||
+                  fw_data.data(depot_start).earliest_completion > pickup_due;
+
+    // Granular: pickup chỉ được đặt kề láng giềng, route không chứa láng giềng nào thì bỏ
+    if (!pruned && granular && fw_data.succ(depot_start) != depot_end) {
+        const auto &neighbors = granular->neighbors(pickup_vn);
+        pruned = std::none_of(neighbors.begin(), neighbors.end(), [&](size_t n) {
+            return fw_data.succ(n) != n && fw_data.vn_id(n) == depot_start;
+        });
+    }
+
+    if (pruned) {
+        ++local_stats.routes_pruned;
+        local_stats.positions_pruned += pairs_from(0);
+        flush_stats();
+        return 0;
+    }
+    ++local_stats.routes_scanned;
 
-    // Calculate max iterations based on instance size to prevent infinite loops
-    // Max nodes in a route = 2 (depots) + num_requests * 2 (pickup+delivery pairs)
-    // Add buffer of 10 for safety
     const size_t MAX_NODES_IN_ROUTE = instance.num_requests() * 2 + 12;
+    size_t checked = 0;
+    size_t pickup_iterations = 0;
+
+    // Batch: gom mọi cặp vị trí của route rồi đánh giá một lượt (cùng thứ tự với Scalar)
+    const EvaluationBackend backend = evaluation_backend();
+    const bool batched = Variant::kGeneric && backend != EvaluationBackend::Scalar;
+    // Đường batch và các biến thể chuyên biệt dùng chi phí tính sẵn theo pickup_after
+    const bool precomputed_costs = batched || !Variant::kGeneric;
+    thread_local refn::DeliveryBatch batch;
+    thread_local std::vector<std::pair<size_t, size_t>> batch_positions;
+    if (batched) {
+        batch.reset(ref_delivery, vehicle.seats());
+        batch_positions.clear();
+    }
 
-#ifdef USE_OPENMP
-    // Parallel version: each thread collects candidates independently
-    std::vector<std::vector<InsertionCandidate>> thread_candidates;
-    std::vector<size_t> thread_total_checks;
-    std::vector<size_t> thread_feasible_checks;
-
-    // OpenMP requires signed integral type for loop variable
-    int num_vehicles = static_cast<int>(instance.num_vehicles());
-
-#pragma omp parallel
-    {
-        std::vector<InsertionCandidate> local_candidates;
-        size_t local_total_checks = 0;
-        size_t local_feasible_checks = 0;
-
-#pragma omp for schedule(dynamic) nowait
-        for (int v_int = 0; v_int < num_vehicles; ++v_int) {
-            size_t v = static_cast<size_t>(v_int);
-            size_t depot_start = v * 2;
-            size_t depot_end = v * 2 + 1;
-
-            // Try all positions for pickup
-            size_t pickup_after = depot_start;
-            size_t pickup_iterations = 0;
-
-            while (pickup_after != depot_end && pickup_iterations < MAX_NODES_IN_ROUTE) {
-                pickup_iterations++;
-
-                // Try all positions for delivery (must be after pickup)
-                size_t delivery_after = pickup_after;
-                size_t delivery_iterations = 0;
-
-                while (delivery_after != depot_end && delivery_iterations < MAX_NODES_IN_ROUTE) {
-                    delivery_iterations++;
-                    local_total_checks++;
-
-                    // Check feasibility
-                    if (is_feasible_insertion(solution, request_id, v,
-                                              pickup_after, delivery_after)) {
-                        local_feasible_checks++;
-
-                        // Calculate cost
-                        Num cost = calculate_insertion_cost(solution, request_id, v,
-                                                            pickup_after, delivery_after);
-
-                        local_candidates.emplace_back(request_id, v,
-                                                      pickup_after, delivery_after,
-                                                      cost, true);
-                    }
-
-                    // Move to next delivery position
-                    delivery_after = solution.succ(delivery_after);
-                }
+    for (size_t pickup_after = depot_start; pickup_after != depot_end;
+         pickup_after = fw_data.succ(pickup_after)) {
+        if (++pickup_iterations > MAX_NODES_IN_ROUTE) {
+            spdlog::warn("Possible cycle detected in find_insertions_in_route: vehicle {} hit max pickup iterations ({})",
+                         vehicle_id, MAX_NODES_IN_ROUTE);
+            break;
+        }
+
+        const auto &before_pickup = fw_data.data(pickup_after);
+        const size_t pickup_position = solution.position(pickup_after);
+
+        // earliest_completion không giảm dọc route: mọi pickup_after phía sau cũng trễ
+        if (before_pickup.earliest_completion > pickup_due) {
+            local_stats.positions_pruned += pairs_from(pickup_position);
+            break;
+        }
+
+        if (granular && !granular->allows_gap(pickup_vn, pickup_after, fw_data.succ(pickup_after))) {
+            local_stats.positions_pruned += end_position - pickup_position;
+            continue;
+        }
+
+        auto dist_time_to_pickup = arc_into<Variant>(instance, pickup_after, pickup_vn);
+        if (before_pickup.earliest_completion + dist_time_to_pickup.time > pickup_due) {
+            local_stats.positions_pruned += end_position - pickup_position;
+            continue;
+        }
+
+        // segment: depot_start..pickup_after, pickup, rồi các node nằm giữa pickup và delivery
+        // (biến thể chuyên biệt chỉ cập nhật các trường được dùng bên dưới)
+        refn::REFData segment;
+        if constexpr (Variant::kGeneric) {
+            before_pickup.extend_forward_into_target(ref_pickup, segment, dist_time_to_pickup);
+        } else {
+            segment.tw_feasible = before_pickup.tw_feasible;
+            segment.earliest_completion =
+                std::max(before_pickup.earliest_completion + dist_time_to_pickup.time, ref_pickup.ready) +
+                ref_pickup.servicetime;
+            if constexpr (Variant::kCheckCapacity) {
+                segment.current_load = static_cast<problem::Capacity>(before_pickup.current_load + ref_pickup.demand);
+                segment.max_load = std::max(before_pickup.max_load, segment.current_load);
+            }
+        }
+        if (Variant::kCheckCapacity && !vehicle.check_capacity(segment.current_load)) {
+            local_stats.positions_pruned += end_position - pickup_position;
+            continue;
+        }
+
+        const size_t pickup_before = fw_data.succ(pickup_after);
+        const Num pickup_removed = precomputed_costs ? distance_of<Variant>(instance, pickup_vn, pickup_before) : 0.0;
+        const Num pickup_new_cost = precomputed_costs ? dist_time_to_pickup.distance + pickup_removed : 0.0;
+        const Num pickup_old_cost = precomputed_costs ? distance_of<Variant>(instance, pickup_after, pickup_before) : 0.0;
+
+        size_t delivery_after = pickup_after;
+        size_t segment_last = pickup_vn;
+        while (true) {
+            // Segment đã hoàn thành sau due của delivery: vị trí này và mọi vị trí sau đều trễ
+            if (segment.earliest_completion > delivery_due) {
+                local_stats.positions_pruned += end_position - solution.position(delivery_after);
+                break;
+            }
 
-                if (delivery_iterations >= MAX_NODES_IN_ROUTE) {
-#pragma omp critical
-                    spdlog::warn("Possible cycle detected in find_all_insertions: vehicle {} hit max delivery iterations ({})",
-                                 v, MAX_NODES_IN_ROUTE);
+            size_t delivery_before = fw_data.succ(delivery_after);
+
+            if (granular && !granular->allows_gap(delivery_vn, segment_last, delivery_before)) {
+                ++local_stats.positions_pruned;
+            } else if constexpr (!Variant::kGeneric) {
+                ++checked;
+
+                // Như kernel của DeliveryBatch: delivery rồi nối với bw_data(delivery_before)
+                const auto in = arc_into<Variant>(instance, segment_last, delivery_vn);
+                const auto out_arc = arc_of<Variant>(instance, delivery_vn, delivery_before);
+                const auto &rest = bw_data.data(delivery_before);
+                const Num arrival = segment.earliest_completion + in.time;
+                bool feasible = segment.tw_feasible && rest.tw_feasible && arrival <= delivery_due &&
+                                std::max(arrival, ref_delivery.ready) + ref_delivery.servicetime + out_arc.time <=
+                                    rest.latest_start;
+                if constexpr (Variant::kCheckCapacity) {
+                    const auto load = static_cast<problem::Capacity>(segment.current_load + ref_delivery.demand);
+                    const auto max_load = std::max(std::max(segment.max_load, load),
+                                                   static_cast<problem::Capacity>(load + rest.max_load));
+                    feasible = feasible && vehicle.check_capacity(max_load);
                 }
 
-                // Move to next pickup position
-                pickup_after = solution.succ(pickup_after);
+                if (feasible) {
+                    // Cùng thứ tự cộng với calculate_insertion_cost
+                    const bool adjacent = delivery_after == pickup_after;
+                    Num new_cost = pickup_new_cost + in.distance + out_arc.distance - (adjacent ? pickup_removed : 0.0);
+                    Num old_cost = pickup_old_cost + (adjacent ? 0.0 : distance_of<Variant>(instance, delivery_after, delivery_before));
+                    emit(InsertionCandidate(request_id, vehicle_id, pickup_after, delivery_after,
+                                            new_cost - old_cost, true));
+                }
+            } else if (batched) {
+                ++checked;
+
+                // Delivery ngay sau pickup thay cạnh pickup -> pickup_before, còn lại thay delivery_after -> delivery_before
+                const bool adjacent = delivery_after == pickup_after;
+                auto in = instance.distance_and_time(segment_last, delivery_vn);
+                auto out_arc = instance.distance_and_time(delivery_vn, delivery_before);
+                batch.push(segment, bw_data.data(delivery_before), pickup_new_cost, pickup_old_cost,
+                           in.time, out_arc.time, in.distance, out_arc.distance,
+                           adjacent ? pickup_removed : 0.0,
+                           adjacent ? 0.0 : instance.distance(delivery_after, delivery_before));
+                batch_positions.emplace_back(pickup_after, delivery_after);
+            } else {
+                ++checked;
+
+                // Đóng route: segment + delivery + phần còn lại (bw_data từ delivery_before)
+                refn::REFData with_delivery;
+                refn::REFData route_data;
+                segment.extend_forward_into_target(
+                    ref_delivery, with_delivery, instance.distance_and_time(segment_last, delivery_vn));
+                with_delivery.concat_into_target(
+                    bw_data.data(delivery_before), route_data,
+                    instance.distance_and_time(delivery_vn, delivery_before));
+
+                if (route_data.tw_feasible && vehicle.check_capacity(route_data.max_load)) {
+                    Num cost = calculate_insertion_cost(solution, request_id, vehicle_id,
+                                                        pickup_after, delivery_after);
+                    emit(InsertionCandidate(request_id, vehicle_id, pickup_after, delivery_after, cost, true));
+                }
             }
 
-            if (pickup_iterations >= MAX_NODES_IN_ROUTE) {
-#pragma omp critical
-                spdlog::warn("Possible cycle detected in find_all_insertions: vehicle {} hit max pickup iterations ({})",
-                             v, MAX_NODES_IN_ROUTE);
+            if (delivery_before == depot_end) {
+                break;
             }
-        }
 
-// Collect results from all threads
-#pragma omp critical
-        {
-            thread_candidates.push_back(std::move(local_candidates));
-            thread_total_checks.push_back(local_total_checks);
-            thread_feasible_checks.push_back(local_feasible_checks);
+            // Delivery lùi thêm một node: segment đi qua delivery_before. Segment chỉ dài
+            // thêm nên khi đã vi phạm time window/capacity thì mọi vị trí sau cũng vi phạm.
+            if constexpr (Variant::kGeneric) {
+                segment.extend_forward(fw_data.node(delivery_before),
+                                       instance.distance_and_time(segment_last, delivery_before));
+            } else {
+                const auto &node = fw_data.node(delivery_before);
+                const Num time = arc_of<Variant>(instance, segment_last, delivery_before).time;
+                segment.tw_feasible = segment.tw_feasible && segment.earliest_completion + time <= node.due;
+                segment.earliest_completion = std::max(segment.earliest_completion + time, node.ready) + node.servicetime;
+                if constexpr (Variant::kCheckCapacity) {
+                    segment.current_load = static_cast<problem::Capacity>(segment.current_load + node.demand);
+                    segment.max_load = std::max(segment.max_load, segment.current_load);
+                }
+            }
+            if (!segment.tw_feasible || (Variant::kCheckCapacity && !vehicle.check_capacity(segment.current_load))) {
+                local_stats.positions_pruned += end_position - solution.position(delivery_before);
+                break;
+            }
+            segment_last = delivery_before;
+            delivery_after = delivery_before;
         }
     }
 
-    // Merge results from all threads
-    for (const auto &tc : thread_candidates) {
-        candidates.insert(candidates.end(), tc.begin(), tc.end());
-    }
-    for (size_t count : thread_total_checks) {
-        total_checks += count;
-    }
-    for (size_t count : thread_feasible_checks) {
-        feasible_checks += count;
+    if (batched && batch.size() > 0) {
+        batch.evaluate(backend == EvaluationBackend::BatchAvx2 ? refn::BatchBackend::Avx2
+                                                               : refn::BatchBackend::Scalar);
+        for (size_t lane = 0; lane < batch.size(); ++lane) {
+            if (batch.feasible(lane)) {
+                emit(InsertionCandidate(request_id, vehicle_id, batch_positions[lane].first,
+                                        batch_positions[lane].second, batch.cost(lane), true));
+            }
+        }
     }
-#else
-    // Serial version (original code)
-    // Try all vehicles
-    for (size_t v = 0; v < instance.num_vehicles(); ++v) {
-        size_t depot_start = v * 2;
-        size_t depot_end = v * 2 + 1;
-
-        // Try all positions for pickup
-        size_t pickup_after = depot_start;
-        size_t pickup_iterations = 0;
-
-        while (pickup_after != depot_end && pickup_iterations < MAX_NODES_IN_ROUTE) {
-            pickup_iterations++;
-
-            // Try all positions for delivery (must be after pickup)
-            size_t delivery_after = pickup_after;
-            size_t delivery_iterations = 0;
 
-            while (delivery_after != depot_end && delivery_iterations < MAX_NODES_IN_ROUTE) {
-                delivery_iterations++;
-                total_checks++;
+    local_stats.positions_checked += checked;
+    flush_stats();
+    return checked;
+}
 
-                // Check feasibility
-                if (is_feasible_insertion(solution, request_id, v,
-                                          pickup_after, delivery_after)) {
-                    feasible_checks++;
+size_t Insertion::find_insertions_in_route(
+    const solution::Solution &solution,
+    size_t request_id,
+    size_t vehicle_id,
+    std::vector<InsertionCandidate> &out,
+    InsertionStats *stats,
+    const GranularNeighborhood *granular) {
+    return scan_route(solution, request_id, vehicle_id, stats, granular,
+                      [&out](const InsertionCandidate &candidate) { out.push_back(candidate); });
+}
 
-                    // Calculate cost
-                    Num cost = calculate_insertion_cost(solution, request_id, v, pickup_after, delivery_after);
+size_t Insertion::find_insertions_in_route(
+    const solution::Solution &solution,
+    size_t request_id,
+    size_t vehicle_id,
+    InsertionTopK &top,
+    InsertionStats *stats,
+    const GranularNeighborhood *granular) {
+    return scan_route(solution, request_id, vehicle_id, stats, granular,
+                      [&top](const InsertionCandidate &candidate) { top.push(candidate); });
+}
 
-                    candidates.emplace_back(request_id, v, pickup_after, delivery_after, cost, true);
-                }
+void Insertion::find_top_insertions(
+    const solution::Solution &solution,
+    size_t request_id,
+    InsertionTopK &top,
+    InsertionStats *stats,
+    const GranularNeighborhood *granular) {
+    find_top_insertions(solution, request_id, top, estimate_pairs(solution), stats, granular);
+}
 
-                // Move to next delivery position
-                delivery_after = solution.succ(delivery_after);
+void Insertion::find_top_insertions(
+    const solution::Solution &solution,
+    size_t request_id,
+    InsertionTopK &top,
+    size_t route_pairs,
+    InsertionStats *stats,
+    const GranularNeighborhood *granular) {
+    const auto &instance = solution.instance();
+    const size_t num_classes = instance.num_vehicle_classes();
+
+    top.clear();
+    InsertionStats call_stats;
+
+    // Bộ đệm dùng lại giữa các lời gọi trên cùng thread (lambda song song bên dưới chạy
+    // trên worker khác nên chỉ dùng chúng qua tham chiếu)
+    thread_local std::vector<size_t> empty_representative;
+    thread_local std::vector<InsertionCandidate> empty_result;
+    thread_local std::vector<size_t> routes_buffer;
+    auto &routes = routes_buffer;
+    empty_representative.assign(num_classes, instance.num_vehicles());
+    empty_result.assign(num_classes, InsertionCandidate());
+    routes.clear();
+
+    // Route rỗng chỉ có một cặp vị trí và kết quả chỉ phụ thuộc lớp xe:
+    // mỗi lớp đánh giá một route rỗng, các route rỗng còn lại dùng lại kết quả
+    for (size_t v = 0; v < instance.num_vehicles(); ++v) {
+        if (!solution.is_route_empty(v)) {
+            routes.push_back(v);
+            continue;
+        }
+        size_t cls = instance.vehicle_class(v);
+        if (empty_representative[cls] == instance.num_vehicles()) {
+            empty_representative[cls] = v;
+            InsertionTopK first(1);
+            find_insertions_in_route(solution, request_id, v, first, &call_stats, granular);
+            if (!first.empty()) {
+                empty_result[cls] = first.best();
             }
+        } else {
+            ++call_stats.routes_pruned;
+            ++call_stats.positions_pruned;
+        }
+        if (empty_result[cls].feasible) {
+            size_t depot_start = instance.vn_id_of(v);
+            top.push(InsertionCandidate(request_id, v, depot_start, depot_start,
+                                        empty_result[cls].cost_increase, true));
+        }
+    }
 
-            if (delivery_iterations >= MAX_NODES_IN_ROUTE) {
-                spdlog::warn("Possible cycle detected in find_all_insertions: vehicle {} hit max delivery iterations ({})", v, MAX_NODES_IN_ROUTE);
+    auto &pool = utils::ThreadPool::global();
+    if (routes.size() > 1 && route_pairs >= parallel_cutoff() && pool.num_threads() > 1 &&
+        !utils::ThreadPool::in_parallel_region()) {
+        // Solution lớn: song song theo route, mỗi worker giữ top-k riêng rồi gộp
+        thread_local std::vector<InsertionTopK> worker_top_buffer;
+        thread_local std::vector<InsertionStats> worker_stats_buffer;
+        auto &worker_top = worker_top_buffer;
+        auto &worker_stats = worker_stats_buffer;
+        worker_top.assign(pool.num_threads(), InsertionTopK(top.k()));
+        worker_stats.assign(pool.num_threads(), InsertionStats());
+        pool.parallel_for(routes.size(), 1, [&](size_t begin, size_t end, size_t worker) {
+            for (size_t i = begin; i < end; ++i) {
+                find_insertions_in_route(solution, request_id, routes[i], worker_top[worker],
+                                         &worker_stats[worker], granular);
             }
-
-            // Move to next pickup position
-            pickup_after = solution.succ(pickup_after);
+        });
+        for (size_t w = 0; w < worker_top.size(); ++w) {
+            top.merge(worker_top[w]);
+            call_stats += worker_stats[w];
         }
-
-        if (pickup_iterations >= MAX_NODES_IN_ROUTE) {
-            spdlog::warn("Possible cycle detected in find_all_insertions: vehicle {} hit max pickup iterations ({})", v, MAX_NODES_IN_ROUTE);
+    } else {
+        for (size_t v : routes) {
+            find_insertions_in_route(solution, request_id, v, top, &call_stats, granular);
         }
     }
-#endif
 
     if (request_id == 0) { // Only log for first request to avoid spam
-        spdlog::debug("Request {}: Checked {} positions, {} feasible, {} candidates found", request_id, total_checks, feasible_checks, candidates.size());
+        spdlog::debug("Request {}: Checked {} positions ({} pruned), routes scanned {} ({} pruned), {} candidates kept",
+                      request_id, call_stats.positions_checked, call_stats.positions_pruned,
+                      call_stats.routes_scanned, call_stats.routes_pruned, top.size());
     }
 
-    return candidates;
+    if (stats) {
+        *stats += call_stats;
+    }
 }
 
 } // namespace pdptw::construction
\ No newline at end of file
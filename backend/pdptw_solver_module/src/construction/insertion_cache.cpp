@@ -0,0 +1,294 @@
+#include "pdptw/construction/insertion_cache.hpp"
+#include "pdptw/utils/thread_pool.hpp"
+#include <algorithm>
+#include <utility>
+
+namespace pdptw::construction {
+
+void InsertionCache::clear() {
+    solution_uid_ = 0;
+    num_vehicles_ = 0;
+    entries_.clear();
+    hits_ = 0;
+    misses_ = 0;
+    stats_ = InsertionStats();
+}
+
+void InsertionCache::set_granular(std::shared_ptr<const GranularNeighborhood> granular) {
+    granular_ = std::move(granular);
+    solution_uid_ = 0;
+    num_vehicles_ = 0;
+    entries_.clear();
+}
+
+void InsertionCache::bind(const solution::Solution &solution) {
+    const auto &instance = solution.instance();
+    if (solution_uid_ != solution.uid() || num_vehicles_ != instance.num_vehicles()) {
+        solution_uid_ = solution.uid();
+        num_vehicles_ = instance.num_vehicles();
+        num_requests_ = instance.num_requests();
+        num_classes_ = instance.num_vehicle_classes();
+        route_slots_.assign(num_vehicles_, kNoSlot);
+        free_slots_.clear();
+        num_slots_ = num_classes_;
+        slot_capacity_ = num_classes_ + solution.number_of_non_empty_routes();
+        entries_.assign(num_requests_ * slot_capacity_, RouteEntry{});
+    }
+    sync_slots(solution);
+}
+
+void InsertionCache::sync_slots(const solution::Solution &solution) {
+    const auto &instance = solution.instance();
+    representatives_.clear();
+    class_listed_.assign(num_classes_, false);
+    for (size_t v = 0; v < num_vehicles_; ++v) {
+        const size_t cls = instance.vehicle_class(v);
+        const size_t slot = route_slots_[v];
+        if (solution.is_route_empty(v)) {
+            if (slot != cls) {
+                if (slot != kNoSlot) {
+                    free_slots_.push_back(slot);
+                }
+                route_slots_[v] = cls;
+            }
+            // Lớp xe chỉ cần một route rỗng đại diện
+            if (!class_listed_[cls]) {
+                class_listed_[cls] = true;
+                representatives_.push_back(v);
+            }
+            continue;
+        }
+        if (slot == kNoSlot || slot < num_classes_) {
+            route_slots_[v] = allocate_slot();
+        }
+        representatives_.push_back(v);
+    }
+}
+
+size_t InsertionCache::allocate_slot() {
+    size_t slot;
+    if (!free_slots_.empty()) {
+        slot = free_slots_.back();
+        free_slots_.pop_back();
+    } else {
+        if (num_slots_ == slot_capacity_) {
+            // Tối đa mỗi vehicle một slot riêng cộng slot của các lớp xe
+            grow_slots(std::min(std::max(slot_capacity_ + slot_capacity_ / 2, slot_capacity_ + 1),
+                                num_classes_ + num_vehicles_));
+        }
+        slot = num_slots_++;
+    }
+    // Slot trước đó có thể thuộc route khác
+    for (size_t r = 0; r < num_requests_; ++r) {
+        entries_[r * slot_capacity_ + slot].route_version = kInvalidVersion;
+    }
+    return slot;
+}
+
+void InsertionCache::grow_slots(size_t capacity) {
+    std::vector<RouteEntry> grown(num_requests_ * capacity);
+    for (size_t r = 0; r < num_requests_; ++r) {
+        std::copy_n(entries_.begin() + r * slot_capacity_, slot_capacity_, grown.begin() + r * capacity);
+    }
+    entries_.swap(grown);
+    slot_capacity_ = capacity;
+}
+
+bool InsertionCache::is_fresh(const solution::Solution &solution, size_t request_id, size_t vehicle_id) const {
+    const RouteEntry &route_entry = entry(request_id, vehicle_id);
+    if (route_slots_[vehicle_id] < num_classes_) {
+        // Route rỗng: kết quả chỉ phụ thuộc lớp xe, tính một lần là đủ
+        return route_entry.route_version != kInvalidVersion;
+    }
+    return route_entry.route_version == solution.route_version(vehicle_id);
+}
+
+void InsertionCache::refresh_route(const solution::Solution &solution, size_t request_id,
+                                   size_t vehicle_id, InsertionStats &stats) {
+    InsertionTopK top(kRouteTopK);
+    Insertion::find_insertions_in_route(solution, request_id, vehicle_id, top, &stats, granular_.get());
+
+    RouteEntry &route_entry = entry(request_id, vehicle_id);
+    route_entry.count = top.size();
+    for (size_t i = 0; i < top.size(); ++i) {
+        route_entry.top[i] = top[i];
+    }
+    route_entry.route_version = solution.route_version(vehicle_id);
+}
+
+void InsertionCache::refresh_request(const solution::Solution &solution, size_t request_id,
+                                     WorkerState &state) {
+    state.stale.clear();
+    for (size_t v : representatives_) {
+        if (!is_fresh(solution, request_id, v)) {
+            state.stale.push_back(v);
+        }
+    }
+    state.hits += representatives_.size() - state.stale.size();
+    state.misses += state.stale.size();
+
+    for (size_t v : state.stale) {
+        refresh_route(solution, request_id, v, state.stats);
+    }
+}
+
+void InsertionCache::merge_workers() {
+    for (auto &state : workers_) {
+        hits_ += state.hits;
+        misses_ += state.misses;
+        stats_ += state.stats;
+        state.hits = 0;
+        state.misses = 0;
+        state.stats = InsertionStats();
+    }
+}
+
+void InsertionCache::collect(const solution::Solution &solution, size_t request_id, InsertionTopK &top,
+                             RouteScope scope) const {
+    const auto &instance = solution.instance();
+    top.clear();
+    for (size_t v = 0; v < num_vehicles_; ++v) {
+        const RouteEntry &route_entry = entry(request_id, v);
+        const bool empty_route = route_slots_[v] < num_classes_;
+        if (scope != RouteScope::All && empty_route != (scope == RouteScope::Empty)) {
+            continue;
+        }
+        if (empty_route) {
+            // Entry chung của lớp xe: đặt lại vehicle như Insertion::find_top_insertions
+            if (route_entry.count > 0 && route_entry.top[0].feasible) {
+                size_t depot_start = instance.vn_id_of(v);
+                top.push(InsertionCandidate(request_id, v, depot_start, depot_start,
+                                            route_entry.top[0].cost_increase, true));
+            }
+            continue;
+        }
+        for (size_t i = 0; i < route_entry.count; ++i) {
+            top.push(route_entry.top[i]);
+        }
+    }
+}
+
+InsertionCandidate InsertionCache::find_best_insertion(const solution::Solution &solution, size_t request_id) {
+    bind(solution);
+    auto &pool = utils::ThreadPool::global();
+    workers_.resize(pool.num_threads());
+
+    // Một request: song song theo route cũ khi số cặp vị trí cần tính lại đủ lớn
+    WorkerState &main = workers_[0];
+    main.stale.clear();
+    size_t stale_pairs = 0;
+    for (size_t v : representatives_) {
+        if (!is_fresh(solution, request_id, v)) {
+            main.stale.push_back(v);
+            size_t m = solution.position(solution.instance().vn_id_of(v) + 1);
+            stale_pairs += m * (m + 1) / 2;
+        }
+    }
+    main.hits += representatives_.size() - main.stale.size();
+    main.misses += main.stale.size();
+
+    if (main.stale.size() > 1 && stale_pairs >= Insertion::parallel_cutoff()) {
+        stale_routes_.assign(main.stale.begin(), main.stale.end());
+        pool.parallel_for(stale_routes_.size(), 1, [&](size_t begin, size_t end, size_t worker) {
+            WorkerState &state = workers_[worker];
+            for (size_t i = begin; i < end; ++i) {
+                refresh_route(solution, request_id, stale_routes_[i], state.stats);
+            }
+        });
+    } else {
+        for (size_t v : main.stale) {
+            refresh_route(solution, request_id, v, main.stats);
+        }
+    }
+    merge_workers();
+
+    InsertionTopK best(1);
+    collect(solution, request_id, best);
+    return best.empty() ? InsertionCandidate() : best.best();
+}
+
+void InsertionCache::find_top_insertions(
+    const solution::Solution &solution,
+    size_t request_id,
+    InsertionTopK &top,
+    RouteScope scope) {
+    bind(solution);
+    workers_.resize(std::max<size_t>(1, workers_.size()));
+    refresh_request(solution, request_id, workers_[0]);
+    merge_workers();
+    collect(solution, request_id, top, scope);
+}
+
+void InsertionCache::find_top_insertions(
+    const solution::Solution &solution,
+    const std::vector<size_t> &requests,
+    std::vector<InsertionTopK> &tops) {
+    bind(solution);
+    auto &pool = utils::ThreadPool::global();
+    workers_.resize(pool.num_threads());
+
+    // Mỗi request chỉ chạm entry và top của chính nó: song song theo request, counter theo worker
+    auto evaluate = [&](size_t begin, size_t end, size_t worker) {
+        WorkerState &state = workers_[worker];
+        for (size_t i = begin; i < end; ++i) {
+            if (tops[i].k() > kRouteTopK) {
+                Insertion::find_top_insertions(solution, requests[i], tops[i], &state.stats, granular_.get());
+                continue;
+            }
+            refresh_request(solution, requests[i], state);
+            collect(solution, requests[i], tops[i]);
+        }
+    };
+
+    // Chỉ song song khi có nhiều route phải tính lại (sau lần đầu thường chỉ 1-2 route cũ)
+    size_t stale_entries = 0;
+    for (size_t i = 0; i < requests.size(); ++i) {
+        if (tops[i].k() > kRouteTopK) {
+            stale_entries += representatives_.size();
+            continue;
+        }
+        for (size_t v : representatives_) {
+            stale_entries += is_fresh(solution, requests[i], v) ? 0 : 1;
+        }
+    }
+    if (requests.size() > 1 && stale_entries > 1 &&
+        stale_entries * kStaleEntryPairs >= Insertion::parallel_cutoff()) {
+        pool.parallel_for(requests.size(), 1, evaluate);
+    } else {
+        evaluate(0, requests.size(), 0);
+    }
+    merge_workers();
+}
+
+std::vector<InsertionCandidate> InsertionCache::calculate_regret(
+    const solution::Solution &solution,
+    const std::vector<size_t> &unassigned_requests,
+    size_t k) {
+    if (k == 0 || k > kRouteTopK) {
+        return Insertion::calculate_regret(solution, unassigned_requests, k, &stats_, granular_.get());
+    }
+
+    regret_tops_.assign(unassigned_requests.size(), InsertionTopK(k));
+    find_top_insertions(solution, unassigned_requests, regret_tops_);
+
+    std::vector<InsertionCandidate> regret_candidates(unassigned_requests.size());
+    for (size_t i = 0; i < unassigned_requests.size(); ++i) {
+        const InsertionTopK &best = regret_tops_[i];
+        if (best.empty()) {
+            // Không có vị trí khả thi: regret vô cùng để được xét trước
+            InsertionCandidate inf_candidate;
+            inf_candidate.request_id = unassigned_requests[i];
+            inf_candidate.regret_value = std::numeric_limits<Num>::infinity();
+            regret_candidates[i] = inf_candidate;
+            continue;
+        }
+
+        // Cùng quy tắc với Insertion::calculate_regret
+        InsertionCandidate candidate = best.best();
+        candidate.regret_value = best.regret();
+        regret_candidates[i] = candidate;
+    }
+    return regret_candidates;
+}
+
+} // namespace pdptw::construction
@@ -0,0 +1,219 @@
+#include "pdptw/construction/regret_heap.hpp"
+#include "pdptw/utils/thread_pool.hpp"
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+namespace pdptw::construction {
+
+namespace {
+
+constexpr Num kInf = std::numeric_limits<Num>::infinity();
+
+// Số cặp vị trí của một route (cùng ước lượng với Insertion)
+size_t route_pairs(const solution::Solution &solution, size_t vehicle_id) {
+    size_t m = solution.position(solution.instance().vn_id_of(vehicle_id) + 1);
+    return m * (m + 1) / 2;
+}
+
+} // namespace
+
+RegretHeap::RegretHeap(size_t k)
+    : k_(std::clamp<size_t>(k, 1, InsertionTopK::kMaxK)) {}
+
+void RegretHeap::reset(const solution::Solution &solution,
+                       const std::vector<size_t> &requests,
+                       InsertionCache *cache) {
+    cache_ = cache;
+    granular_ = cache ? cache->granular() : nullptr;
+    stats_ = InsertionStats();
+    full_refreshes_ = 0;
+    route_refreshes_ = 0;
+    heap_pushes_ = 0;
+
+    const size_t num_requests = solution.instance().num_requests();
+    tops_.resize(num_requests);
+    regret_.resize(num_requests);
+    cost_.resize(num_requests);
+    version_.resize(num_requests, 0);
+    slot_.assign(num_requests, kNotPending);
+
+    pending_ = requests;
+    for (size_t i = 0; i < pending_.size(); ++i) {
+        slot_[pending_[i]] = i;
+        tops_[pending_[i]].reset(k_);
+    }
+
+    search_full(solution, pending_);
+
+    heap_.clear();
+    for (size_t request_id : pending_) {
+        update_key(request_id, true);
+    }
+    settle_top();
+}
+
+void RegretHeap::search_full(const solution::Solution &solution, const std::vector<size_t> &requests) {
+    if (requests.empty()) {
+        return;
+    }
+    full_refreshes_ += requests.size();
+
+    if (cache_) {
+        full_tops_.assign(requests.size(), InsertionTopK(k_));
+        cache_->find_top_insertions(solution, requests, full_tops_);
+        for (size_t i = 0; i < requests.size(); ++i) {
+            tops_[requests[i]] = full_tops_[i];
+        }
+        return;
+    }
+
+    auto &pool = utils::ThreadPool::global();
+    worker_stats_.assign(pool.num_threads(), InsertionStats());
+    auto evaluate = [&](size_t begin, size_t end, size_t worker) {
+        for (size_t i = begin; i < end; ++i) {
+            Insertion::find_top_insertions(solution, requests[i], tops_[requests[i]],
+                                           &worker_stats_[worker], granular_);
+        }
+    };
+
+    size_t pairs = 0;
+    for (size_t v = 0; v < solution.instance().num_vehicles(); ++v) {
+        pairs += solution.is_route_empty(v) ? 0 : route_pairs(solution, v);
+    }
+    if (requests.size() > 1 && requests.size() * pairs >= Insertion::parallel_cutoff()) {
+        pool.parallel_for(requests.size(), 1, evaluate);
+    } else {
+        evaluate(0, requests.size(), 0);
+    }
+    for (const auto &ws : worker_stats_) {
+        stats_ += ws;
+    }
+}
+
+void RegretHeap::search_route(const solution::Solution &solution, const std::vector<size_t> &requests,
+                              size_t vehicle_id) {
+    if (requests.empty()) {
+        return;
+    }
+    route_refreshes_ += requests.size();
+
+    auto &pool = utils::ThreadPool::global();
+    worker_stats_.assign(pool.num_threads(), InsertionStats());
+    auto evaluate = [&](size_t begin, size_t end, size_t worker) {
+        for (size_t i = begin; i < end; ++i) {
+            Insertion::find_insertions_in_route(solution, requests[i], vehicle_id, tops_[requests[i]],
+                                                &worker_stats_[worker], granular_);
+        }
+    };
+
+    if (requests.size() > 1 && requests.size() * route_pairs(solution, vehicle_id) >= Insertion::parallel_cutoff()) {
+        pool.parallel_for(requests.size(), 1, evaluate);
+    } else {
+        evaluate(0, requests.size(), 0);
+    }
+    for (const auto &ws : worker_stats_) {
+        stats_ += ws;
+    }
+}
+
+void RegretHeap::update_key(size_t request_id, bool force) {
+    const InsertionTopK &top = tops_[request_id];
+    // Không có vị trí khả thi: regret vô cùng để được xét trước (như calculate_regret)
+    Num regret = top.empty() ? kInf : top.regret();
+    Num cost = top.empty() ? kInf : top.best().cost_increase;
+    if (!force && regret == regret_[request_id] && cost == cost_[request_id]) {
+        return;
+    }
+
+    regret_[request_id] = regret;
+    cost_[request_id] = cost;
+    ++version_[request_id];
+    heap_.push_back(Entry{regret, cost, request_id, version_[request_id]});
+    std::push_heap(heap_.begin(), heap_.end(), lower_priority);
+    ++heap_pushes_;
+}
+
+void RegretHeap::remove_pending(size_t request_id) {
+    size_t i = slot_[request_id];
+    size_t last = pending_.back();
+    pending_[i] = last;
+    slot_[last] = i;
+    pending_.pop_back();
+    slot_[request_id] = kNotPending;
+}
+
+void RegretHeap::settle_top() {
+    if (pending_.empty()) {
+        heap_.clear();
+        return;
+    }
+
+    // Entry cũ chiếm quá nhiều chỗ: dựng lại heap từ khoá hiện tại
+    if (heap_.size() > 2 * pending_.size() + 64) {
+        heap_.clear();
+        for (size_t request_id : pending_) {
+            heap_.push_back(Entry{regret_[request_id], cost_[request_id], request_id, version_[request_id]});
+        }
+        std::make_heap(heap_.begin(), heap_.end(), lower_priority);
+    }
+
+    while (true) {
+        const Entry &head = heap_.front();
+        if (slot_[head.request_id] != kNotPending && head.version == version_[head.request_id]) {
+            break;
+        }
+        std::pop_heap(heap_.begin(), heap_.end(), lower_priority);
+        heap_.pop_back();
+    }
+
+    const size_t request_id = heap_.front().request_id;
+    const InsertionTopK &top = tops_[request_id];
+    if (top.empty()) {
+        top_ = InsertionCandidate();
+        top_.request_id = request_id;
+        top_.regret_value = kInf;
+    } else {
+        top_ = top.best();
+        top_.regret_value = top.regret();
+    }
+}
+
+void RegretHeap::pop() {
+    remove_pending(top_.request_id);
+    settle_top();
+}
+
+void RegretHeap::insert_top(solution::Solution &solution) {
+    assert(top_.feasible);
+    const InsertionCandidate candidate = top_;
+    const size_t vehicle_id = candidate.vehicle_id;
+    remove_pending(candidate.request_id);
+    Insertion::insert_request(solution, candidate);
+
+    // Chỉ route vehicle_id đổi: request có vị trí trong top-k trên route này phải tìm lại
+    // toàn bộ, các request khác chỉ cần xét thêm vị trí mới của route
+    full_.clear();
+    partial_.clear();
+    for (size_t request_id : pending_) {
+        const InsertionTopK &top = tops_[request_id];
+        bool touched = false;
+        for (size_t i = 0; i < top.size() && !touched; ++i) {
+            touched = top[i].vehicle_id == vehicle_id;
+        }
+        (touched ? full_ : partial_).push_back(request_id);
+    }
+
+    search_full(solution, full_);
+    search_route(solution, partial_, vehicle_id);
+
+    for (size_t request_id : full_) {
+        update_key(request_id, false);
+    }
+    for (size_t request_id : partial_) {
+        update_key(request_id, false);
+    }
+    settle_top();
+}
+
+} // namespace pdptw::construction
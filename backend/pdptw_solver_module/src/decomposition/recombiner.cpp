@@ -1,5 +1,6 @@
 #include "pdptw/decomposition/recombiner.hpp"
 #include "pdptw/construction/insertion.hpp"
+#include "pdptw/construction/insertion_cache.hpp"
 #include "pdptw/solution/description.hpp"
 #include <algorithm>
 #include <spdlog/spdlog.h>
@@ -54,7 +55,7 @@ solution::Solution SolutionRecombiner::greedy_merge(const std::vector<PartialIns
             size_t start_full = instance_.vn_id_of(route_id);
             target.push_back(start_full);
             for (size_t node_id : routes[route_id]) {
-                if (node_id == partial.instance.vn_id_of(route_id) || node_id == partial.instance.vn_id_of(route_id) + 1) {
+                if (node_id == partial.instance->vn_id_of(route_id) || node_id == partial.instance->vn_id_of(route_id) + 1) {
                     continue;
                 }
                 size_t full_node = partial.partial_to_full_nodes[node_id];
@@ -64,18 +65,11 @@ solution::Solution SolutionRecombiner::greedy_merge(const std::vector<PartialIns
         }
     }
 
+    // set() đưa mọi request không nằm trong route nào vào bank: gồm unassigned_request_ids
+    // và cả những request mà LNS con để lại chưa chèn
+    (void)unassigned_request_ids;
     combined.set(itineraries);
 
-    combined.unassigned_requests().clear();
-    for (size_t request_id = 0; request_id < instance_.num_requests(); ++request_id) {
-        size_t pickup = instance_.pickup_id_of_request(request_id);
-        combined.unassigned_requests().remove(pickup);
-    }
-    for (size_t request_id : unassigned_request_ids) {
-        size_t pickup = instance_.pickup_id_of_request(request_id);
-        combined.unassigned_requests().insert_pickup_id(pickup);
-    }
-
     return combined;
 }
 
@@ -92,10 +86,10 @@ solution::Solution SolutionRecombiner::best_fit_merge(const std::vector<PartialI
     std::shuffle(pending_requests.begin(), pending_requests.end(), rng);
 
     // 4. Try to insert each request
+    construction::InsertionCache insertion_cache;
     for (size_t request_id : pending_requests) {
         // Find best insertion position
-        auto candidate = construction::Insertion::find_best_insertion(
-            combined, request_id, construction::InsertionStrategy::BestCost);
+        auto candidate = insertion_cache.find_best_insertion(combined, request_id);
 
         // If feasible, apply insertion
         if (candidate.feasible) {
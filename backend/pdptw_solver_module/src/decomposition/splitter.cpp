@@ -13,7 +13,6 @@ using problem::Node;
 using problem::NodeType;
 using problem::PDPTWInstance;
 using problem::RequestId;
-using problem::TravelMatrix;
 using solution::Solution;
 
 Node clone_node(size_t new_id, const PDPTWInstance &instance, size_t full_id) {
@@ -215,27 +214,24 @@ PartialInstance SolutionSplitter::build_partial(const std::vector<size_t> &reque
         pickup_full_ids.push_back(pickup_full);
     }
 
-    auto matrix = std::make_shared<TravelMatrix>(nodes.size());
-    for (size_t i = 0; i < nodes.size(); ++i) {
-        size_t full_i = mapping[i];
-        for (size_t j = 0; j < nodes.size(); ++j) {
-            size_t full_j = mapping[j];
-            matrix->set_distance(i, j, instance_.distance(full_i, full_j));
-            matrix->set_time(i, j, instance_.time(full_i, full_j));
-        }
+    // Dùng chung ma trận của instance gốc, chỉ ánh xạ lại node -> địa điểm
+    std::vector<problem::LocationId> node_locations(mapping.size());
+    for (size_t i = 0; i < mapping.size(); ++i) {
+        node_locations[i] = instance_.location_of(mapping[i]);
     }
 
     std::vector<problem::Vehicle> vehicles = instance_.vehicles();
 
-    PDPTWInstance sub_instance = problem::create_instance_with(
+    auto sub_instance = std::make_shared<const PDPTWInstance>(problem::create_instance_with(
         instance_.name() + "_sub",
         num_vehicles,
         num_requests,
         vehicles,
         nodes,
-        matrix);
+        instance_.shared_travel_matrix(),
+        std::move(node_locations)));
 
-    Solution partial(sub_instance);
+    Solution partial(*sub_instance);
 
     std::unordered_map<size_t, size_t> full_to_partial;
     full_to_partial.reserve(mapping.size());
@@ -245,7 +241,7 @@ PartialInstance SolutionSplitter::build_partial(const std::vector<size_t> &reque
 
     std::vector<std::vector<size_t>> itineraries(num_vehicles);
     for (size_t v = 0; v < num_vehicles; ++v) {
-        size_t vn = sub_instance.vn_id_of(v);
+        size_t vn = sub_instance->vn_id_of(v);
         itineraries[v] = {vn, vn + 1};
     }
 
@@ -253,7 +249,7 @@ PartialInstance SolutionSplitter::build_partial(const std::vector<size_t> &reque
         const auto route_nodes = full_solution_.iter_route(route_id);
         std::vector<size_t> projected;
         projected.reserve(route_nodes.size());
-        size_t partial_vn = sub_instance.vn_id_of(route_id);
+        size_t partial_vn = sub_instance->vn_id_of(route_id);
         projected.push_back(partial_vn);
 
         for (size_t node_id : route_nodes) {
@@ -0,0 +1,367 @@
+#include "pdptw/io/instance_cache.hpp"
+#include "pdptw/problem/travel_matrix.hpp"
+#include "pdptw/utils/mapped_file.hpp"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include <spdlog/spdlog.h>
+#include <sstream>
+#include <stdexcept>
+#include <type_traits>
+
+namespace pdptw::io {
+
+using namespace pdptw::problem;
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr char kMagic[8] = {'P', 'D', 'P', 'T', 'W', 'B', 'I', 'N'};
+constexpr uint32_t kFormatVersion = 2;
+constexpr uint64_t kSectionAlignment = 64;
+
+struct CacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint64_t source_hash;
+    uint64_t max_vehicles;
+    uint64_t num_requests;
+    uint64_t num_vehicles;
+    uint64_t num_nodes;
+    uint64_t matrix_size;
+    uint32_t matrix_precision;
+    uint32_t matrix_shared;
+    uint32_t matrix_symmetric;
+    uint32_t matrix_time_equals_distance;
+    uint64_t name_offset;
+    uint64_t name_length;
+    uint64_t nodes_offset;
+    uint64_t vehicles_offset;
+    uint64_t locations_offset;
+    uint64_t matrix_offset;
+    uint64_t matrix_bytes;
+    uint64_t file_size;
+};
+
+struct NodeRecord {
+    uint64_t id;
+    uint64_t oid;
+    uint64_t gid;
+    double x;
+    double y;
+    double ready;
+    double due;
+    double servicetime;
+    int32_t demand;
+    uint32_t node_type;
+};
+
+struct VehicleRecord {
+    double shift_length;
+    int32_t seats;
+    uint32_t reserved;
+};
+
+static_assert(std::is_trivially_copyable_v<CacheHeader>);
+static_assert(std::is_trivially_copyable_v<NodeRecord>);
+static_assert(std::is_trivially_copyable_v<VehicleRecord>);
+
+uint64_t align_up(uint64_t offset) {
+    return (offset + kSectionAlignment - 1) / kSectionAlignment * kSectionAlignment;
+}
+
+// Hash kiểu FNV-1a trên từng word 64-bit
+uint64_t hash_bytes(const std::byte *data, size_t size) {
+    constexpr uint64_t kPrime = 1099511628211ULL;
+    uint64_t hash = 14695981039346656037ULL ^ static_cast<uint64_t>(size);
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        hash = (hash ^ word) * kPrime;
+        hash ^= hash >> 29;
+    }
+    for (; i < size; ++i) {
+        hash = (hash ^ static_cast<uint64_t>(data[i])) * kPrime;
+    }
+    return hash;
+}
+
+bool section_fits(uint64_t offset, uint64_t bytes, uint64_t file_size) {
+    return offset <= file_size && bytes <= file_size - offset;
+}
+
+void write_padding(std::ofstream &out, uint64_t target_offset) {
+    static const char zeros[kSectionAlignment] = {};
+    uint64_t pos = static_cast<uint64_t>(out.tellp());
+    if (target_offset > pos) {
+        out.write(zeros, static_cast<std::streamsize>(target_offset - pos));
+    }
+}
+
+template <typename T>
+T read_record(const std::byte *base, uint64_t offset, size_t index) {
+    T record;
+    std::memcpy(&record, base + offset + index * sizeof(T), sizeof(T));
+    return record;
+}
+
+} // namespace
+
+uint64_t hash_file(const std::string &filepath) {
+    auto file = utils::MappedFile::open(filepath);
+    return hash_bytes(file->data(), file->size());
+}
+
+std::string instance_cache_path(const std::string &cache_dir,
+                                const std::string &source_path,
+                                uint64_t source_hash,
+                                size_t max_vehicles) {
+    std::ostringstream name;
+    name << fs::path(source_path).stem().string() << '-'
+         << std::hex << std::setw(16) << std::setfill('0') << source_hash << std::dec
+         << "-v" << max_vehicles << ".pdptwbin";
+    return (fs::path(cache_dir) / name.str()).string();
+}
+
+void write_instance_cache(const std::string &cache_path,
+                          const PDPTWInstance &instance,
+                          uint64_t source_hash,
+                          size_t max_vehicles) {
+    const auto &nodes = instance.nodes();
+    const auto &vehicles = instance.vehicles();
+    const auto &locations = instance.node_locations();
+    const auto &matrix = instance.travel_matrix();
+
+    CacheHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kFormatVersion;
+    header.header_size = sizeof(CacheHeader);
+    header.source_hash = source_hash;
+    header.max_vehicles = max_vehicles;
+    header.num_requests = instance.num_requests();
+    header.num_vehicles = instance.num_vehicles();
+    header.num_nodes = nodes.size();
+    header.matrix_size = matrix.size();
+    header.matrix_precision = static_cast<uint32_t>(matrix.storage().precision);
+    header.matrix_shared = matrix.storage().shared_time_distance ? 1 : 0;
+    const MatrixTraits matrix_traits = matrix.traits();
+    header.matrix_symmetric = matrix_traits.symmetric ? 1 : 0;
+    header.matrix_time_equals_distance = matrix_traits.time_equals_distance ? 1 : 0;
+    header.name_offset = align_up(sizeof(CacheHeader));
+    header.name_length = instance.name().size();
+    header.nodes_offset = align_up(header.name_offset + header.name_length);
+    header.vehicles_offset = align_up(header.nodes_offset + nodes.size() * sizeof(NodeRecord));
+    header.locations_offset = align_up(header.vehicles_offset + vehicles.size() * sizeof(VehicleRecord));
+    header.matrix_offset = align_up(header.locations_offset + locations.size() * sizeof(LocationId));
+    header.matrix_bytes = matrix.memory_bytes();
+    header.file_size = header.matrix_offset + header.matrix_bytes;
+
+    // Ghi ra file tạm rồi rename để tiến trình khác không đọc phải file dở dang
+    std::random_device rd;
+    std::string tmp_path = cache_path + ".tmp" + std::to_string(rd());
+    {
+        std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            throw std::runtime_error("Cannot create cache file: " + tmp_path);
+        }
+
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+        write_padding(out, header.name_offset);
+        out.write(instance.name().data(), static_cast<std::streamsize>(header.name_length));
+
+        write_padding(out, header.nodes_offset);
+        for (const auto &node : nodes) {
+            NodeRecord record{};
+            record.id = node.id();
+            record.oid = node.oid();
+            record.gid = node.gid();
+            record.x = node.x();
+            record.y = node.y();
+            record.ready = node.ready();
+            record.due = node.due();
+            record.servicetime = node.servicetime();
+            record.demand = node.demand();
+            record.node_type = static_cast<uint32_t>(node.node_type());
+            out.write(reinterpret_cast<const char *>(&record), sizeof(record));
+        }
+
+        write_padding(out, header.vehicles_offset);
+        for (const auto &vehicle : vehicles) {
+            VehicleRecord record{};
+            record.shift_length = vehicle.shift_length();
+            record.seats = vehicle.seats();
+            out.write(reinterpret_cast<const char *>(&record), sizeof(record));
+        }
+
+        write_padding(out, header.locations_offset);
+        out.write(reinterpret_cast<const char *>(locations.data()),
+                  static_cast<std::streamsize>(locations.size() * sizeof(LocationId)));
+
+        write_padding(out, header.matrix_offset);
+        out.write(reinterpret_cast<const char *>(matrix.data()),
+                  static_cast<std::streamsize>(header.matrix_bytes));
+
+        if (!out) {
+            out.close();
+            std::error_code ec;
+            fs::remove(tmp_path, ec);
+            throw std::runtime_error("Failed to write cache file: " + tmp_path);
+        }
+    }
+
+    std::error_code ec;
+    fs::rename(tmp_path, cache_path, ec);
+    if (ec) {
+        fs::remove(tmp_path, ec);
+        throw std::runtime_error("Cannot move cache file into place: " + cache_path);
+    }
+}
+
+std::optional<PDPTWInstance> load_instance_cache(const std::string &cache_path,
+                                                 uint64_t source_hash,
+                                                 size_t max_vehicles) {
+    std::error_code ec;
+    if (!fs::exists(cache_path, ec)) {
+        return std::nullopt;
+    }
+
+    std::shared_ptr<const utils::MappedFile> file;
+    try {
+        file = utils::MappedFile::open(cache_path);
+    } catch (const std::exception &e) {
+        spdlog::warn("Cannot open instance cache {}: {}", cache_path, e.what());
+        return std::nullopt;
+    }
+
+    const std::byte *base = file->data();
+    const uint64_t file_size = file->size();
+    if (file_size < sizeof(CacheHeader)) {
+        return std::nullopt;
+    }
+
+    CacheHeader header;
+    std::memcpy(&header, base, sizeof(header));
+
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+        header.version != kFormatVersion ||
+        header.header_size != sizeof(CacheHeader) ||
+        header.file_size != file_size) {
+        spdlog::info("Ignoring instance cache {} (different format version)", cache_path);
+        return std::nullopt;
+    }
+    if (header.source_hash != source_hash || header.max_vehicles != max_vehicles) {
+        return std::nullopt;
+    }
+
+    MatrixStorage storage;
+    storage.shared_time_distance = header.matrix_shared != 0;
+    switch (header.matrix_precision) {
+    case static_cast<uint32_t>(MatrixPrecision::Float64):
+        storage.precision = MatrixPrecision::Float64;
+        break;
+    case static_cast<uint32_t>(MatrixPrecision::Float32):
+        storage.precision = MatrixPrecision::Float32;
+        break;
+    case static_cast<uint32_t>(MatrixPrecision::UInt32):
+        storage.precision = MatrixPrecision::UInt32;
+        break;
+    default:
+        return std::nullopt;
+    }
+
+    const uint64_t value_bytes = storage.precision == MatrixPrecision::Float64 ? 8 : 4;
+    const uint64_t expected_matrix_bytes =
+        header.matrix_size * header.matrix_size * (storage.shared_time_distance ? 1 : 2) * value_bytes;
+    if (header.matrix_bytes != expected_matrix_bytes ||
+        header.matrix_offset % kSectionAlignment != 0 ||
+        !section_fits(header.name_offset, header.name_length, file_size) ||
+        !section_fits(header.nodes_offset, header.num_nodes * sizeof(NodeRecord), file_size) ||
+        !section_fits(header.vehicles_offset, header.num_vehicles * sizeof(VehicleRecord), file_size) ||
+        !section_fits(header.locations_offset, header.num_nodes * sizeof(LocationId), file_size) ||
+        !section_fits(header.matrix_offset, header.matrix_bytes, file_size)) {
+        spdlog::warn("Ignoring malformed instance cache {}", cache_path);
+        return std::nullopt;
+    }
+
+    std::string name(reinterpret_cast<const char *>(base + header.name_offset), header.name_length);
+
+    std::vector<Node> nodes;
+    nodes.reserve(header.num_nodes);
+    for (size_t i = 0; i < header.num_nodes; ++i) {
+        auto record = read_record<NodeRecord>(base, header.nodes_offset, i);
+        if (record.node_type > static_cast<uint32_t>(NodeType::Delivery)) {
+            return std::nullopt;
+        }
+        nodes.emplace_back(record.id, record.oid, record.gid,
+                           static_cast<NodeType>(record.node_type),
+                           record.x, record.y, static_cast<Capacity>(record.demand),
+                           record.ready, record.due, record.servicetime);
+    }
+
+    std::vector<Vehicle> vehicles;
+    vehicles.reserve(header.num_vehicles);
+    for (size_t i = 0; i < header.num_vehicles; ++i) {
+        auto record = read_record<VehicleRecord>(base, header.vehicles_offset, i);
+        vehicles.emplace_back(static_cast<Capacity>(record.seats), record.shift_length);
+    }
+
+    std::vector<LocationId> locations(header.num_nodes);
+    std::memcpy(locations.data(), base + header.locations_offset,
+                header.num_nodes * sizeof(LocationId));
+
+    try {
+        // Ma trận trỏ thẳng vào vùng mmap, file được giữ mở qua owner
+        auto matrix = std::make_shared<TravelMatrix>(TravelMatrix::borrow(
+            header.matrix_size, storage, base + header.matrix_offset, file));
+        // Traits đã tính lúc ghi cache: instance không phải quét lại ma trận
+        MatrixTraits matrix_traits;
+        matrix_traits.symmetric = header.matrix_symmetric != 0;
+        matrix_traits.time_equals_distance = header.matrix_time_equals_distance != 0;
+        matrix->set_traits(matrix_traits);
+        return PDPTWInstance(std::move(name), header.num_requests, header.num_vehicles,
+                             std::move(nodes), std::move(vehicles), std::move(matrix),
+                             std::move(locations));
+    } catch (const std::exception &e) {
+        spdlog::warn("Ignoring inconsistent instance cache {}: {}", cache_path, e.what());
+        return std::nullopt;
+    }
+}
+
+PDPTWInstance load_instance_with_cache(
+    const std::string &source_path,
+    const std::string &cache_dir,
+    size_t max_vehicles,
+    const std::function<PDPTWInstance()> &parse) {
+
+    uint64_t source_hash = hash_file(source_path);
+    std::string cache_path = instance_cache_path(cache_dir, source_path, source_hash, max_vehicles);
+
+    if (auto cached = load_instance_cache(cache_path, source_hash, max_vehicles)) {
+        spdlog::info("Loaded preprocessed instance from cache: {}", cache_path);
+        // mtime = lần dùng gần nhất, để bên dọn cache (backend) xoá theo LRU
+        std::error_code ec;
+        fs::last_write_time(cache_path, fs::file_time_type::clock::now(), ec);
+        return std::move(*cached);
+    }
+
+    PDPTWInstance instance = parse();
+
+    try {
+        std::error_code ec;
+        fs::create_directories(cache_dir, ec);
+        write_instance_cache(cache_path, instance, source_hash, max_vehicles);
+        spdlog::info("Wrote instance cache: {}", cache_path);
+    } catch (const std::exception &e) {
+        spdlog::warn("Cannot write instance cache: {}", e.what());
+    }
+
+    return instance;
+}
+
+} // namespace pdptw::io
@@ -2,6 +2,7 @@
 #include "pdptw/problem/travel_matrix.hpp"
 #include <cmath>
 #include <fstream>
+#include <spdlog/spdlog.h>
 #include <sstream>
 #include <stdexcept>
 
@@ -121,22 +122,38 @@ static std::vector<Node> transform_nodes(
     return nodes;
 }
 
+// Ma trận theo địa điểm trong file (task 0..n), không theo node đã nhân bản depot
 static std::shared_ptr<TravelMatrix> create_travel_matrix(
-    const std::vector<Node> &nodes) {
-
-    auto matrix = std::make_shared<TravelMatrix>(nodes.size());
+    const std::vector<IONode> &locations) {
+
+    auto euclidean = [&](size_t i, size_t j) {
+        double dx = locations[i].x - locations[j].x;
+        double dy = locations[i].y - locations[j].y;
+        return std::sqrt(dx * dx + dy * dy);
+    };
+
+    // Time == distance nên luôn dùng chung một mảng; độ chính xác chọn theo giá trị thực tế
+    MatrixStorageDetector detector;
+    for (size_t i = 0; i < locations.size(); ++i) {
+        for (size_t j = 0; j < locations.size(); ++j) {
+            double dist = euclidean(i, j);
+            detector.observe(dist, dist);
+        }
+    }
 
-    for (size_t i = 0; i < nodes.size(); ++i) {
-        for (size_t j = 0; j < nodes.size(); ++j) {
-            double dx = nodes[i].x() - nodes[j].x();
-            double dy = nodes[i].y() - nodes[j].y();
-            double dist = std::sqrt(dx * dx + dy * dy);
+    auto matrix = std::make_shared<TravelMatrix>(locations.size(), detector.storage());
 
-            matrix->set_distance(i, j, dist);
-            matrix->set_time(i, j, dist);
+    for (size_t i = 0; i < locations.size(); ++i) {
+        for (size_t j = 0; j < locations.size(); ++j) {
+            double dist = euclidean(i, j);
+            matrix->set_arc(i, j, dist, dist);
         }
     }
 
+    spdlog::info("Travel matrix {}x{}: {} ({:.1f} MiB)",
+                 matrix->size(), matrix->size(), to_string(matrix->storage()),
+                 matrix->memory_bytes() / (1024.0 * 1024.0));
+
     return matrix;
 }
 
@@ -179,7 +196,13 @@ PDPTWInstance load_li_lim_instance(
 
     std::vector<Node> nodes = transform_nodes(io_nodes, num_vehicles);
 
-    auto travel_matrix = create_travel_matrix(nodes);
+    auto travel_matrix = create_travel_matrix(io_nodes);
+
+    // Node -> địa điểm: oid chính là chỉ số task trong file (depot = 0)
+    std::vector<LocationId> node_locations(nodes.size());
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        node_locations[i] = static_cast<LocationId>(nodes[i].oid());
+    }
 
     std::string instance_name = filepath;
     size_t last_slash = filepath.find_last_of("/\\");
@@ -197,7 +220,8 @@ PDPTWInstance load_li_lim_instance(
         num_requests,
         vehicles,
         nodes,
-        travel_matrix);
+        travel_matrix,
+        std::move(node_locations));
 }
 
 } // namespace pdptw::io
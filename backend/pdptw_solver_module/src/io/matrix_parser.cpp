@@ -0,0 +1,154 @@
+#include "pdptw/io/matrix_parser.hpp"
+
+#include <atomic>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif
+
+namespace pdptw::io {
+
+using namespace pdptw::problem;
+
+namespace {
+
+// Mỗi hàng được giới hạn bởi [row_begin[i], row_begin[i + 1]) nên '\n' cuối hàng cũng là khoảng trắng
+inline bool is_blank(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// Bỏ khoảng trắng và dấu '+' đứng đầu (istringstream chấp nhận, from_chars thì không)
+inline const char *skip_to_value(const char *p, const char *end) {
+    while (p < end && is_blank(*p)) {
+        ++p;
+    }
+    if (p < end && *p == '+') {
+        ++p;
+    }
+    return p;
+}
+
+// Parse một hàng toàn số nguyên không âm vừa uint32. false nếu gặp giá trị khác
+bool parse_row_uint32(const char *p, const char *end, size_t size, uint32_t *out) {
+    for (size_t j = 0; j < size; ++j) {
+        p = skip_to_value(p, end);
+        auto [next, ec] = std::from_chars(p, end, out[j]);
+        if (ec != std::errc{} || (next < end && !is_blank(*next))) {
+            return false;
+        }
+        p = next;
+    }
+    return true;
+}
+
+// Parse một hàng số thực. Trả về chỉ số cột lỗi, hoặc size nếu thành công
+size_t parse_row_double(const char *p, const char *end, size_t size, double *out,
+                        MatrixStorageDetector &detector) {
+    for (size_t j = 0; j < size; ++j) {
+        p = skip_to_value(p, end);
+        auto [next, ec] = std::from_chars(p, end, out[j]);
+        if (ec != std::errc{} || (next < end && !is_blank(*next))) {
+            return j;
+        }
+        detector.observe(out[j], out[j]);
+        p = next;
+    }
+    return size;
+}
+
+// Ghi nhận ô lỗi nhỏ nhất (theo thứ tự hàng, cột) để thông báo lỗi không phụ thuộc số thread
+void record_error(std::atomic<size_t> &first_error, size_t cell) {
+    size_t current = first_error.load(std::memory_order_relaxed);
+    while (cell < current &&
+           !first_error.compare_exchange_weak(current, cell, std::memory_order_relaxed)) {
+    }
+}
+
+} // namespace
+
+MatrixParseResult parse_square_matrix(const char *begin, const char *end, size_t size) {
+    // Xác định đầu mỗi hàng (mỗi hàng một dòng) bằng memchr, sau đó các hàng độc lập nhau
+    std::vector<const char *> row_begin(size + 1);
+    const char *p = begin;
+    for (size_t i = 0; i < size; ++i) {
+        if (p >= end) {
+            throw std::runtime_error("Unexpected EOF reading edges");
+        }
+        row_begin[i] = p;
+        const void *newline = std::memchr(p, '\n', static_cast<size_t>(end - p));
+        p = newline ? static_cast<const char *>(newline) + 1 : end;
+    }
+    row_begin[size] = p;
+
+    // OpenMP (MSVC) yêu cầu biến vòng lặp kiểu có dấu
+    const int num_rows = static_cast<int>(size);
+
+    // Lượt 1: đa số instance (Sartori) là ma trận nguyên -> ghi thẳng vào storage uint32
+    MatrixStorage integer_storage{MatrixPrecision::UInt32, true};
+    auto matrix = std::make_shared<TravelMatrix>(size, integer_storage);
+    auto *cells = reinterpret_cast<uint32_t *>(matrix->mutable_data());
+    std::atomic<bool> all_integer{true};
+
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (int i = 0; i < num_rows; ++i) {
+        if (!all_integer.load(std::memory_order_relaxed)) {
+            continue;
+        }
+        if (!parse_row_uint32(row_begin[i], row_begin[i + 1], size, cells + size_t(i) * size)) {
+            all_integer.store(false, std::memory_order_relaxed);
+        }
+    }
+
+    if (all_integer.load()) {
+        return MatrixParseResult{std::move(matrix), row_begin[size]};
+    }
+
+    // Lượt 2: parse float64, sau đó thu gọn tại chỗ về chế độ nhỏ nhất còn chính xác
+    matrix = std::make_shared<TravelMatrix>(size, MatrixStorage{MatrixPrecision::Float64, true});
+    auto *values = reinterpret_cast<double *>(matrix->mutable_data());
+    std::atomic<size_t> first_error{std::numeric_limits<size_t>::max()};
+    MatrixStorageDetector detector;
+
+#ifdef USE_OPENMP
+#pragma omp parallel
+#endif
+    {
+        MatrixStorageDetector local_detector;
+
+#ifdef USE_OPENMP
+#pragma omp for schedule(static) nowait
+#endif
+        for (int i = 0; i < num_rows; ++i) {
+            size_t column = parse_row_double(row_begin[i], row_begin[i + 1], size,
+                                             values + size_t(i) * size, local_detector);
+            if (column != size) {
+                record_error(first_error, size_t(i) * size + column);
+            }
+        }
+
+#ifdef USE_OPENMP
+#pragma omp critical
+#endif
+        detector.merge(local_detector);
+    }
+
+    size_t error = first_error.load();
+    if (error != std::numeric_limits<size_t>::max()) {
+        throw std::runtime_error("Failed to parse edge value at " + std::to_string(error / size) +
+                                 "," + std::to_string(error % size));
+    }
+
+    matrix->narrow_to(detector.storage().precision);
+    return MatrixParseResult{std::move(matrix), row_begin[size]};
+}
+
+} // namespace pdptw::io
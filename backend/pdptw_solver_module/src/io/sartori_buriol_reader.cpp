@@ -1,9 +1,12 @@
 #include "pdptw/io/sartori_buriol_reader.hpp"
+#include "pdptw/io/matrix_parser.hpp"
 #include "pdptw/problem/travel_matrix.hpp"
+#include "pdptw/utils/mapped_file.hpp"
 #include <algorithm>
 #include <cmath>
-#include <fstream>
+#include <cstring>
 #include <iostream>
+#include <spdlog/spdlog.h>
 #include <sstream>
 #include <stdexcept>
 #include <string>
@@ -22,6 +25,33 @@ struct IONode {
     size_t p, d;
 };
 
+// Đọc từng dòng trên buffer của file đã mmap (thay cho std::getline trên ifstream)
+class LineReader {
+public:
+    LineReader(const char *begin, const char *end) : pos_(begin), end_(end) {}
+
+    bool getline(std::string &line) {
+        if (pos_ >= end_) {
+            return false;
+        }
+        const void *newline = std::memchr(pos_, '\n', static_cast<size_t>(end_ - pos_));
+        const char *line_end = newline ? static_cast<const char *>(newline) : end_;
+        line.assign(pos_, line_end);
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        pos_ = newline ? line_end + 1 : end_;
+        return true;
+    }
+
+    const char *position() const { return pos_; }
+    const char *end() const { return end_; }
+
+private:
+    const char *pos_;
+    const char *end_;
+};
+
 // Helper to parse "KEY: VALUE"
 static std::string parse_property(const std::string &line) {
     size_t colon_pos = line.find(':');
@@ -41,10 +71,10 @@ problem::PDPTWInstance load_sartori_buriol_instance(
     const std::string &filepath,
     size_t max_vehicles) {
 
-    std::ifstream file(filepath);
-    if (!file.is_open()) {
-        throw std::runtime_error("Cannot open file: " + filepath);
-    }
+    // Đọc cả file một lần qua mmap; ma trận EDGES được parse trực tiếp trên buffer này
+    auto mapped = utils::MappedFile::open(filepath);
+    const char *text = reinterpret_cast<const char *>(mapped->data());
+    LineReader file(text, text + mapped->size());
 
     std::string line;
     size_t num_nodes = 0;
@@ -53,20 +83,20 @@ problem::PDPTWInstance load_sartori_buriol_instance(
 
     // Read properties
     // 1. NAME
-    if (!std::getline(file, line))
+    if (!file.getline(line))
         throw std::runtime_error("Unexpected EOF");
     // 2. LOCATION
-    if (!std::getline(file, line))
+    if (!file.getline(line))
         throw std::runtime_error("Unexpected EOF");
     // 3. COMMENT
-    if (!std::getline(file, line))
+    if (!file.getline(line))
         throw std::runtime_error("Unexpected EOF");
     // 4. TYPE
-    if (!std::getline(file, line))
+    if (!file.getline(line))
         throw std::runtime_error("Unexpected EOF");
 
     // 5. SIZE
-    if (!std::getline(file, line))
+    if (!file.getline(line))
         throw std::runtime_error("Unexpected EOF");
     std::string size_str = parse_property(line);
     if (size_str.empty())
@@ -74,14 +104,14 @@ problem::PDPTWInstance load_sartori_buriol_instance(
     num_nodes = std::stoul(size_str);
 
     // 6. DISTRIBUTION
-    if (!std::getline(file, line))
+    if (!file.getline(line))
         throw std::runtime_error("Unexpected EOF");
     // 7. DEPOT
-    if (!std::getline(file, line))
+    if (!file.getline(line))
         throw std::runtime_error("Unexpected EOF");
 
     // 8. ROUTE-TIME
-    if (!std::getline(file, line))
+    if (!file.getline(line))
         throw std::runtime_error("Unexpected EOF");
     std::string rt_str = parse_property(line);
     if (rt_str.empty())
@@ -89,11 +119,11 @@ problem::PDPTWInstance load_sartori_buriol_instance(
     route_time = std::stoul(rt_str);
 
     // 9. TIME-WINDOW
-    if (!std::getline(file, line))
+    if (!file.getline(line))
         throw std::runtime_error("Unexpected EOF");
 
     // 10. CAPACITY
-    if (!std::getline(file, line))
+    if (!file.getline(line))
         throw std::runtime_error("Unexpected EOF");
     std::string cap_str = parse_property(line);
     if (cap_str.empty())
@@ -101,7 +131,7 @@ problem::PDPTWInstance load_sartori_buriol_instance(
     capacity = std::stoul(cap_str);
 
     // Read NODES header
-    if (!std::getline(file, line))
+    if (!file.getline(line))
         throw std::runtime_error("Unexpected EOF");
     if (line.find("NODES") == std::string::npos) {
         throw std::runtime_error("Expected NODES line, got: " + line);
@@ -111,7 +141,7 @@ problem::PDPTWInstance load_sartori_buriol_instance(
     io_nodes.reserve(num_nodes);
 
     for (size_t i = 0; i < num_nodes; ++i) {
-        if (!std::getline(file, line))
+        if (!file.getline(line))
             throw std::runtime_error("Unexpected EOF reading nodes");
         std::istringstream iss(line);
         IONode node;
@@ -122,24 +152,15 @@ problem::PDPTWInstance load_sartori_buriol_instance(
     }
 
     // Read EDGES header
-    if (!std::getline(file, line))
+    if (!file.getline(line))
         throw std::runtime_error("Unexpected EOF");
     if (line.find("EDGES") == std::string::npos) {
         throw std::runtime_error("Expected EDGES line, got: " + line);
     }
 
-    // Read matrix (SIZE x SIZE)
-    std::vector<std::vector<double>> raw_matrix(num_nodes, std::vector<double>(num_nodes));
-    for (size_t i = 0; i < num_nodes; ++i) {
-        if (!std::getline(file, line))
-            throw std::runtime_error("Unexpected EOF reading edges");
-        std::istringstream iss(line);
-        for (size_t j = 0; j < num_nodes; ++j) {
-            if (!(iss >> raw_matrix[i][j])) {
-                throw std::runtime_error("Failed to parse edge value at " + std::to_string(i) + "," + std::to_string(j));
-            }
-        }
-    }
+    // Read matrix (SIZE x SIZE): parse song song thẳng vào storage cuối cùng của TravelMatrix
+    // Sartori: time == distance, ma trận được đánh chỉ số theo địa điểm (không nhân bản depot theo số xe)
+    auto travel_matrix = parse_square_matrix(file.position(), file.end(), num_nodes).matrix;
 
     // Determine number of vehicles
     size_t actual_vehicles = max_vehicles;
@@ -220,9 +241,6 @@ problem::PDPTWInstance load_sartori_buriol_instance(
             d_node.service_time);
     }
 
-    // Create Travel Matrix
-    auto travel_matrix = std::make_shared<TravelMatrix>(nodes.size());
-
     // Map internal node index -> IO node index
     auto get_io_id = [&](size_t internal_id) -> size_t {
         if (internal_id < 2 * actual_vehicles) {
@@ -240,17 +258,17 @@ problem::PDPTWInstance load_sartori_buriol_instance(
         }
     };
 
+    // Node -> địa điểm (hàng/cột của ma trận EDGES)
+    std::vector<LocationId> node_locations(nodes.size());
     for (size_t i = 0; i < nodes.size(); ++i) {
-        for (size_t j = 0; j < nodes.size(); ++j) {
-            size_t u = get_io_id(i);
-            size_t v = get_io_id(j);
-            double val = raw_matrix[u][v];
-
-            travel_matrix->set_distance(i, j, val);
-            travel_matrix->set_time(i, j, val);
-        }
+        node_locations[i] = static_cast<LocationId>(get_io_id(i));
     }
 
+    spdlog::info("Travel matrix {}x{}: {} ({:.1f} MiB)",
+                 travel_matrix->size(), travel_matrix->size(),
+                 to_string(travel_matrix->storage()),
+                 travel_matrix->memory_bytes() / (1024.0 * 1024.0));
+
     // Extract instance name from path
     std::string instance_name = filepath;
     size_t last_slash = filepath.find_last_of("/\\");
@@ -266,7 +284,8 @@ problem::PDPTWInstance load_sartori_buriol_instance(
         num_requests,
         vehicles,
         nodes,
-        travel_matrix);
+        travel_matrix,
+        std::move(node_locations));
 }
 
 } // namespace pdptw::io
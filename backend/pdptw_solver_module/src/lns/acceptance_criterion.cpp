@@ -6,10 +6,12 @@ namespace lns {
 
 AcceptanceCriterion::AcceptanceCriterion(
     AcceptanceType type,
-    double initial_temperature)
+    double initial_temperature,
+    unsigned seed)
     : type_(type),
       temperature_(initial_temperature),
-      initial_temperature_(initial_temperature) {
+      initial_temperature_(initial_temperature),
+      rng_(seed) {
 }
 
 bool AcceptanceCriterion::should_accept(
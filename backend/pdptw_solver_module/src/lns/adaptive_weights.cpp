@@ -0,0 +1,71 @@
+#include "pdptw/lns/adaptive_weights.hpp"
+#include <algorithm>
+
+namespace pdptw {
+namespace lns {
+
+AdaptiveOperatorWeights::AdaptiveOperatorWeights(size_t num_operators, const AdaptiveWeightsParams &params)
+    : params_(params),
+      weights_(num_operators, 1.0),
+      segment_improvement_(num_operators, 0.0),
+      segment_ms_(num_operators, 0.0),
+      segment_used_(num_operators, 0) {
+}
+
+size_t AdaptiveOperatorWeights::select(std::mt19937 &rng) const {
+    double total = 0.0;
+    for (double w : weights_) {
+        total += w;
+    }
+
+    std::uniform_real_distribution<double> dist(0.0, total);
+    double r = dist(rng);
+    double cumulative = 0.0;
+    for (size_t i = 0; i < weights_.size(); ++i) {
+        cumulative += weights_[i];
+        if (r < cumulative) {
+            return i;
+        }
+    }
+    return weights_.size() - 1;
+}
+
+void AdaptiveOperatorWeights::record(size_t op, double improvement, double elapsed_ms) {
+    segment_improvement_[op] += std::max(0.0, improvement);
+    segment_ms_[op] += elapsed_ms;
+    segment_used_[op]++;
+
+    if (++segment_records_ >= params_.segment_length) {
+        end_segment();
+    }
+}
+
+void AdaptiveOperatorWeights::end_segment() {
+    // Reward = cải thiện mỗi ms (sàn 1 µs để iteration quá nhanh không chia cho 0)
+    std::vector<double> reward(weights_.size(), 0.0);
+    double max_reward = 0.0;
+    for (size_t i = 0; i < weights_.size(); ++i) {
+        if (segment_used_[i] > 0) {
+            reward[i] = segment_improvement_[i] / std::max(segment_ms_[i], 1e-3);
+            max_reward = std::max(max_reward, reward[i]);
+        }
+    }
+
+    if (max_reward > 0.0) {
+        for (size_t i = 0; i < weights_.size(); ++i) {
+            if (segment_used_[i] > 0) {
+                double w = (1.0 - params_.reaction) * weights_[i] + params_.reaction * reward[i] / max_reward;
+                weights_[i] = std::clamp(w, params_.min_weight, 1.0);
+            }
+        }
+    }
+
+    std::fill(segment_improvement_.begin(), segment_improvement_.end(), 0.0);
+    std::fill(segment_ms_.begin(), segment_ms_.end(), 0.0);
+    std::fill(segment_used_.begin(), segment_used_.end(), 0);
+    segment_records_ = 0;
+    segments_++;
+}
+
+} // namespace lns
+} // namespace pdptw
@@ -6,12 +6,13 @@ namespace pdptw {
 namespace lns {
 
 AbsenceRemovalOperator::AbsenceRemovalOperator(AbsenceCounter &counter)
-    : absence_counter_(counter), rng_(std::random_device{}()) {
+    : absence_counter_(counter) {
 }
 
 void AbsenceRemovalOperator::destroy(
     solution::Solution &solution,
-    size_t num_to_remove) {
+    size_t num_to_remove,
+    std::mt19937 &rng) {
 
     const auto &instance = solution.instance();
 
@@ -37,7 +38,7 @@ void AbsenceRemovalOperator::destroy(
     size_t removed_count = 0;
 
     while (removed_count < num_to_remove && !request_absence.empty()) {
-        double y = std::pow(dist(rng_), randomization_factor_);
+        double y = std::pow(dist(rng), randomization_factor_);
         size_t index = static_cast<size_t>(y * request_absence.size());
         index = std::min(index, request_absence.size() - 1);
 
@@ -5,8 +5,7 @@
 namespace pdptw {
 namespace lns {
 
-AdjacentStringRemovalOperator::AdjacentStringRemovalOperator()
-    : rng_(std::random_device{}()) {
+AdjacentStringRemovalOperator::AdjacentStringRemovalOperator() {
 }
 
 problem::Num AdjacentStringRemovalOperator::relatedness(
@@ -35,7 +34,8 @@ problem::Num AdjacentStringRemovalOperator::relatedness(
 
 void AdjacentStringRemovalOperator::destroy(
     solution::Solution &solution,
-    size_t num_to_remove) {
+    size_t num_to_remove,
+    std::mt19937 &rng) {
 
     const auto &instance = solution.instance();
 
@@ -51,7 +51,7 @@ void AdjacentStringRemovalOperator::destroy(
     }
 
     std::uniform_int_distribution<size_t> seed_dist(0, assigned_requests.size() - 1);
-    size_t seed_idx = seed_dist(rng_);
+    size_t seed_idx = seed_dist(rng);
     size_t seed_request = assigned_requests[seed_idx];
 
     std::vector<std::pair<size_t, problem::Num>> relatedness_list;
@@ -76,7 +76,7 @@ void AdjacentStringRemovalOperator::destroy(
     double randomization_factor = 6.0;
 
     while (removed_count < num_to_remove && !relatedness_list.empty()) {
-        double y = std::pow(dist(rng_), randomization_factor);
+        double y = std::pow(dist(rng), randomization_factor);
         size_t index = static_cast<size_t>(y * relatedness_list.size());
         index = std::min(index, relatedness_list.size() - 1);
 
@@ -4,13 +4,13 @@
 namespace pdptw {
 namespace lns {
 
-RouteRemovalOperator::RouteRemovalOperator()
-    : rng_(std::random_device{}()) {
+RouteRemovalOperator::RouteRemovalOperator() {
 }
 
 void RouteRemovalOperator::destroy(
     solution::Solution &solution,
-    size_t num_to_remove) {
+    size_t num_to_remove,
+    std::mt19937 &rng) {
 
     const auto &instance = solution.instance();
     size_t num_vehicles = instance.num_vehicles();
@@ -30,7 +30,7 @@ void RouteRemovalOperator::destroy(
         return;
     }
 
-    std::shuffle(non_empty_routes.begin(), non_empty_routes.end(), rng_);
+    std::shuffle(non_empty_routes.begin(), non_empty_routes.end(), rng);
 
     size_t removed_count = 0;
 
@@ -5,8 +5,7 @@
 namespace pdptw {
 namespace lns {
 
-WorstRemovalOperator::WorstRemovalOperator()
-    : rng_(std::random_device{}()) {
+WorstRemovalOperator::WorstRemovalOperator() {
 }
 
 std::vector<std::pair<size_t, problem::Num>> WorstRemovalOperator::calculate_contributions(
@@ -48,7 +47,8 @@ std::vector<std::pair<size_t, problem::Num>> WorstRemovalOperator::calculate_con
 
 void WorstRemovalOperator::destroy(
     solution::Solution &solution,
-    size_t num_to_remove) {
+    size_t num_to_remove,
+    std::mt19937 &rng) {
 
     auto contributions = calculate_contributions(solution);
 
@@ -65,7 +65,7 @@ void WorstRemovalOperator::destroy(
 
     size_t removed_count = 0;
     while (removed_count < num_to_remove && !contributions.empty()) {
-        double y = std::pow(dist(rng_), randomization_factor_);
+        double y = std::pow(dist(rng), randomization_factor_);
         size_t index = static_cast<size_t>(y * contributions.size());
         index = std::min(index, contributions.size() - 1);
 
@@ -63,7 +63,7 @@ FleetMinimizationResult FleetMinimizationLNS::run(
 
         // Destroy phase: xóa một số requests khỏi solution
         size_t num_destroy = sample_destroy_count(rng);
-        destroy_op.destroy(initial_solution, num_destroy);
+        destroy_op.destroy(initial_solution, num_destroy, rng);
 
         // Repair phase: chèn lại các requests đã xóa
         repair_op.repair(initial_solution, rng);
@@ -53,7 +53,7 @@ solution::Solution DecompositionLNSSolver::run(solution::Solution current,
         spdlog::info("[LS-LNS] Iteration {}: solving {} partial instances", iteration, partials.size());
 
         for (auto &partial : partials) {
-            pdptw::LNSSolver solver(partial.instance, nested_params);
+            pdptw::LNSSolver solver(*partial.instance, nested_params);
             partial.initial_solution = solver.solve(partial.initial_solution);
         }
 
@@ -22,7 +22,7 @@ void AbsenceBasedRegretOperator::repair(solution::Solution &solution, const Abse
         if (unassigned.empty())
             break;
 
-        auto candidates = pdptw::construction::Insertion::calculate_regret(solution, unassigned, k);
+        auto candidates = insertion_cache().calculate_regret(solution, unassigned, k);
 
         if (candidates.empty())
             break;
@@ -40,7 +40,7 @@ void AbsenceBasedRegretOperator::repair(solution::Solution &solution, const Abse
 
             size_t pickup_id = solution.instance().pickup_id_of_request(max_weighted_it->request_id);
             bank.remove(pickup_id);
-            progress = true;
+            progress = !exceeds_cost_cutoff(solution);
         } else {
             break;
         }
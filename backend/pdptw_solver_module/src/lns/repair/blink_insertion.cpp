@@ -0,0 +1,79 @@
+#include "pdptw/lns/repair/blink_insertion.hpp"
+#include "pdptw/lns/repair/greedy_insertion.hpp"
+#include <algorithm>
+#include <random>
+
+namespace pdptw {
+namespace lns {
+namespace repair {
+
+BlinkInsertionOperator::BlinkInsertionOperator(double blink_rate)
+    : blink_rate_(std::clamp(blink_rate, 0.0, 1.0)) {}
+
+const construction::InsertionCandidate *BlinkInsertionOperator::pick_with_blinks(
+    solution::Solution &solution, size_t request_id, construction::InsertionStats &stats, Random &rng) {
+    using construction::InsertionCache;
+    if (blink_rate_ >= 1.0) {
+        return nullptr;
+    }
+
+    // Mỗi vị trí bị blink độc lập, nên vị trí rẻ nhất còn lại là vị trí thứ rank theo cost với
+    // rank = số lần blink liên tiếp từ vị trí rẻ nhất (phân phối hình học): một lần rút ngẫu
+    // nhiên cho mỗi request. Blink vị trí không khả thi không đổi kết quả.
+    const size_t rank = blink_rate_ > 0.0 ? std::geometric_distribution<size_t>(1.0 - blink_rate_)(rng) : 0;
+    auto &cache = insertion_cache();
+    if (rank < InsertionCache::kRouteTopK) {
+        // top-k toàn cục nằm trong top-k của từng route mà cache đang giữ
+        top_.reset(InsertionCache::kRouteTopK);
+        cache.find_top_insertions(solution, request_id, top_, InsertionCache::RouteScope::NonEmpty);
+        return rank < top_.size() ? &top_[rank] : nullptr;
+    }
+
+    // Hiếm (xác suất blink_rate^kRouteTopK): vị trí có thể nằm ngoài top-k của route nên quét đủ
+    candidates_.clear();
+    for (size_t v = 0; v < solution.instance().num_vehicles(); ++v) {
+        if (!solution.is_route_empty(v)) {
+            construction::Insertion::find_insertions_in_route(solution, request_id, v, candidates_, &stats,
+                                                              cache.granular());
+        }
+    }
+    if (rank >= candidates_.size()) {
+        return nullptr;
+    }
+    std::nth_element(candidates_.begin(), candidates_.begin() + rank, candidates_.end(),
+                     [](const auto &a, const auto &b) { return a.cost_increase < b.cost_increase; });
+    return &candidates_[rank];
+}
+
+void BlinkInsertionOperator::repair(solution::Solution &solution, Random &rng) {
+    auto &bank = solution.unassigned_requests();
+    if (bank.count() == 0)
+        return;
+
+    construction::InsertionStats stats;
+    for (size_t request_id : sort_unassigned_customers(solution, rng)) {
+        const construction::InsertionCandidate *best = pick_with_blinks(solution, request_id, stats, rng);
+
+        if (!best) {
+            // Mở route rỗng: entry của mỗi vehicle class (như find_top_insertions), chọn vị trí rẻ
+            // nhất không blink để request không bị bỏ lại khi vẫn có route vừa
+            top_.reset(1);
+            insertion_cache().find_top_insertions(solution, request_id, top_,
+                                                  construction::InsertionCache::RouteScope::Empty);
+            best = top_.empty() ? nullptr : &top_[0];
+        }
+
+        if (best) {
+            construction::Insertion::insert_request(solution, *best); // Tự xoá request khỏi bank
+            if (exceeds_cost_cutoff(solution)) {
+                break;
+            }
+        }
+    }
+
+    insertion_cache().add_stats(stats);
+}
+
+} // namespace repair
+} // namespace lns
+} // namespace pdptw
@@ -29,18 +29,20 @@ void GreedyInsertionOperator::repair(solution::Solution &solution, Random &rng)
             if (!bank.contains(pickup_id))
                 continue;
 
-            auto candidate = pdptw::construction::Insertion::find_best_insertion(solution, request_id,
-                                                                                 pdptw::construction::InsertionStrategy::BestCost);
+            auto candidate = insertion_cache().find_best_insertion(solution, request_id);
             if (candidate.feasible) {
                 pdptw::construction::Insertion::insert_request(solution, candidate);
                 bank.remove(pickup_id);
                 progress = true;
-                continue;
+            } else {
+                find_first_empty_route_and_insert(solution, request_id, rng);
+                if (!bank.contains(pickup_id)) {
+                    progress = true;
+                }
             }
 
-            find_first_empty_route_and_insert(solution, request_id, rng);
-            if (!bank.contains(pickup_id)) {
-                progress = true;
+            if (exceeds_cost_cutoff(solution)) {
+                return;
             }
         }
     }
@@ -51,7 +53,7 @@ void GreedyInsertionOperator::repair(solution::Solution &solution, Random &rng)
     }
 }
 
-std::vector<size_t> GreedyInsertionOperator::sort_unassigned_customers(solution::Solution &solution, Random &rng) {
+std::vector<size_t> sort_unassigned_customers(const solution::Solution &solution, Random &rng) {
     auto requests = solution.unassigned_requests().iter_request_ids();
     if (requests.empty())
         return requests;
@@ -144,8 +146,8 @@ void GreedyInsertionOperator::find_first_empty_route_and_insert(solution::Soluti
     if (!bank.contains(pickup_id))
         return;
 
-    auto candidate = pdptw::construction::Insertion::find_best_insertion(solution, request_id,
-                                                                         pdptw::construction::InsertionStrategy::Sequential);
+    // Sequential và BestCost chọn cùng một vị trí
+    auto candidate = insertion_cache().find_best_insertion(solution, request_id);
     if (candidate.feasible) {
         pdptw::construction::Insertion::insert_request(solution, candidate);
         bank.remove(pickup_id);
@@ -30,12 +30,14 @@ void HardestFirstInsertionOperator::repair(solution::Solution &solution, const A
             continue;
         }
 
-        auto candidate = pdptw::construction::Insertion::find_best_insertion(
-            solution, request_id, pdptw::construction::InsertionStrategy::BestCost);
+        auto candidate = insertion_cache().find_best_insertion(solution, request_id);
 
         if (candidate.feasible) {
             pdptw::construction::Insertion::insert_request(solution, candidate);
             bank.remove(pickup_id);
+            if (exceeds_cost_cutoff(solution)) {
+                return;
+            }
         }
     }
 }
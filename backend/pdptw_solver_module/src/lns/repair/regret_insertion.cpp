@@ -1,6 +1,4 @@
 #include "pdptw/lns/repair/regret_insertion.hpp"
-#include "pdptw/construction/insertion.hpp"
-#include <algorithm>
 
 namespace pdptw {
 namespace lns {
@@ -11,37 +9,18 @@ void RegretInsertionOperator::repair(solution::Solution &solution, Random &rng)
     if (bank.count() == 0)
         return;
 
-    const size_t k = 2;
+    auto &cache = insertion_cache();
+    heap_.reset(solution, bank.iter_request_ids(), &cache);
 
-    bool progress = true;
-    while (bank.count() > 0 && progress) {
-        progress = false;
-
-        auto unassigned = bank.iter_request_ids();
-        if (unassigned.empty())
-            break;
-
-        auto candidates = pdptw::construction::Insertion::calculate_regret(solution, unassigned, k);
-
-        if (candidates.empty())
-            break;
-
-        auto max_regret_it = std::max_element(candidates.begin(), candidates.end(),
-                                              [](const pdptw::construction::InsertionCandidate &a,
-                                                 const pdptw::construction::InsertionCandidate &b) {
-                                                  return a.regret_value < b.regret_value;
-                                              });
-
-        if (max_regret_it != candidates.end() && max_regret_it->feasible) {
-            pdptw::construction::Insertion::insert_request(solution, *max_regret_it);
-
-            size_t pickup_id = solution.instance().pickup_id_of_request(max_regret_it->request_id);
-            bank.remove(pickup_id);
-            progress = true;
-        } else {
+    // Request có regret cao nhất không còn chỗ chèn (regret vô cùng) thì dừng như trước
+    while (!heap_.empty() && heap_.top().feasible) {
+        heap_.insert_top(solution); // insert_request tự xoá request khỏi bank
+        if (exceeds_cost_cutoff(solution)) {
             break;
         }
     }
+
+    cache.add_stats(heap_.stats());
 }
 
 } // namespace repair
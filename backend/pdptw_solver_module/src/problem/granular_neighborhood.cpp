@@ -0,0 +1,65 @@
+#include "pdptw/problem/granular_neighborhood.hpp"
+#include <algorithm>
+#include <utility>
+
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif
+
+namespace pdptw::problem {
+
+GranularNeighborhood::GranularNeighborhood(const PDPTWInstance &instance, size_t k)
+    : k_(k),
+      num_depot_nodes_(instance.num_vehicles() * 2),
+      neighbors_(instance.nodes().size()) {
+    const auto &nodes = instance.nodes();
+    const size_t num_nodes = nodes.size();
+
+    // Đi được from -> to mà không trễ due của to (bắt đầu sớm nhất tại from)
+    auto reachable = [&](NodeId from, NodeId to) {
+        return nodes[from].ready() + nodes[from].servicetime() + instance.time(from, to) <= nodes[to].due();
+    };
+
+    auto build = [&](NodeId i) {
+        std::vector<std::pair<Num, NodeId>> candidates;
+        candidates.reserve(num_nodes - num_depot_nodes_);
+        for (NodeId j = num_depot_nodes_; j < num_nodes; ++j) {
+            if (j == i || j == (i ^ 1) || (!reachable(i, j) && !reachable(j, i))) {
+                continue;
+            }
+            candidates.emplace_back(std::min(instance.distance(i, j), instance.distance(j, i)), j);
+        }
+
+        size_t keep = std::min(k_, candidates.size());
+        std::partial_sort(candidates.begin(), candidates.begin() + keep, candidates.end());
+
+        auto &list = neighbors_[i];
+        list.reserve(keep);
+        for (size_t c = 0; c < keep; ++c) {
+            list.push_back(candidates[c].second);
+        }
+        std::sort(list.begin(), list.end());
+    };
+
+#ifdef USE_OPENMP
+    // OpenMP requires signed integral type for loop variable
+    int first = static_cast<int>(num_depot_nodes_);
+    int last = static_cast<int>(num_nodes);
+
+#pragma omp parallel for schedule(dynamic, 16)
+    for (int i = first; i < last; ++i) {
+        build(static_cast<NodeId>(i));
+    }
+#else
+    for (NodeId i = num_depot_nodes_; i < num_nodes; ++i) {
+        build(i);
+    }
+#endif
+}
+
+bool GranularNeighborhood::is_neighbor(NodeId node_id, NodeId other) const {
+    const auto &list = neighbors_[node_id];
+    return std::binary_search(list.begin(), list.end(), other);
+}
+
+} // namespace pdptw::problem
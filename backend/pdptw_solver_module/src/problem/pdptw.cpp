@@ -22,23 +22,105 @@ Node::Node(NodeId id, size_t oid, size_t gid, NodeType node_type,
       ready_(ready), due_(due), servicetime_(servicetime) {}
 PDPTWInstance::PDPTWInstance(std::string name, size_t num_requests, size_t num_vehicles,
                              std::vector<Node> nodes, std::vector<Vehicle> vehicles,
-                             std::shared_ptr<TravelMatrix> travel_matrix)
+                             std::shared_ptr<TravelMatrix> travel_matrix,
+                             std::vector<LocationId> node_locations)
     : name_(std::move(name)), num_requests_(num_requests), num_vehicles_(num_vehicles),
       nodes_(std::move(nodes)), vehicles_(std::move(vehicles)),
-      travel_matrix_(std::move(travel_matrix)) {}
+      travel_matrix_(std::move(travel_matrix)),
+      node_locations_(std::move(node_locations)) {
+    if (node_locations_.empty()) {
+        node_locations_.resize(nodes_.size());
+        for (size_t i = 0; i < nodes_.size(); ++i) {
+            node_locations_[i] = static_cast<LocationId>(i);
+        }
+    }
+    if (node_locations_.size() != nodes_.size()) {
+        throw std::invalid_argument("node_locations must have one entry per node");
+    }
+    size_t matrix_size = travel_matrix_ ? travel_matrix_->size() : 0;
+    for (LocationId location : node_locations_) {
+        if (location >= matrix_size) {
+            throw std::out_of_range("Node location outside of TravelMatrix");
+        }
+    }
+    compute_vehicle_classes();
+    compute_traits();
+}
+
+void PDPTWInstance::compute_vehicle_classes() {
+    auto same_depot = [this](NodeId a, NodeId b) {
+        const Node &na = nodes_[a];
+        const Node &nb = nodes_[b];
+        return node_locations_[a] == node_locations_[b] && na.ready() == nb.ready() &&
+               na.due() == nb.due() && na.servicetime() == nb.servicetime();
+    };
+
+    vehicle_classes_.assign(num_vehicles_, 0);
+    num_vehicle_classes_ = 0;
+    std::vector<VehicleId> representatives;
+    const size_t known = std::min({num_vehicles_, vehicles_.size(), nodes_.size() / 2});
+
+    for (VehicleId v = 0; v < num_vehicles_; ++v) {
+        size_t cls = num_vehicle_classes_;
+        if (v < known) {
+            for (size_t c = 0; c < representatives.size(); ++c) {
+                VehicleId w = representatives[c];
+                if (w < known && vehicles_[v].seats() == vehicles_[w].seats() &&
+                    vehicles_[v].shift_length() == vehicles_[w].shift_length() &&
+                    same_depot(2 * v, 2 * w) && same_depot(2 * v + 1, 2 * w + 1)) {
+                    cls = c;
+                    break;
+                }
+            }
+        }
+        if (cls == num_vehicle_classes_) {
+            representatives.push_back(v);
+            ++num_vehicle_classes_;
+        }
+        vehicle_classes_[v] = cls;
+    }
+}
 
-Num PDPTWInstance::distance(NodeId from, NodeId to) const {
-    return travel_matrix_->get_distance(from, to);
+void PDPTWInstance::compute_traits() {
+    traits_ = InstanceTraits();
+
+    // Demand: pickup của request r là node 2V + 2r
+    long total_demand = 0;
+    for (size_t node = num_vehicles_ * 2; node + 1 < nodes_.size(); node += 2) {
+        total_demand += std::max<long>(0, nodes_[node].demand());
+    }
+    long min_seats = std::numeric_limits<long>::max();
+    for (const auto &vehicle : vehicles_) {
+        min_seats = std::min<long>(min_seats, vehicle.seats());
+    }
+    traits_.capacity_unbounded = !vehicles_.empty() && total_demand <= min_seats;
+
+    // Ma trận: cache trên TravelMatrix, chỉ quét ở instance đầu tiên dùng ma trận đó
+    if (!travel_matrix_ || travel_matrix_->size() == 0) {
+        return;
+    }
+    const MatrixTraits matrix_traits = travel_matrix_->traits();
+    traits_.symmetric = matrix_traits.symmetric;
+    traits_.time_equals_distance = matrix_traits.time_equals_distance;
 }
 
-Num PDPTWInstance::time(NodeId from, NodeId to) const {
-    return travel_matrix_->get_time(from, to);
+void PDPTWInstance::restrict_traits(const InstanceTraits &allowed) {
+    traits_.capacity_unbounded &= allowed.capacity_unbounded;
+    traits_.symmetric &= allowed.symmetric;
+    traits_.time_equals_distance &= allowed.time_equals_distance;
 }
 
-DistanceAndTime PDPTWInstance::distance_and_time(NodeId from, NodeId to) const {
-    return DistanceAndTime{
-        travel_matrix_->get_distance(from, to),
-        travel_matrix_->get_time(from, to)};
+std::string to_string(const InstanceTraits &traits) {
+    std::string out;
+    auto add = [&out](bool on, const char *name) {
+        if (on) {
+            out += out.empty() ? name : std::string(", ") + name;
+        }
+    };
+    add(traits.capacity_unbounded, "capacity unbounded");
+    add(traits.symmetric, "symmetric");
+    add(traits.time_equals_distance, "time == distance");
+    return out.empty() ? "none" : out;
 }
 
 const Vehicle &PDPTWInstance::vehicle_from_vn_id(NodeId vn_id) const {
@@ -103,7 +185,16 @@ PDPTWInstance create_instance_with(
     size_t num_requests,
     std::vector<Vehicle> vehicles,
     std::vector<Node> nodes,
-    std::shared_ptr<TravelMatrix> travel_matrix) {
+    std::shared_ptr<TravelMatrix> travel_matrix,
+    std::vector<LocationId> node_locations) {
+    // Thời gian di chuyển giữa hai node (qua địa điểm nếu có bảng ánh xạ)
+    auto travel_time = [&](size_t from, size_t to) {
+        if (node_locations.empty()) {
+            return travel_matrix->get_time(from, to);
+        }
+        return travel_matrix->get_time(node_locations.at(from), node_locations.at(to));
+    };
+
     for (size_t i = 0; i < num_requests; ++i) {
         size_t p_id = (num_vehicles * 2) + (i * 2);
         size_t d_id = p_id + 1;
@@ -113,8 +204,8 @@ PDPTWInstance create_instance_with(
         Num latest_departure = std::numeric_limits<Num>::lowest();
 
         for (size_t v_id = 0; v_id < vehicles.size(); ++v_id) {
-            Num travel_time_v_p = travel_matrix->get_time(v_id * 2, p_id);
-            Num travel_time_d_v = travel_matrix->get_time(d_id, v_id * 2 + 1);
+            Num travel_time_v_p = travel_time(v_id * 2, p_id);
+            Num travel_time_d_v = travel_time(d_id, v_id * 2 + 1);
 
             earliest_arrival = std::min(earliest_arrival,
                                         nodes[v_id * 2].ready() + travel_time_v_p);
@@ -127,7 +218,7 @@ PDPTWInstance create_instance_with(
         nodes[p_id].set_ready(new_ready);
 
         // Kiểm tra tính khả thi: pickup phải đến delivery kịp trước due time
-        Num tt = travel_matrix->get_time(p_id, d_id);
+        Num tt = travel_time(p_id, d_id);
         if (nodes[p_id].ready() > nodes[d_id].due() - tt) {
             spdlog::warn("p_id: {} không thể đến delivery kịp thời gian (rdy: {}, due: {}, tt: {})",
                          p_id, nodes[p_id].ready(), nodes[d_id].due(), tt);
@@ -154,7 +245,7 @@ PDPTWInstance create_instance_with(
 
     return PDPTWInstance(std::move(name), num_requests, num_vehicles,
                          std::move(nodes), std::move(vehicles),
-                         std::move(travel_matrix));
+                         std::move(travel_matrix), std::move(node_locations));
 }
 
 } // namespace pdptw::problem
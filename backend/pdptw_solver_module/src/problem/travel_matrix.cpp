@@ -1,39 +1,274 @@
 #include "pdptw/problem/travel_matrix.hpp"
+#include <cstring>
 #include <stdexcept>
 
 namespace pdptw::problem {
 
-TravelMatrix::TravelMatrix(size_t size)
-    : times_(size, std::vector<double>(size, 0.0)),
-      distances_(size, std::vector<double>(size, 0.0)),
-      size_(size) {}
+namespace {
 
-double TravelMatrix::get_time(size_t from, size_t to) const {
-    if (from >= size_ || to >= size_) {
-        throw std::out_of_range("Index out of range in TravelMatrix");
+size_t bytes_per_value(MatrixPrecision precision) {
+    return precision == MatrixPrecision::Float64 ? sizeof(double) : sizeof(uint32_t);
+}
+
+// Các bit của TravelMatrix::traits_
+constexpr uint8_t kTraitsKnown = 1;
+constexpr uint8_t kTraitsSymmetric = 2;
+constexpr uint8_t kTraitsTimeEqualsDistance = 4;
+
+uint8_t encode_traits(const MatrixTraits &traits) {
+    return kTraitsKnown | (traits.symmetric ? kTraitsSymmetric : 0) |
+           (traits.time_equals_distance ? kTraitsTimeEqualsDistance : 0);
+}
+
+} // namespace
+
+std::string to_string(const MatrixStorage &storage) {
+    std::string result;
+    switch (storage.precision) {
+    case MatrixPrecision::Float64:
+        result = "float64";
+        break;
+    case MatrixPrecision::Float32:
+        result = "float32";
+        break;
+    case MatrixPrecision::UInt32:
+        result = "uint32";
+        break;
     }
-    return times_[from][to];
+    result += storage.shared_time_distance ? ", shared time/distance" : ", separate time/distance";
+    return result;
 }
 
-double TravelMatrix::get_distance(size_t from, size_t to) const {
-    if (from >= size_ || to >= size_) {
-        throw std::out_of_range("Index out of range in TravelMatrix");
+MatrixStorage MatrixStorageDetector::storage() const {
+    MatrixStorage storage;
+    storage.shared_time_distance = shared_;
+    if (fits_uint32_) {
+        storage.precision = MatrixPrecision::UInt32;
+    } else if (fits_float_) {
+        storage.precision = MatrixPrecision::Float32;
+    } else {
+        storage.precision = MatrixPrecision::Float64;
     }
-    return distances_[from][to];
+    return storage;
 }
 
-void TravelMatrix::set_time(size_t from, size_t to, double time) {
+TravelMatrix::TravelMatrix(size_t size, MatrixStorage storage)
+    : buffer_(size * size * (storage.shared_time_distance ? 1 : 2) * bytes_per_value(storage.precision),
+              std::byte{0}),
+      size_(size),
+      lanes_(storage.shared_time_distance ? 1 : 2),
+      storage_(storage) {
+    data_ = buffer_.data();
+}
+
+TravelMatrix TravelMatrix::borrow(size_t size, MatrixStorage storage,
+                                  const std::byte *data, std::shared_ptr<const void> owner) {
+    // arc_as đọc trực tiếp qua con trỏ kiểu giá trị
+    if (reinterpret_cast<uintptr_t>(data) % bytes_per_value(storage.precision) != 0) {
+        throw std::invalid_argument("Borrowed TravelMatrix data is not aligned for " + to_string(storage));
+    }
+    TravelMatrix matrix;
+    matrix.size_ = size;
+    matrix.lanes_ = storage.shared_time_distance ? 1 : 2;
+    matrix.storage_ = storage;
+    matrix.owner_ = std::move(owner);
+    matrix.data_ = data;
+    return matrix;
+}
+
+TravelMatrix::TravelMatrix(const TravelMatrix &other)
+    : buffer_(other.buffer_),
+      owner_(other.owner_),
+      size_(other.size_),
+      lanes_(other.lanes_),
+      storage_(other.storage_),
+      traits_(other.traits_.load(std::memory_order_relaxed)) {
+    data_ = owner_ ? other.data_ : buffer_.data();
+}
+
+TravelMatrix::TravelMatrix(TravelMatrix &&other) noexcept
+    : buffer_(std::move(other.buffer_)),
+      owner_(std::move(other.owner_)),
+      data_(other.data_),
+      size_(other.size_),
+      lanes_(other.lanes_),
+      storage_(other.storage_),
+      traits_(other.traits_.load(std::memory_order_relaxed)) {
+    other.data_ = nullptr;
+    other.size_ = 0;
+    other.traits_.store(0, std::memory_order_relaxed);
+}
+
+TravelMatrix &TravelMatrix::operator=(const TravelMatrix &other) {
+    if (this != &other) {
+        TravelMatrix copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+TravelMatrix &TravelMatrix::operator=(TravelMatrix &&other) noexcept {
+    buffer_ = std::move(other.buffer_);
+    owner_ = std::move(other.owner_);
+    data_ = other.data_;
+    size_ = other.size_;
+    lanes_ = other.lanes_;
+    storage_ = other.storage_;
+    traits_.store(other.traits_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    other.data_ = nullptr;
+    other.size_ = 0;
+    other.traits_.store(0, std::memory_order_relaxed);
+    return *this;
+}
+
+size_t TravelMatrix::memory_bytes() const {
+    return size_ * size_ * lanes_ * bytes_per_value(storage_.precision);
+}
+
+std::byte *TravelMatrix::mutable_data() {
+    if (owner_) {
+        throw std::logic_error("Cannot modify a borrowed (read-only) TravelMatrix");
+    }
+    traits_.store(0, std::memory_order_relaxed);
+    return buffer_.data();
+}
+
+MatrixTraits TravelMatrix::traits() const {
+    uint8_t bits = traits_.load(std::memory_order_relaxed);
+    if (!(bits & kTraitsKnown)) {
+        bits = encode_traits(scan_traits());
+        traits_.store(bits, std::memory_order_relaxed);
+    }
+    return MatrixTraits{(bits & kTraitsSymmetric) != 0, (bits & kTraitsTimeEqualsDistance) != 0};
+}
+
+void TravelMatrix::set_traits(const MatrixTraits &traits) {
+    traits_.store(encode_traits(traits), std::memory_order_relaxed);
+}
+
+// Duyệt theo địa điểm; dừng sớm ở cung đầu tiên phá vỡ tính chất
+MatrixTraits TravelMatrix::scan_traits() const {
+    return with_matrix_precision(storage_.precision, [this](auto precision) {
+        constexpr MatrixPrecision P = decltype(precision)::value;
+        MatrixTraits traits;
+        traits.time_equals_distance = true;
+        if (!storage_.shared_time_distance) {
+            for (size_t i = 0; i < size_ && traits.time_equals_distance; ++i) {
+                for (size_t j = 0; j < size_ && traits.time_equals_distance; ++j) {
+                    TravelArc arc = arc_as<P>(i, j);
+                    traits.time_equals_distance = arc.distance == arc.time;
+                }
+            }
+        }
+        traits.symmetric = true;
+        for (size_t i = 0; i < size_ && traits.symmetric; ++i) {
+            for (size_t j = i + 1; j < size_ && traits.symmetric; ++j) {
+                TravelArc ij = arc_as<P>(i, j);
+                TravelArc ji = arc_as<P>(j, i);
+                traits.symmetric = ij.distance == ji.distance && ij.time == ji.time;
+            }
+        }
+        return traits;
+    });
+}
+
+void TravelMatrix::narrow_to(MatrixPrecision precision) {
+    if (precision == storage_.precision) {
+        return;
+    }
+    if (storage_.precision != MatrixPrecision::Float64) {
+        throw std::logic_error("TravelMatrix can only be narrowed from float64");
+    }
+    std::byte *bytes = mutable_data();
+    const size_t count = size_ * size_ * lanes_;
+
+    // Ghi 4 byte vào vị trí i trong khi đọc 8 byte từ vị trí i: vùng ghi luôn đứng trước vùng đọc
+    for (size_t i = 0; i < count; ++i) {
+        double value;
+        std::memcpy(&value, bytes + i * sizeof(double), sizeof(double));
+        if (precision == MatrixPrecision::Float32) {
+            float narrow = static_cast<float>(value);
+            std::memcpy(bytes + i * sizeof(float), &narrow, sizeof(float));
+        } else {
+            uint32_t fixed = static_cast<uint32_t>(value);
+            std::memcpy(bytes + i * sizeof(uint32_t), &fixed, sizeof(uint32_t));
+        }
+    }
+
+    // resize nhỏ lại không cấp phát: buffer giữ nguyên capacity của bản float64
+    storage_.precision = precision;
+    buffer_.resize(count * bytes_per_value(precision));
+    data_ = buffer_.data();
+}
+
+void TravelMatrix::check_bounds(size_t from, size_t to) const {
     if (from >= size_ || to >= size_) {
         throw std::out_of_range("Index out of range in TravelMatrix");
     }
-    times_[from][to] = time;
+}
+
+void TravelMatrix::store(size_t idx, double value) {
+    if (owner_) {
+        throw std::logic_error("Cannot modify a borrowed (read-only) TravelMatrix");
+    }
+    traits_.store(0, std::memory_order_relaxed);
+    std::byte *target = buffer_.data() + idx * bytes_per_value(storage_.precision);
+    switch (storage_.precision) {
+    case MatrixPrecision::Float64:
+        std::memcpy(target, &value, sizeof(double));
+        break;
+    case MatrixPrecision::Float32: {
+        float narrow = static_cast<float>(value);
+        if (static_cast<double>(narrow) != value) {
+            throw std::invalid_argument("Value not representable in float32 TravelMatrix: " +
+                                        std::to_string(value));
+        }
+        std::memcpy(target, &narrow, sizeof(float));
+        break;
+    }
+    case MatrixPrecision::UInt32: {
+        if (!(value >= 0.0 && value <= 4294967295.0) ||
+            static_cast<double>(static_cast<uint32_t>(value)) != value) {
+            throw std::invalid_argument("Value not representable in uint32 TravelMatrix: " +
+                                        std::to_string(value));
+        }
+        uint32_t fixed = static_cast<uint32_t>(value);
+        std::memcpy(target, &fixed, sizeof(uint32_t));
+        break;
+    }
+    }
+}
+
+double TravelMatrix::get_time(size_t from, size_t to) const {
+    check_bounds(from, to);
+    return arc(from, to).time;
+}
+
+double TravelMatrix::get_distance(size_t from, size_t to) const {
+    check_bounds(from, to);
+    return arc(from, to).distance;
+}
+
+void TravelMatrix::set_time(size_t from, size_t to, double time) {
+    check_bounds(from, to);
+    store((from * size_ + to) * lanes_ + lanes_ - 1, time);
 }
 
 void TravelMatrix::set_distance(size_t from, size_t to, double distance) {
-    if (from >= size_ || to >= size_) {
-        throw std::out_of_range("Index out of range in TravelMatrix");
+    check_bounds(from, to);
+    store((from * size_ + to) * lanes_, distance);
+}
+
+void TravelMatrix::set_arc(size_t from, size_t to, double distance, double time) {
+    check_bounds(from, to);
+    if (storage_.shared_time_distance && distance != time) {
+        throw std::invalid_argument("TravelMatrix shares time/distance but values differ");
+    }
+    size_t idx = (from * size_ + to) * lanes_;
+    store(idx, distance);
+    if (lanes_ == 2) {
+        store(idx + 1, time);
     }
-    distances_[from][to] = distance;
 }
 
 size_t TravelMatrix::size() const {
@@ -0,0 +1,117 @@
+#include "pdptw/refn/ref_batch.hpp"
+#include <algorithm>
+#include <limits>
+
+#if defined(PDPTW_ENABLE_AVX2) && defined(_MSC_VER)
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+namespace pdptw {
+namespace refn {
+
+bool avx2_available() {
+#if defined(PDPTW_ENABLE_AVX2) && (defined(__GNUC__) || defined(__clang__))
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+#elif defined(PDPTW_ENABLE_AVX2) && defined(_MSC_VER)
+    static const bool supported = [] {
+        int info[4];
+        __cpuid(info, 1);
+        bool os_saves_ymm = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) &&
+                            ((_xgetbv(0) & 0x6) == 0x6);
+        __cpuidex(info, 7, 0);
+        return os_saves_ymm && (info[1] & (1 << 5));
+    }();
+    return supported;
+#else
+    return false;
+#endif
+}
+
+namespace detail {
+
+void evaluate_delivery_lanes_scalar(const DeliveryLanes &lanes, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+        // extend_forward_into_target(delivery)
+        Num arrival = lanes.segment_completion[i] + lanes.time_in[i];
+        bool ok = arrival <= lanes.delivery_due;
+        Num completion = std::max(arrival, lanes.delivery_ready) + lanes.delivery_service;
+        Num load = lanes.segment_load[i] + lanes.delivery_demand;
+        Num max_load = std::max(lanes.segment_max_load[i], load);
+
+        // concat_into_target(bw_data(next)) + check_capacity
+        ok = ok && (completion + lanes.time_out[i] <= lanes.next_latest_start[i]);
+        max_load = std::max(max_load, load + lanes.next_max_load[i]);
+        ok = ok && (max_load <= lanes.capacity);
+
+        // Cùng thứ tự cộng với calculate_insertion_cost
+        Num new_cost = lanes.pickup_new_cost[i] + lanes.dist_in[i] + lanes.dist_out[i] - lanes.removed_new[i];
+        Num old_cost = lanes.pickup_old_cost[i] + lanes.removed_old[i];
+        lanes.cost[i] = new_cost - old_cost;
+        lanes.feasible[i] = ok ? 1 : 0;
+    }
+}
+
+} // namespace detail
+
+void DeliveryBatch::reset(const REFNode &delivery, Capacity capacity) {
+    delivery_ = delivery;
+    capacity_ = capacity;
+
+    pickup_new_cost_.clear();
+    pickup_old_cost_.clear();
+    segment_completion_.clear();
+    segment_load_.clear();
+    segment_max_load_.clear();
+    time_in_.clear();
+    time_out_.clear();
+    next_latest_start_.clear();
+    next_max_load_.clear();
+    dist_in_.clear();
+    dist_out_.clear();
+    removed_new_.clear();
+    removed_old_.clear();
+}
+
+void DeliveryBatch::evaluate(BatchBackend backend) {
+    const size_t n = size();
+    cost_.resize(n);
+    feasible_.resize(n);
+
+    detail::DeliveryLanes lanes{
+        n,
+        delivery_.ready,
+        delivery_.due,
+        delivery_.servicetime,
+        static_cast<Num>(delivery_.demand),
+        static_cast<Num>(capacity_),
+        pickup_new_cost_.data(),
+        pickup_old_cost_.data(),
+        segment_completion_.data(),
+        segment_load_.data(),
+        segment_max_load_.data(),
+        time_in_.data(),
+        time_out_.data(),
+        next_latest_start_.data(),
+        next_max_load_.data(),
+        dist_in_.data(),
+        dist_out_.data(),
+        removed_new_.data(),
+        removed_old_.data(),
+        cost_.data(),
+        feasible_.data()};
+
+#ifdef PDPTW_ENABLE_AVX2
+    if (backend == BatchBackend::Avx2 && avx2_available()) {
+        detail::evaluate_delivery_lanes_avx2(lanes);
+        return;
+    }
+#else
+    (void)backend;
+#endif
+    detail::evaluate_delivery_lanes_scalar(lanes, 0, n);
+}
+
+} // namespace refn
+} // namespace pdptw
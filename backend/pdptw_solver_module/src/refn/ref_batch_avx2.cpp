@@ -0,0 +1,54 @@
+// Kernel AVX2 cho DeliveryBatch. File này được biên dịch với -mavx2 (/arch:AVX2) và chỉ
+// được gọi sau khi avx2_available() trả về true, nên không dùng hàm inline/template của
+// thư viện chuẩn ở đây (tránh bản AVX2 của chúng thắng khi link với TU khác).
+
+#include "pdptw/refn/ref_batch.hpp"
+#include <immintrin.h>
+
+namespace pdptw {
+namespace refn {
+namespace detail {
+
+void evaluate_delivery_lanes_avx2(const DeliveryLanes &lanes) {
+    const __m256d ready = _mm256_set1_pd(lanes.delivery_ready);
+    const __m256d due = _mm256_set1_pd(lanes.delivery_due);
+    const __m256d service = _mm256_set1_pd(lanes.delivery_service);
+    const __m256d demand = _mm256_set1_pd(lanes.delivery_demand);
+    const __m256d capacity = _mm256_set1_pd(lanes.capacity);
+
+    size_t i = 0;
+    for (; i + 4 <= lanes.size; i += 4) {
+        // extend_forward_into_target(delivery)
+        __m256d arrival = _mm256_add_pd(_mm256_loadu_pd(lanes.segment_completion + i),
+                                        _mm256_loadu_pd(lanes.time_in + i));
+        __m256d ok = _mm256_cmp_pd(arrival, due, _CMP_LE_OQ);
+        __m256d completion = _mm256_add_pd(_mm256_max_pd(arrival, ready), service);
+        __m256d load = _mm256_add_pd(_mm256_loadu_pd(lanes.segment_load + i), demand);
+        __m256d max_load = _mm256_max_pd(_mm256_loadu_pd(lanes.segment_max_load + i), load);
+
+        // concat_into_target(bw_data(next)) + check_capacity
+        __m256d leave = _mm256_add_pd(completion, _mm256_loadu_pd(lanes.time_out + i));
+        ok = _mm256_and_pd(ok, _mm256_cmp_pd(leave, _mm256_loadu_pd(lanes.next_latest_start + i), _CMP_LE_OQ));
+        max_load = _mm256_max_pd(max_load, _mm256_add_pd(load, _mm256_loadu_pd(lanes.next_max_load + i)));
+        ok = _mm256_and_pd(ok, _mm256_cmp_pd(max_load, capacity, _CMP_LE_OQ));
+
+        // Không dùng FMA: giữ đúng thứ tự làm tròn của bản vô hướng
+        __m256d new_cost = _mm256_add_pd(_mm256_loadu_pd(lanes.pickup_new_cost + i), _mm256_loadu_pd(lanes.dist_in + i));
+        new_cost = _mm256_add_pd(new_cost, _mm256_loadu_pd(lanes.dist_out + i));
+        new_cost = _mm256_sub_pd(new_cost, _mm256_loadu_pd(lanes.removed_new + i));
+        __m256d old_cost = _mm256_add_pd(_mm256_loadu_pd(lanes.pickup_old_cost + i), _mm256_loadu_pd(lanes.removed_old + i));
+        _mm256_storeu_pd(lanes.cost + i, _mm256_sub_pd(new_cost, old_cost));
+
+        int mask = _mm256_movemask_pd(ok);
+        lanes.feasible[i] = static_cast<uint8_t>(mask & 1);
+        lanes.feasible[i + 1] = static_cast<uint8_t>((mask >> 1) & 1);
+        lanes.feasible[i + 2] = static_cast<uint8_t>((mask >> 2) & 1);
+        lanes.feasible[i + 3] = static_cast<uint8_t>((mask >> 3) & 1);
+    }
+
+    evaluate_delivery_lanes_scalar(lanes, i, lanes.size);
+}
+
+} // namespace detail
+} // namespace refn
+} // namespace pdptw
@@ -1,6 +1,7 @@
 #include "pdptw/solution/datastructure.hpp"
 #include "pdptw/solution/description.hpp"
 #include <algorithm>
+#include <atomic>
 #include <spdlog/spdlog.h>
 #include <stdexcept>
 
@@ -13,13 +14,23 @@ namespace pdptw::solution {
 Solution::Solution(const PDPTWInstance &instance)
     : instance_(&instance),
       fw_data_(instance),
-      bw_data_(instance),
+      bw_data_(instance, fw_data_.shared_nodes()),
       blocks_(instance),
       unassigned_requests_(instance),
       max_num_vehicles_available_(instance.num_vehicles()),
       num_requests_(instance.num_requests()) {
 
     empty_route_ids_.resize(instance.num_vehicles(), true);
+    route_versions_.resize(instance.num_vehicles(), 0);
+    positions_.resize(fw_data_.size(), 0);
+    route_distances_.resize(instance.num_vehicles(), 0.0);
+    reset_depot_positions();
+    sync_all_route_summaries();
+}
+
+Solution::ObjectUid::ObjectUid() {
+    static std::atomic<uint64_t> next_uid{1};
+    value = next_uid.fetch_add(1, std::memory_order_relaxed);
 }
 
 // ============================================================
@@ -36,34 +47,12 @@ size_t Solution::num_empty_routes() const {
     return std::count(empty_route_ids_.begin(), empty_route_ids_.begin() + limit, true);
 }
 
-size_t Solution::number_of_non_empty_routes() const {
-    size_t count = 0;
-    for (size_t route_id = 0; route_id < instance_->num_vehicles(); ++route_id) {
-        if (!is_route_empty(route_id)) {
-            ++count;
-        }
-    }
-    return count;
-}
-
 // ============================================================
 // Điều hướng giữa các nodes
 // ============================================================
 
-size_t Solution::pred(size_t node_id) const {
-    return fw_data_[node_id].pred;
-}
-
-size_t Solution::succ(size_t node_id) const {
-    return fw_data_[node_id].succ;
-}
-
 std::pair<size_t, size_t> Solution::pred_succ_pair(size_t node_id) const {
-    return {fw_data_[node_id].pred, fw_data_[node_id].succ};
-}
-
-size_t Solution::vn_id(size_t node_id) const {
-    return fw_data_[node_id].vn_id;
+    return {fw_data_.pred(node_id), fw_data_.succ(node_id)};
 }
 
 // ============================================================
@@ -71,15 +60,20 @@ size_t Solution::vn_id(size_t node_id) const {
 // ============================================================
 
 void Solution::clear() {
+    touch_all();
     fw_data_.reset(*instance_);
     bw_data_.reset(*instance_);
     std::fill(empty_route_ids_.begin(), empty_route_ids_.end(), true);
     unassigned_requests_.set_all();
     blocks_.invalidate_all();
+    reset_depot_positions();
+    sync_all_route_summaries();
 }
 
 // Thiết lập solution từ danh sách các route (itineraries)
 void Solution::set(const std::vector<std::vector<size_t>> &itineraries) {
+    touch_all();
+
     // Khởi tạo lại các vehicle nodes
     for (size_t i = 0; i < instance_->num_vehicles(); ++i) {
         link_nodes(i * 2, i * 2 + 1);
@@ -132,13 +126,16 @@ void Solution::set(const std::vector<std::vector<size_t>> &itineraries) {
         revalidate_blocks(vn_id);
     }
 
-    // Xây dựng lại cache sau khi cấu trúc solution thay đổi hoàn toàn
-    rebuild_cache();
+    // Route không có trong itineraries đã bị nối lại thành rỗng mà không revalidate
+    sync_all_route_summaries();
 }
 
 // Cập nhật thứ tự nodes trong route và tính toán lại REF data
 void Solution::update_route_sequence(const std::vector<size_t> &route) {
     size_t vn_id = route[0];
+    for (size_t node_id : route) {
+        touch_node(node_id);
+    }
 
     // Duyệt xuôi: cập nhật con trỏ successor và REF data
     size_t prev_id = route[0];
@@ -174,11 +171,16 @@ void Solution::update_route_sequence(const std::vector<size_t> &route) {
 }
 
 void Solution::relink(size_t vn_id, size_t node_id, size_t pred, size_t succ) {
+    touch_node(node_id);
+    touch_node(pred);
+    touch_node(succ);
     fw_data_.relink(vn_id, node_id, pred, succ);
     bw_data_.relink(vn_id, node_id, pred, succ);
 }
 
 void Solution::link_nodes(size_t n1, size_t n2) {
+    touch_node(n1);
+    touch_node(n2);
     fw_data_[n1].succ = n2;
     fw_data_[n2].pred = n1;
     bw_data_[n1].succ = n2;
@@ -201,6 +203,13 @@ std::pair<size_t, size_t> Solution::relink_when_inserting_pd(
     // Kiểm tra xem pickup và delivery có kề nhau sau khi chèn không
     bool delivery_after_pickup = (old_succ_pickup == delivery_before);
 
+    touch_node(pickup_after);
+    touch_node(delivery_before);
+    touch_node(old_succ_pickup);
+    touch_node(old_pred_delivery);
+    touch_node(pickup_id);
+    touch_node(delivery_id);
+
     if (fw_data_[pickup_after].succ == delivery_before) {
         // Case 1: pickup_after -> delivery_before (adjacent insertion)
         // Result: pickup_after -> pickup -> delivery -> delivery_before
@@ -226,10 +235,6 @@ std::pair<size_t, size_t> Solution::relink_when_inserting_pd(
         bw_data_.relink(vn_id, delivery_id, old_pred_delivery, delivery_before);
     }
 
-    // Cập nhật cache với assignment mới
-    size_t route_id = vn_id / 2;
-    update_cache_on_insert(pickup_id, delivery_id, route_id);
-
     return {pickup_after, delivery_before};
 }
 
@@ -263,21 +268,24 @@ void Solution::track_request_unassigned(size_t pickup_id) {
 
     const size_t delivery_id = pickup_id + 1;
 
+    touch_node(pickup_id);
+    touch_node(delivery_id);
     unassigned_requests_.insert_pickup_id(pickup_id);
 
     // Invalidate blocks
     blocks_.invalidate_block(pickup_id);
     blocks_.invalidate_block(delivery_id);
 
-    fw_data_[pickup_id].succ = pickup_id;
-    fw_data_[pickup_id].pred = pickup_id;
-    fw_data_[delivery_id].succ = delivery_id;
-    fw_data_[delivery_id].pred = delivery_id;
+    // Node chưa gán: self-loop và vn_id = chính nó (cùng quy ước với REFNodeVec::reset)
+    for (size_t node_id : {pickup_id, delivery_id}) {
+        fw_data_[node_id].succ = node_id;
+        fw_data_[node_id].pred = node_id;
+        fw_data_[node_id].vn_id = node_id;
 
-    bw_data_[pickup_id].succ = pickup_id;
-    bw_data_[pickup_id].pred = pickup_id;
-    bw_data_[delivery_id].succ = delivery_id;
-    bw_data_[delivery_id].pred = delivery_id;
+        bw_data_[node_id].succ = node_id;
+        bw_data_[node_id].pred = node_id;
+        bw_data_[node_id].vn_id = node_id;
+    }
 }
 
 void Solution::unassign_request(size_t pickup_id) {
@@ -289,11 +297,6 @@ void Solution::unassign_request(size_t pickup_id) {
     }
 
     auto [validate_start, validate_end] = relink_gap_when_removing_pd(pickup_id);
-
-    // Update cache before tracking as unassigned
-    size_t delivery_id = pickup_id + 1;
-    update_cache_on_remove(pickup_id, delivery_id);
-
     track_request_unassigned(pickup_id);
     validate_between(validate_start, validate_end);
 }
@@ -326,6 +329,7 @@ void Solution::partially_validate_between(
     while (prev_id != bounds.succ_last && fw_iterations < MAX_NODES_IN_ROUTE) {
         size_t node_id = fw_data_[prev_id].succ;
 
+        touch_node(node_id);
         fw_data_.extend_forward_unchecked(prev_id, node_id, *instance_);
         fw_data_[node_id].vn_id = vn_id;
         prev_id = node_id;
@@ -349,6 +353,7 @@ void Solution::partially_validate_between(
             break;
         }
 
+        touch_node(node_id);
         bw_data_.extend_backward_unchecked(next_id, node_id, *instance_);
         bw_data_[node_id].vn_id = vn_id;
         next_id = node_id;
@@ -360,18 +365,30 @@ void Solution::partially_validate_between(
                      vn_id, MAX_NODES_IN_ROUTE);
     }
 
+    touch_route(vn_id / 2);
     empty_route_ids_[vn_id / 2] = (succ(vn_id) == vn_id + 1);
 
     revalidate_blocks(vn_id);
 }
 
 // Tính toán lại blocks cho toàn bộ route (tối ưu hóa cho LNS)
+// Route rỗng: start depot ở vị trí 0, end depot ở vị trí 1
+void Solution::reset_depot_positions() {
+    for (size_t vn_id = 0; vn_id < instance_->num_vehicles() * 2; vn_id += 2) {
+        positions_[vn_id] = 0;
+        positions_[vn_id + 1] = 1;
+    }
+}
+
 void Solution::revalidate_blocks(size_t vn_id) {
     const size_t MAX_NODES_IN_ROUTE = instance_->num_requests() * 2 + 12;
     size_t block_start = succ(vn_id);
     size_t outer_iterations = 0;
+    LinkIndex position = 0;
 
     while (block_start != vn_id + 1 && outer_iterations < MAX_NODES_IN_ROUTE) {
+        touch_node(block_start);
+        positions_[block_start] = ++position;
         blocks_.set_block_valid(block_start);
         blocks_[block_start].first_node_id = block_start;
         blocks_[block_start].data.reset_with_node(fw_data_[block_start].node);
@@ -382,6 +399,8 @@ void Solution::revalidate_blocks(size_t vn_id) {
 
         while (open_pickups != 0 && inner_iterations < MAX_NODES_IN_ROUTE) {
             size_t node_id = succ(prev_id);
+            touch_node(node_id);
+            positions_[node_id] = ++position;
             blocks_.invalidate_block(node_id);
 
             auto dist_time = instance_->distance_and_time(prev_id, node_id);
@@ -415,8 +434,54 @@ void Solution::revalidate_blocks(size_t vn_id) {
     }
 
     // Reset vehicle node blocks
+    touch_node(vn_id);
+    touch_node(vn_id + 1);
+    positions_[vn_id] = 0;
+    positions_[vn_id + 1] = ++position;
     blocks_[vn_id].data.reset_with_node(fw_data_[vn_id].node);
     blocks_[vn_id + 1].data.reset_with_node(fw_data_[vn_id + 1].node);
+
+    if (sync_route_summary(vn_id / 2)) {
+        recompute_total_distance();
+    }
+}
+
+bool Solution::sync_route_summary(size_t route_id) {
+    const double distance = fw_data_[(route_id * 2) + 1].data.distance;
+    const bool non_empty = !is_route_empty(route_id);
+
+    auto it = std::lower_bound(non_empty_routes_.begin(), non_empty_routes_.end(), route_id);
+    const bool listed = it != non_empty_routes_.end() && *it == route_id;
+    bool changed = false;
+    if (non_empty && !listed) {
+        non_empty_routes_.insert(it, route_id);
+        changed = true;
+    } else if (!non_empty && listed) {
+        non_empty_routes_.erase(it);
+        changed = true;
+    }
+    if (route_distances_[route_id] != distance) {
+        route_distances_[route_id] = distance;
+        changed = changed || non_empty;
+    }
+    return changed;
+}
+
+void Solution::sync_all_route_summaries() {
+    for (size_t route_id = 0; route_id < route_distances_.size(); ++route_id) {
+        sync_route_summary(route_id);
+    }
+    recompute_total_distance();
+}
+
+// Route rỗng tính distance 0 như ngay sau clear(). Cộng lại theo thứ tự route tăng dần (O(số route
+// không rỗng)) thay vì cộng dồn chênh lệch nên objective không bị trôi số qua nhiều iteration
+void Solution::recompute_total_distance() {
+    double total = 0.0;
+    for (size_t route_id : non_empty_routes_) {
+        total += route_distances_[route_id];
+    }
+    total_distance_ = total;
 }
 
 // ============================================================
@@ -428,14 +493,6 @@ bool Solution::is_route_feasible(size_t route_id) const {
     return fw_data_[vn_id].data.tw_feasible;
 }
 
-double Solution::total_cost() const {
-    double cost = 0.0;
-    for (size_t i = 0; i < instance_->num_vehicles(); ++i) {
-        cost += fw_data_[(i * 2) + 1].data.distance;
-    }
-    return cost;
-}
-
 double Solution::total_waiting_time() const {
     double waiting_time = 0.0;
     for (size_t i = 0; i < instance_->num_vehicles(); ++i) {
@@ -497,17 +554,6 @@ std::vector<size_t> Solution::iter_route_by_vn_id(size_t vn_id) const {
 // Các hàm hỗ trợ tối thiểu hóa số lượng vehicles
 // ============================================================
 
-std::vector<size_t> Solution::iter_route_ids() const {
-    std::vector<size_t> route_ids;
-    route_ids.reserve(number_of_non_empty_routes());
-    for (size_t route_id = 0; route_id < instance_->num_vehicles(); ++route_id) {
-        if (!is_route_empty(route_id)) {
-            route_ids.push_back(route_id);
-        }
-    }
-    return route_ids;
-}
-
 std::vector<size_t> Solution::iter_route(size_t route_id) const {
     return iter_route_by_vn_id(route_id * 2);
 }
@@ -530,16 +576,13 @@ void Solution::unassign_complete_route(size_t route_id) {
 
         // Track delivery nodes to unassign their requests
         if (instance_->is_delivery(current)) {
-            const size_t pickup_id = current - 1;
-            const size_t delivery_id = current;
-
-            update_cache_on_remove(pickup_id, delivery_id);
-            track_request_unassigned(pickup_id);
+            track_request_unassigned(current - 1);
         }
     }
 
     // Clear the route
     link_nodes(vn_start, vn_end);
+    touch_route(route_id);
 
     fw_data_[vn_start].data.reset_with_node(fw_data_[vn_start].node);
     fw_data_[vn_end].data.reset_with_node(fw_data_[vn_end].node);
@@ -551,8 +594,35 @@ void Solution::unassign_complete_route(size_t route_id) {
     empty_route_ids_[route_id] = true;
 }
 
+// Chép lại một số route từ source: gỡ hết trước rồi mới nối lại, vì request có thể đã
+// chuyển giữa các route được chép
+void Solution::replay_routes(const Solution &source, const std::vector<size_t> &route_ids) {
+    for (size_t route_id : route_ids) {
+        if (!is_route_empty(route_id)) {
+            unassign_complete_route(route_id);
+        }
+    }
+    for (size_t route_id : route_ids) {
+        if (source.is_route_empty(route_id)) {
+            continue;
+        }
+        std::vector<size_t> route = source.iter_route(route_id);
+        for (size_t i = 1; i + 1 < route.size(); ++i) {
+            if (instance_->is_pickup(route[i])) {
+                unassigned_requests_.remove(route[i]);
+            }
+        }
+        update_route_sequence(route);
+        empty_route_ids_[route_id] = false;
+    }
+    max_num_vehicles_available_ = source.max_num_vehicles_available_;
+}
+
 void Solution::clamp_max_number_of_vehicles_to_current_fleet_size() {
     max_num_vehicles_available_ = number_of_non_empty_routes();
+    for (size_t route_id = 0; route_id < empty_route_ids_.size(); ++route_id) {
+        touch_route(route_id);
+    }
     std::fill(empty_route_ids_.begin(), empty_route_ids_.end(), false);
 }
 
@@ -561,103 +631,135 @@ SolutionDescription Solution::to_description() const {
 }
 
 // ============================================================
-// Quản lý cache (tăng tốc truy vấn route của node/request)
+// Tra cứu route: suy ra từ vn_id của danh sách xuôi (node chưa gán có vn_id = chính nó)
 // ============================================================
 
-void Solution::rebuild_cache() {
-    node_to_route_.clear();
-    request_assignments_.clear();
-
-    // Xây dựng lại cache từ cấu trúc solution hiện tại
-    for (size_t route_id = 0; route_id < instance_->num_vehicles(); ++route_id) {
-        if (is_route_empty(route_id)) {
-            continue;
-        }
-
-        size_t vn_id = route_id * 2;
-        size_t pos = 0;
-        size_t current = succ(vn_id);
-        size_t vn_end = vn_id + 1;
-
-        while (current != vn_end) {
-            node_to_route_[current] = route_id;
-
-            if (instance_->is_pickup(current)) {
-                size_t request_id = instance_->request_id(current);
-                size_t delivery_id = current + 1;
-
-                // Find delivery position
-                size_t delivery_pos = pos;
-                size_t node = current;
-                while (node != delivery_id) {
-                    node = succ(node);
-                    delivery_pos++;
-                }
-
-                request_assignments_[request_id] = RequestAssignment{
-                    route_id,
-                    pos,
-                    delivery_pos};
-            }
+size_t Solution::route_of_node(size_t node_id) const {
+    const size_t num_vehicle_nodes = instance_->num_vehicles() * 2;
+    if (node_id < num_vehicle_nodes) {
+        return node_id / 2;
+    }
 
-            current = succ(current);
-            pos++;
-        }
+    const auto &entry = fw_data_[node_id];
+    if (entry.vn_id >= num_vehicle_nodes) {
+        throw std::runtime_error("Node not found in any route");
     }
+    return entry.vn_id / 2;
 }
 
-// Cập nhật cache khi chèn request vào route
-void Solution::update_cache_on_insert(size_t pickup_id, size_t delivery_id, size_t route_id) {
-    node_to_route_[pickup_id] = route_id;
-    node_to_route_[delivery_id] = route_id;
-
-    size_t request_id = instance_->request_id(pickup_id);
-    request_assignments_[request_id] = RequestAssignment{route_id, 0, 0};
+size_t Solution::route_of_request(size_t request_id) const {
+    if (!is_request_assigned(request_id)) {
+        throw std::runtime_error("Request is not assigned to any route");
+    }
+    return fw_data_[instance_->pickup_id_of_request(request_id)].vn_id / 2;
 }
 
-// Cập nhật cache khi gỡ bỏ request khỏi route
-void Solution::update_cache_on_remove(size_t pickup_id, size_t delivery_id) {
-    node_to_route_.erase(pickup_id);
-    node_to_route_.erase(delivery_id);
-
-    size_t request_id = instance_->request_id(pickup_id);
-    request_assignments_.erase(request_id);
+bool Solution::is_request_assigned(size_t request_id) const {
+    const size_t pickup_id = instance_->pickup_id_of_request(request_id);
+    const auto &entry = fw_data_[pickup_id];
+    return entry.succ != pickup_id && entry.vn_id < instance_->num_vehicles() * 2;
 }
 
-size_t Solution::route_of_node(size_t node_id) const {
-    auto it = node_to_route_.find(node_id);
-    if (it != node_to_route_.end()) {
-        return it->second; // O(1) lookup
+// ============================================================
+// Undo journal: destroy/repair trực tiếp trên solution, rollback O(số node bị thay đổi)
+// ============================================================
+
+void Solution::begin_transaction() {
+    if (journal_active_) {
+        throw std::logic_error("Solution transaction already active");
     }
+    if (node_stamps_.size() != fw_data_.size()) {
+        node_stamps_.assign(fw_data_.size(), 0);
+        route_stamps_.assign(empty_route_ids_.size(), 0);
+    }
+    // Epoch mới: mọi stamp cũ trở thành "chưa lưu" (xóa lại khi tràn số)
+    if (++journal_epoch_ == 0) {
+        std::fill(node_stamps_.begin(), node_stamps_.end(), 0);
+        std::fill(route_stamps_.begin(), route_stamps_.end(), 0);
+        journal_epoch_ = 1;
+    }
+    node_undo_.clear();
+    route_undo_.clear();
+    saved_max_num_vehicles_ = max_num_vehicles_available_;
+    unassigned_requests_.begin_journal();
+    journal_active_ = true;
+}
 
-    // Fallback: linear search (for compatibility during transition)
-    for (size_t route_id = 0; route_id < instance_->num_vehicles(); ++route_id) {
-        size_t vn_id = route_id * 2;
-        size_t current = succ(vn_id);
-        size_t vn_end = vn_id + 1;
+void Solution::commit_transaction() {
+    journal_active_ = false;
+    node_undo_.clear();
+    route_undo_.clear();
+    unassigned_requests_.commit_journal();
+}
 
-        while (current != vn_end) {
-            if (current == node_id) {
-                return route_id;
-            }
-            current = succ(current);
+void Solution::rollback_transaction() {
+    if (!journal_active_) {
+        return;
+    }
+    journal_active_ = false;
+
+    for (const auto &undo : node_undo_) {
+        fw_data_.restore(undo.node_id, undo.fw);
+        bw_data_.restore(undo.node_id, undo.bw);
+        positions_[undo.node_id] = undo.position;
+        blocks_[undo.node_id] = undo.block;
+        if (undo.block_start) {
+            blocks_.set_block_valid(undo.node_id);
+        } else {
+            blocks_.invalidate_block(undo.node_id);
         }
     }
+    for (const auto &undo : route_undo_) {
+        empty_route_ids_[undo.route_id] = undo.empty;
+        route_versions_[undo.route_id] = undo.version;
+        sync_route_summary(undo.route_id);
+    }
+    recompute_total_distance();
+    max_num_vehicles_available_ = saved_max_num_vehicles_;
+    unassigned_requests_.rollback_journal();
 
-    throw std::runtime_error("Node not found in any route");
+    node_undo_.clear();
+    route_undo_.clear();
 }
 
-size_t Solution::route_of_request(size_t request_id) const {
-    auto it = request_assignments_.find(request_id);
-    if (it != request_assignments_.end()) {
-        return it->second.route_id; // O(1) lookup
+std::vector<size_t> Solution::journaled_routes() const {
+    std::vector<size_t> route_ids;
+    route_ids.reserve(route_undo_.size());
+    for (const auto &undo : route_undo_) {
+        route_ids.push_back(undo.route_id);
+    }
+    return route_ids;
+}
+
+// Gọi trước mỗi lần ghi vào node: đánh dấu route chứa node đã thay đổi và lưu trạng thái cũ
+void Solution::touch_node(size_t node_id) {
+    const size_t vn_id = fw_data_.vn_id(node_id);
+    if (vn_id < route_versions_.size() * 2) {
+        touch_route(vn_id / 2);
+    }
+    if (!journal_active_ || node_stamps_[node_id] == journal_epoch_) {
+        return;
     }
+    node_stamps_[node_id] = journal_epoch_;
+    node_undo_.push_back(NodeUndo{node_id, fw_data_.state(node_id), bw_data_.state(node_id), positions_[node_id],
+                                  blocks_[node_id], blocks_.is_block_start(node_id)});
+}
 
-    throw std::runtime_error("Request is not assigned to any route");
+void Solution::touch_route(size_t route_id) {
+    if (journal_active_ && route_stamps_[route_id] != journal_epoch_) {
+        route_stamps_[route_id] = journal_epoch_;
+        route_undo_.push_back(RouteUndo{route_id, empty_route_ids_[route_id], route_versions_[route_id]});
+    }
+    route_versions_[route_id] = ++route_version_counter_;
 }
 
-bool Solution::is_request_assigned(size_t request_id) const {
-    return request_assignments_.find(request_id) != request_assignments_.end();
+void Solution::touch_all() {
+    for (size_t node_id = 0; node_id < fw_data_.size(); ++node_id) {
+        touch_node(node_id);
+    }
+    for (size_t route_id = 0; route_id < route_versions_.size(); ++route_id) {
+        touch_route(route_id);
+    }
 }
 
 // ============================================================
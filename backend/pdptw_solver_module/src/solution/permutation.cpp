@@ -12,18 +12,19 @@ using pdptw::problem::DistanceAndTime;
 std::optional<PDInsertion> PermutationOps::find_random_insert_for_request(
     const Solution &sol,
     size_t pickup_id,
-    std::mt19937 &rng) {
+    std::mt19937 &rng,
+    const problem::GranularNeighborhood *granular) {
     ReservoirSampling sampling;
 
     // Try all non-empty routes + first empty route
     for (size_t r_id : sol.iter_route_ids()) {
-        sampling = find_random_insert_in_route(sol, pickup_id, r_id, rng, sampling);
+        sampling = find_random_insert_in_route(sol, pickup_id, r_id, rng, sampling, granular);
     }
 
     // Also try first empty route
     auto empty_routes = sol.iter_empty_route_ids();
     if (!empty_routes.empty()) {
-        sampling = find_random_insert_in_route(sol, pickup_id, empty_routes[0], rng, sampling);
+        sampling = find_random_insert_in_route(sol, pickup_id, empty_routes[0], rng, sampling, granular);
     }
 
     return sampling.take();
@@ -36,7 +37,8 @@ ReservoirSampling PermutationOps::find_random_insert_in_route(
     size_t pickup_id,
     size_t route_id,
     std::mt19937 &rng,
-    ReservoirSampling sampling) {
+    ReservoirSampling sampling,
+    const problem::GranularNeighborhood *granular) {
     size_t vn_id = route_id * 2;
     const auto &instance = sol.instance();
     const auto &vehicle = instance.vehicle_from_vn_id(vn_id);
@@ -48,6 +50,17 @@ ReservoirSampling PermutationOps::find_random_insert_in_route(
     const auto &fw_data = sol.fw_data();
     const auto &bw_data = sol.bw_data();
 
+    // Granular: route không rỗng mà không chứa láng giềng nào của pickup thì không có khe hợp lệ
+    if (granular && fw_data[vn_id].succ != vn_id + 1) {
+        const auto &neighbors = granular->neighbors(pickup_id);
+        bool has_neighbor = std::any_of(neighbors.begin(), neighbors.end(), [&](size_t n) {
+            return fw_data[n].succ != n && fw_data[n].vn_id == vn_id;
+        });
+        if (!has_neighbor) {
+            return sampling;
+        }
+    }
+
     size_t feasible_count = 0;
     PDInsertion best_in_route;
     best_in_route.cost = std::numeric_limits<Num>::max();
@@ -56,6 +69,11 @@ ReservoirSampling PermutationOps::find_random_insert_in_route(
         const auto &before_pickup = fw_data[pickup_after];
         size_t next_after_pickup = before_pickup.succ;
 
+        if (granular && !granular->allows_gap(pickup_id, pickup_after, next_after_pickup)) {
+            pickup_after = next_after_pickup;
+            continue;
+        }
+
         DistanceAndTime dist_time = instance.distance_and_time(pickup_after, pickup_id);
         if (before_pickup.data.earliest_completion + dist_time.time > pickup_node.due()) {
             pickup_after = next_after_pickup;
@@ -75,26 +93,31 @@ ReservoirSampling PermutationOps::find_random_insert_in_route(
             if (tmp_data.earliest_completion + dist_prev_to_del.time > delivery_node.due()) {
                 break;
             }
-            auto tmp_after_del = tmp_data;
-            tmp_after_del.extend_forward(fw_data[delivery_id].node, dist_prev_to_del);
-            DistanceAndTime dist_del_to_next = instance.distance_and_time(delivery_id, delivery_before);
-            auto final_data = tmp_after_del;
-            final_data.concat(after_delivery.data, dist_del_to_next);
-
-            if (final_data.tw_feasible && vehicle.check_capacity(final_data.max_load)) {
-                Num cost_delta = final_data.distance - fw_data[vn_id + 1].data.distance;
-
-                if (cost_delta < best_in_route.cost) {
-                    best_in_route = PDInsertion{
-                        vn_id,
-                        pickup_id,
-                        pickup_after,
-                        delivery_before,
-                        cost_delta};
+            if (!granular || granular->allows_gap(delivery_id, prev_node, delivery_before)) {
+                auto tmp_after_del = tmp_data;
+                tmp_after_del.extend_forward(fw_data[delivery_id].node, dist_prev_to_del);
+                DistanceAndTime dist_del_to_next = instance.distance_and_time(delivery_id, delivery_before);
+                auto final_data = tmp_after_del;
+                final_data.concat(bw_data[delivery_before].data, dist_del_to_next);
+
+                if (final_data.tw_feasible && vehicle.check_capacity(final_data.max_load)) {
+                    Num cost_delta = final_data.distance - fw_data[vn_id + 1].data.distance;
+
+                    if (cost_delta < best_in_route.cost) {
+                        best_in_route = PDInsertion{
+                            vn_id,
+                            pickup_id,
+                            pickup_after,
+                            delivery_before,
+                            cost_delta};
+                    }
+                    feasible_count++;
                 }
-                feasible_count++;
             }
 
+            // Delivery lùi ra sau delivery_before: đoạn pickup..delivery thêm node này
+            tmp_data.extend_forward(after_delivery.node,
+                                    instance.distance_and_time(prev_node, delivery_before));
             prev_node = delivery_before;
             delivery_before = after_delivery.succ;
         }
@@ -127,6 +150,7 @@ std::vector<PDInsertion> PermutationOps::find_all_inserts_for_request_in_route(
     const auto &delivery_node = instance.nodes()[delivery_id];
 
     const auto &fw_data = sol.fw_data();
+    const auto &bw_data = sol.bw_data();
 
     size_t pickup_after = vn_id;
     while (pickup_after != vn_id + 1) {
@@ -159,7 +183,7 @@ std::vector<PDInsertion> PermutationOps::find_all_inserts_for_request_in_route(
 
             DistanceAndTime dist_del_to_next = instance.distance_and_time(delivery_id, delivery_before);
             auto final_data = tmp_after_del;
-            final_data.concat(after_delivery.data, dist_del_to_next);
+            final_data.concat(bw_data[delivery_before].data, dist_del_to_next);
 
             if (final_data.tw_feasible && vehicle.check_capacity(final_data.max_load)) {
                 Num cost_delta = final_data.distance - fw_data[vn_id + 1].data.distance;
@@ -172,6 +196,9 @@ std::vector<PDInsertion> PermutationOps::find_all_inserts_for_request_in_route(
                     cost_delta});
             }
 
+            // Delivery lùi ra sau delivery_before: đoạn pickup..delivery thêm node này
+            tmp_data.extend_forward(after_delivery.node,
+                                    instance.distance_and_time(prev_node, delivery_before));
             prev_node = delivery_before;
             delivery_before = after_delivery.succ;
         }
@@ -215,7 +242,7 @@ bool PermutationOps::random_shift(Solution &sol, std::mt19937 &rng) {
     std::vector<size_t> assigned_pickups;
     for (size_t req_id = 0; req_id < sol.instance().num_requests(); ++req_id) {
         size_t pickup_id = sol.instance().pickup_id_of_request(req_id);
-        if (!sol.unassigned_requests().contains(req_id)) {
+        if (!sol.unassigned_requests().contains_request(req_id)) {
             assigned_pickups.push_back(pickup_id);
         }
     }
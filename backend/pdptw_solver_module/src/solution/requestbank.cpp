@@ -9,6 +9,7 @@ RequestBank::RequestBank(const problem::PDPTWInstance &instance)
     : instance_(&instance), penalty_per_entry_(10000.0) {
     // Khởi tạo với tất cả requests ở trạng thái unassigned
     requests_.resize(instance.num_requests(), true);
+    count_ = requests_.size();
 }
 
 // Chuyển đổi pickup_id thành request_id
@@ -44,14 +45,14 @@ std::vector<size_t> RequestBank::iter_pickup_ids() const {
 void RequestBank::insert_pickup_id(size_t pickup_id) {
     size_t request_id = pickup_to_request_id(pickup_id);
     if (request_id < requests_.size()) {
-        requests_[request_id] = true;
+        set_bit(request_id, true);
     }
 }
 
 void RequestBank::remove(size_t pickup_id) {
     size_t request_id = pickup_to_request_id(pickup_id);
     if (request_id < requests_.size()) {
-        requests_[request_id] = false;
+        set_bit(request_id, false);
     }
 }
 
@@ -64,21 +65,16 @@ bool RequestBank::contains_request(size_t request_id) const {
     return request_id < requests_.size() && requests_[request_id];
 }
 
-size_t RequestBank::count() const {
-    size_t cnt = 0;
-    for (bool assigned : requests_) {
-        if (assigned)
-            ++cnt;
-    }
-    return cnt;
-}
-
 void RequestBank::clear() {
-    std::fill(requests_.begin(), requests_.end(), false);
+    for (size_t i = 0; i < requests_.size(); ++i) {
+        set_bit(i, false);
+    }
 }
 
 void RequestBank::set_all() {
-    std::fill(requests_.begin(), requests_.end(), true);
+    for (size_t i = 0; i < requests_.size(); ++i) {
+        set_bit(i, true);
+    }
 }
 
 bool RequestBank::is_subset(const RequestBank &other) const {
@@ -105,4 +101,43 @@ double RequestBank::total_penalty() const {
     return count() * penalty_per_entry_;
 }
 
+void RequestBank::set_bit(size_t request_id, bool value) {
+    if (requests_[request_id] == value) {
+        return;
+    }
+    if (journal_active_) {
+        journal_.emplace_back(request_id, requests_[request_id]);
+    }
+    requests_[request_id] = value;
+    if (value) {
+        ++count_;
+    } else {
+        --count_;
+    }
+}
+
+void RequestBank::begin_journal() {
+    journal_.clear();
+    journal_active_ = true;
+}
+
+void RequestBank::commit_journal() {
+    journal_.clear();
+    journal_active_ = false;
+}
+
+void RequestBank::rollback_journal() {
+    for (auto it = journal_.rbegin(); it != journal_.rend(); ++it) {
+        // Journal chỉ ghi khi bit thực sự đổi nên giá trị cũ luôn khác giá trị hiện tại
+        requests_[it->first] = it->second;
+        if (it->second) {
+            ++count_;
+        } else {
+            --count_;
+        }
+    }
+    journal_.clear();
+    journal_active_ = false;
+}
+
 } // namespace pdptw::solution
@@ -0,0 +1,44 @@
+#include "pdptw/solution/route_snapshot.hpp"
+
+namespace pdptw::solution {
+
+void RouteSnapshot::capture(const Solution &solution) {
+    const size_t num_routes = solution.instance().num_vehicles();
+    const bool full = (source_uid_ != solution.uid() || itineraries_.size() != num_routes);
+    if (full) {
+        itineraries_.assign(num_routes, {});
+        versions_.assign(num_routes, 0);
+        source_uid_ = solution.uid();
+    }
+
+    routes_copied_ = 0;
+    for (size_t route_id = 0; route_id < num_routes; ++route_id) {
+        if (!full && versions_[route_id] == solution.route_version(route_id)) {
+            continue;
+        }
+        versions_[route_id] = solution.route_version(route_id);
+        if (solution.is_route_empty(route_id)) {
+            itineraries_[route_id].clear();
+        } else {
+            itineraries_[route_id] = solution.iter_route(route_id);
+        }
+        ++routes_copied_;
+    }
+
+    objective_ = solution.objective();
+}
+
+void RouteSnapshot::restore_into(Solution &solution) const {
+    std::vector<std::vector<size_t>> routes;
+    routes.reserve(itineraries_.size());
+    for (const auto &itinerary : itineraries_) {
+        if (!itinerary.empty()) {
+            routes.push_back(itinerary);
+        }
+    }
+
+    solution.clear();
+    solution.set(routes);
+}
+
+} // namespace pdptw::solution
@@ -4,9 +4,11 @@
 #include "pdptw/lns/destroy/route_removal.hpp"
 #include "pdptw/lns/destroy/worst_removal.hpp"
 #include "pdptw/lns/repair/absence_based_regret.hpp"
+#include "pdptw/lns/repair/blink_insertion.hpp"
 #include "pdptw/lns/repair/greedy_insertion.hpp"
 #include "pdptw/lns/repair/hardest_first_insertion.hpp"
 #include "pdptw/lns/repair/regret_insertion.hpp"
+#include "pdptw/utils/thread_pool.hpp"
 #include "pdptw/utils/time_limit.hpp"
 #include "pdptw/utils/validator.hpp"
 #include <algorithm>
@@ -52,6 +54,13 @@ bool SimulatedAnnealing::accept(
     Num current_obj,
     Num best_obj,
     std::mt19937 &rng) {
+    if (pending_bound.has_value()) {
+        // u đã rút trước: u < exp(-delta / T) <=> new_obj < current - T*ln(u)
+        Num bound = *pending_bound;
+        pending_bound.reset();
+        return new_obj < current_obj || new_obj < bound;
+    }
+
     if (new_obj < current_obj) {
         return true; // Luôn chấp nhận cải thiện
     }
@@ -64,6 +73,13 @@ bool SimulatedAnnealing::accept(
     return dist(rng) < probability;
 }
 
+Num SimulatedAnnealing::acceptance_bound(Num current_obj, Num, std::mt19937 &rng) {
+    std::uniform_real_distribution<double> dist(0.0, 1.0);
+    double u = dist(rng);
+    pending_bound = u > 0.0 ? current_obj - current_temp * std::log(u) : std::numeric_limits<Num>::infinity();
+    return *pending_bound;
+}
+
 // Record-to-Record Travel: Làm lạnh tuyến tính theo threshold
 
 RecordToRecordTravel::RecordToRecordTravel(
@@ -113,6 +129,14 @@ bool RecordToRecordTravel::accept(
     return relative_deviation <= current_threshold;
 }
 
+Num RecordToRecordTravel::acceptance_bound(Num, Num best_obj, std::mt19937 &) {
+    const double best_value = static_cast<double>(best_obj);
+    if (std::abs(best_value) < std::numeric_limits<double>::epsilon()) {
+        return best_obj + current_threshold;
+    }
+    return best_obj + current_threshold * std::abs(best_value);
+}
+
 // Only Improvements: Chỉ chấp nhận cải thiện
 
 bool OnlyImprovements::accept(
@@ -125,6 +149,15 @@ bool OnlyImprovements::accept(
 
 // Thống kê LNS
 
+double LNSStatistics::time_to_target(Num target) const {
+    for (const auto &[seconds, objective] : best_trace) {
+        if (objective <= target) {
+            return seconds;
+        }
+    }
+    return -1.0;
+}
+
 void LNSStatistics::print_summary() const {
     std::cout << "\n========================================\n";
     std::cout << "LNS Solver Statistics\n";
@@ -136,6 +169,7 @@ void LNSStatistics::print_summary() const {
     std::cout << "Improving solutions:     " << improving_solutions
               << " (" << (100.0 * improving_solutions / total_iterations) << "%)\n";
     std::cout << "New best solutions:      " << new_best_solutions << "\n";
+    std::cout << "Aborted repairs:         " << aborted_repairs << "\n";
     std::cout << "----------------------------------------\n";
     std::cout << "Initial objective:       " << initial_objective << "\n";
     std::cout << "Best objective:          " << best_objective << "\n";
@@ -155,21 +189,34 @@ void LNSStatistics::print_summary() const {
             std::cout << "  " << destroy_names[i] << ": "
                       << "used=" << ds.times_used
                       << ", improved=" << ds.times_improved
-                      << ", best=" << ds.times_found_new_best << "\n";
+                      << ", best=" << ds.times_found_new_best
+                      << ", ms=" << std::setprecision(1) << ds.total_ms
+                      << ", weight=" << std::setprecision(3) << ds.weight << "\n";
         }
     }
 
     if (!repair_stats.empty()) {
         std::cout << "Repair Operators:\n";
-        const char *repair_names[] = {"Greedy", "Regret2", "HardestFirst", "AbsenceRegret"};
+        const char *repair_names[] = {"Greedy", "Regret2", "Blink", "HardestFirst", "AbsenceRegret"};
         for (size_t i = 0; i < repair_stats.size(); ++i) {
             const auto &rs = repair_stats[i];
             std::cout << "  " << repair_names[i] << ": "
                       << "used=" << rs.times_used
                       << ", improved=" << rs.times_improved
-                      << ", best=" << rs.times_found_new_best << "\n";
+                      << ", best=" << rs.times_found_new_best
+                      << ", ms=" << std::setprecision(1) << rs.total_ms
+                      << ", weight=" << std::setprecision(3) << rs.weight << "\n";
         }
     }
+
+    const auto &ins = insertion_stats;
+    if (ins.routes_scanned + ins.routes_pruned > 0) {
+        std::cout << "Insertion Search:\n";
+        std::cout << "  routes: scanned=" << ins.routes_scanned
+                  << ", pruned=" << ins.routes_pruned << "\n";
+        std::cout << "  positions: checked=" << ins.positions_checked
+                  << ", pruned=" << ins.positions_pruned << "\n";
+    }
 }
 
 // LNS Solver chính
@@ -181,6 +228,9 @@ LNSSolver::LNSSolver(const PDPTWInstance &inst, const LNSSolverParams &p)
       absence_counter(inst.num_requests()),
       best_solution(inst),
       current_solution(inst) {
+    if (params.deterministic) {
+        params.adaptive_weights.per_millisecond = false;
+    }
     initialize_operators();
     initialize_acceptance_criterion();
 }
@@ -192,17 +242,190 @@ void LNSSolver::initialize_operators() {
     destroy_operators.push_back(std::make_unique<lns::AbsenceRemovalOperator>(absence_counter));
     destroy_operators.push_back(std::make_unique<lns::RouteRemovalOperator>());
 
-    // Repair operators chuẩn (chỉ dùng rng)
-    repair_operators.push_back(std::make_unique<lns::repair::GreedyInsertionOperator>());
-    repair_operators.push_back(std::make_unique<lns::repair::RegretInsertionOperator>());
+    std::shared_ptr<const problem::GranularNeighborhood> granular;
+    if (params.granular_k > 0) {
+        granular = std::make_shared<const problem::GranularNeighborhood>(instance, params.granular_k);
+    }
+    create_repair_operators(repair_operators, absence_repair_operators, insertion_cache, granular);
+
+    // Mỗi lane speculative có bộ repair riêng (operator và cache không an toàn khi dùng chung
+    // giữa các thread); rng của lane suy ra từ params.seed
+    if (params.speculative_candidates > 1) {
+        std::seed_seq lane_seeds{params.seed, static_cast<unsigned>(params.speculative_candidates)};
+        std::vector<unsigned> seeds(params.speculative_candidates);
+        lane_seeds.generate(seeds.begin(), seeds.end());
+        for (unsigned lane_seed : seeds) {
+            auto &lane = speculative_lanes.emplace_back(instance, lane_seed);
+            create_repair_operators(lane.repair_operators, lane.absence_repair_operators, lane.insertion_cache, granular);
+        }
+    }
 
-    // Repair operators có nhận biết về absence (dùng absence counter)
-    absence_repair_operators.push_back(std::make_unique<lns::repair::HardestFirstInsertionOperator>());
-    absence_repair_operators.push_back(std::make_unique<lns::repair::AbsenceBasedRegretOperator>());
+    if (params.deterministic) {
+        operator_streams = make_operator_streams(0);
+        for (size_t k = 0; k < speculative_lanes.size(); ++k) {
+            speculative_lanes[k].streams = make_operator_streams(static_cast<unsigned>(k + 1));
+        }
+    }
 
-    // Khởi tạo thống kê (4 destroy + 2 standard + 2 absence = 8)
+    // Khởi tạo thống kê (4 destroy + 3 standard + 2 absence = 9)
     stats.destroy_stats.resize(destroy_operators.size());
     stats.repair_stats.resize(repair_operators.size() + absence_repair_operators.size());
+
+    destroy_weights = lns::AdaptiveOperatorWeights(destroy_operators.size(), params.adaptive_weights);
+    repair_weights = lns::AdaptiveOperatorWeights(stats.repair_stats.size(), params.adaptive_weights);
+}
+
+LNSSolver::OperatorStreams LNSSolver::make_operator_streams(unsigned lane) const {
+    // Luồng (seed, lane, loại operator, chỉ số operator): độc lập với thứ tự dùng operator
+    auto stream = [&](unsigned kind, size_t index) {
+        std::seed_seq seq{params.seed, lane, kind, static_cast<unsigned>(index)};
+        return std::mt19937(seq);
+    };
+    OperatorStreams streams;
+    for (size_t i = 0; i < destroy_operators.size(); ++i) {
+        streams.destroy.push_back(stream(0, i));
+    }
+    for (size_t i = 0; i < repair_operators.size() + absence_repair_operators.size(); ++i) {
+        streams.repair.push_back(stream(1, i));
+    }
+    return streams;
+}
+
+void LNSSolver::create_repair_operators(
+    std::vector<std::unique_ptr<lns::repair::RepairOperator>> &standard,
+    std::vector<std::unique_ptr<lns::repair::AbsenceAwareRepairOperator>> &absence_aware,
+    std::shared_ptr<construction::InsertionCache> &cache,
+    const std::shared_ptr<const problem::GranularNeighborhood> &granular) const {
+    // Repair operators chuẩn (chỉ dùng rng)
+    standard.push_back(std::make_unique<lns::repair::GreedyInsertionOperator>());
+    standard.push_back(std::make_unique<lns::repair::RegretInsertionOperator>());
+    standard.push_back(std::make_unique<lns::repair::BlinkInsertionOperator>(params.blink_rate));
+
+    // Repair operators có nhận biết về absence (dùng absence counter)
+    absence_aware.push_back(std::make_unique<lns::repair::HardestFirstInsertionOperator>());
+    absence_aware.push_back(std::make_unique<lns::repair::AbsenceBasedRegretOperator>());
+
+    // Các repair operator của một bộ dùng chung một cache vị trí chèn (cùng chạy trên một solution)
+    cache = std::make_shared<construction::InsertionCache>();
+    if (granular) {
+        cache->set_granular(granular);
+    }
+    for (auto &op : standard) {
+        op->set_insertion_cache(cache);
+    }
+    for (auto &op : absence_aware) {
+        op->set_insertion_cache(cache);
+    }
+}
+
+bool LNSSolver::apply_repair(
+    size_t repair_idx,
+    std::vector<std::unique_ptr<lns::repair::RepairOperator>> &standard,
+    std::vector<std::unique_ptr<lns::repair::AbsenceAwareRepairOperator>> &absence_aware,
+    Solution &solution,
+    std::optional<double> cutoff,
+    std::mt19937 &lane_rng) {
+    if (repair_idx < standard.size()) {
+        // Standard repair operator (uses rng only)
+        auto &repair_op = standard[repair_idx];
+        repair_op->set_cost_cutoff(cutoff);
+        repair_op->repair(solution, lane_rng);
+        return repair_op->aborted();
+    }
+
+    // Absence-aware repair operator
+    auto &absence_op = absence_aware[repair_idx - standard.size()];
+    absence_op->set_cost_cutoff(cutoff);
+    absence_op->repair(solution, absence_counter, lane_rng);
+    return absence_op->aborted();
+}
+
+void LNSSolver::run_speculative_lane(SpeculativeLane &lane, int destroy_size, std::optional<double> cutoff) {
+    auto lane_start = std::chrono::steady_clock::now();
+    lane.failed = false;
+    lane.aborted = false;
+
+    std::mt19937 &destroy_rng = params.deterministic ? lane.streams.destroy[lane.destroy_idx] : lane.rng;
+    std::mt19937 &repair_rng = params.deterministic ? lane.streams.repair[lane.repair_idx] : lane.rng;
+
+    lane.scratch.begin_transaction();
+    try {
+        destroy_operators[lane.destroy_idx]->destroy(lane.scratch, destroy_size, destroy_rng);
+        lane.aborted = apply_repair(lane.repair_idx, lane.repair_operators, lane.absence_repair_operators,
+                                    lane.scratch, cutoff, repair_rng);
+    } catch (const std::exception &) {
+        lane.failed = true;
+    }
+    lane.objective = lane.scratch.objective();
+    lane.elapsed_ms = std::chrono::duration<double, std::milli>(
+                          std::chrono::steady_clock::now() - lane_start)
+                          .count();
+}
+
+std::optional<size_t> LNSSolver::run_speculative_candidates(int destroy_size, std::optional<double> cutoff) {
+    // Chọn operator cho từng lane theo thứ tự cố định trên rng chính, rồi đồng bộ scratch
+    for (auto &lane : speculative_lanes) {
+        rotate_operators();
+        lane.destroy_idx = current_destroy_idx;
+        lane.repair_idx = current_repair_idx;
+        if (lane.stale) {
+            lane.scratch = current_solution;
+            lane.stale = false;
+        }
+    }
+
+    // Mỗi lane chỉ đọc instance, current và absence counter; tìm vị trí chèn lồng bên trong
+    // chạy tuần tự trên thread của lane
+    utils::ThreadPool::global().parallel_for(speculative_lanes.size(), 1, [&](size_t begin, size_t end, size_t) {
+        for (size_t k = begin; k < end; ++k) {
+            run_speculative_lane(speculative_lanes[k], destroy_size, cutoff);
+        }
+    });
+
+    // Ứng viên = lane hoàn tất có objective nhỏ nhất (hoà thì lane chỉ số nhỏ); nếu mọi lane
+    // đều dừng sớm thì lấy lane dừng sớm đầu tiên (chắc chắn bị từ chối)
+    std::optional<size_t> winner;
+    for (size_t k = 0; k < speculative_lanes.size(); ++k) {
+        const auto &lane = speculative_lanes[k];
+        if (lane.failed) {
+            continue;
+        }
+        if (lane.aborted) {
+            stats.aborted_repairs++;
+            if (!winner) {
+                winner = k;
+            }
+            continue;
+        }
+        absence_counter.update(lane.scratch);
+        if (!winner || speculative_lanes[*winner].aborted || lane.objective < speculative_lanes[*winner].objective) {
+            winner = k;
+        }
+    }
+    return winner;
+}
+
+void LNSSolver::finish_speculative(std::optional<size_t> accepted_lane) {
+    for (size_t k = 0; k < speculative_lanes.size(); ++k) {
+        if (!accepted_lane || *accepted_lane != k) {
+            speculative_lanes[k].scratch.rollback_transaction();
+        }
+    }
+    if (!accepted_lane) {
+        return;
+    }
+
+    // Chỉ chép các route lane thắng đã chạm vào current và các lane khác (không copy cả
+    // Solution): uid giữ nguyên nên cache chèn của từng lane chỉ tính lại các route này
+    auto &winner = speculative_lanes[*accepted_lane];
+    const std::vector<size_t> changed_routes = winner.scratch.journaled_routes();
+    winner.scratch.commit_transaction();
+    current_solution.replay_routes(winner.scratch, changed_routes);
+    for (size_t k = 0; k < speculative_lanes.size(); ++k) {
+        if (k != *accepted_lane && !speculative_lanes[k].stale) {
+            speculative_lanes[k].scratch.replay_routes(winner.scratch, changed_routes);
+        }
+    }
 }
 
 void LNSSolver::initialize_acceptance_criterion() {
@@ -270,6 +493,12 @@ int LNSSolver::compute_destroy_size(int iteration) const {
 }
 
 void LNSSolver::rotate_operators() {
+    if (params.operator_selection == LNSSolverParams::OperatorSelection::ADAPTIVE) {
+        current_destroy_idx = destroy_weights.select(rng);
+        current_repair_idx = repair_weights.select(rng);
+        return;
+    }
+
     // Xoay vòng round-robin qua tất cả operators
     current_destroy_idx = (current_destroy_idx + 1) % destroy_operators.size();
 
@@ -280,7 +509,7 @@ void LNSSolver::rotate_operators() {
 
 void LNSSolver::update_statistics(
     int iteration,
-    const Solution &new_solution,
+    Num new_obj,
     bool accepted,
     bool improved,
     bool new_best) {
@@ -292,11 +521,24 @@ void LNSSolver::update_statistics(
 
     if (improved) {
         stats.improving_solutions++;
+    }
+
+    if (new_best) {
+        stats.new_best_solutions++;
+        stats.best_objective = new_obj;
+    }
+}
 
-        // Cập nhật thống kê operators
-        auto &destroy_stat = stats.destroy_stats[current_destroy_idx];
-        auto &repair_stat = stats.repair_stats[current_repair_idx];
+void LNSSolver::record_operator_use(
+    size_t destroy_idx,
+    size_t repair_idx,
+    double improvement,
+    bool new_best,
+    double elapsed_ms) {
+    auto &destroy_stat = stats.destroy_stats[destroy_idx];
+    auto &repair_stat = stats.repair_stats[repair_idx];
 
+    if (improvement > 0.0) {
         destroy_stat.times_improved++;
         repair_stat.times_improved++;
 
@@ -306,25 +548,29 @@ void LNSSolver::update_statistics(
         }
     }
 
-    if (new_best) {
-        stats.new_best_solutions++;
-        stats.best_objective = new_solution.objective();
-    }
-
     // Cập nhật số lần sử dụng
-    stats.destroy_stats[current_destroy_idx].times_used++;
-    stats.repair_stats[current_repair_idx].times_used++;
+    destroy_stat.times_used++;
+    repair_stat.times_used++;
+    destroy_stat.total_ms += elapsed_ms;
+    repair_stat.total_ms += elapsed_ms;
+
+    // Reward của operator: cải thiện so với current trên thời gian destroy + repair
+    if (params.operator_selection == LNSSolverParams::OperatorSelection::ADAPTIVE) {
+        double cost = params.adaptive_weights.per_millisecond ? elapsed_ms : 1.0;
+        destroy_weights.record(destroy_idx, improvement, cost);
+        repair_weights.record(repair_idx, improvement, cost);
+    }
 }
 
-void LNSSolver::log_iteration(int iteration, const Solution &new_solution, bool accepted) const {
+void LNSSolver::log_iteration(int iteration, Num new_obj, bool accepted) const {
     if (!params.verbose || iteration % params.log_frequency != 0) {
         return;
     }
 
     std::cout << "Iter " << std::setw(4) << iteration
-              << " | Best: " << std::setw(8) << best_solution.objective()
+              << " | Best: " << std::setw(8) << best_snapshot.objective()
               << " | Current: " << std::setw(8) << current_solution.objective()
-              << " | New: " << std::setw(8) << new_solution.objective()
+              << " | New: " << std::setw(8) << new_obj
               << " | " << (accepted ? "ACCEPT" : "REJECT")
               << " | Temp: " << std::fixed << std::setprecision(4)
               << acceptance_criterion->get_temperature()
@@ -332,6 +578,31 @@ void LNSSolver::log_iteration(int iteration, const Solution &new_solution, bool
               << "\n";
 }
 
+void LNSSolver::set_sync(int interval, SyncCallback callback) {
+    sync_interval = interval;
+    sync_callback = std::move(callback);
+}
+
+bool LNSSolver::synchronize(int iteration) {
+    best_snapshot.restore_into(best_solution);
+    const Solution *restart = sync_callback(iteration, best_solution);
+    if (restart == nullptr) {
+        return false;
+    }
+
+    // Khởi động lại current từ lời giải được chia sẻ (copy có uid mới nên cache tự làm mới)
+    current_solution = *restart;
+    for (auto &lane : speculative_lanes) {
+        lane.stale = true;
+    }
+    if (current_solution.objective() < best_snapshot.objective()) {
+        best_snapshot.capture(current_solution);
+        stats.best_objective = current_solution.objective();
+        return true;
+    }
+    return false;
+}
+
 Solution LNSSolver::solve(const Solution &initial_solution) {
     auto start_time = std::chrono::high_resolution_clock::now();
 
@@ -341,9 +612,14 @@ Solution LNSSolver::solve(const Solution &initial_solution) {
     // Khởi tạo solutions
     current_solution = Solution(initial_solution);
     best_solution = Solution(initial_solution);
+    best_snapshot.capture(current_solution);
+    for (auto &lane : speculative_lanes) {
+        lane.stale = true;
+    }
 
     stats.initial_objective = initial_solution.objective();
     stats.best_objective = initial_solution.objective();
+    stats.best_trace.assign(1, {0.0, initial_solution.objective()});
 
     if (params.verbose) {
         std::cout << "\n========================================\n";
@@ -359,6 +635,11 @@ Solution LNSSolver::solve(const Solution &initial_solution) {
 
     int iterations_without_improvement = 0;
 
+    // Cặp operator đầu tiên cũng chọn theo roulette
+    if (params.operator_selection == LNSSolverParams::OperatorSelection::ADAPTIVE) {
+        rotate_operators();
+    }
+
     // Kết thúc sớm nếu solution ban đầu rỗng (không có requests)
     if (initial_solution.objective() == 0) {
         if (params.verbose) {
@@ -388,6 +669,12 @@ Solution LNSSolver::solve(const Solution &initial_solution) {
             break;
         }
 
+        // Đồng bộ định kỳ (đầu iteration để không bị các nhánh continue bỏ qua);
+        // best nhận từ solver khác cũng tính là cải thiện
+        if (sync_callback && sync_interval > 0 && iter > 0 && iter % sync_interval == 0 && synchronize(iter)) {
+            iterations_without_improvement = 0;
+        }
+
         // Update acceptance criterion temperature
         acceptance_criterion->update(iter, params.max_iterations);
 
@@ -402,86 +689,157 @@ Solution LNSSolver::solve(const Solution &initial_solution) {
             continue;
         }
 
-        // Create a copy to modify
-        Solution new_solution = current_solution;
-
-        // Apply destroy operator
-        auto &destroy_op = destroy_operators[current_destroy_idx];
-        destroy_op->destroy(new_solution, destroy_size);
+        // Destroy/repair trực tiếp trên current_solution (hoặc trên scratch của các lane
+        // speculative); nếu bị từ chối thì rollback theo journal
+        auto iteration_start = std::chrono::steady_clock::now();
+        Num current_obj = current_solution.objective();
+        Num best_obj = best_snapshot.objective();
 
-        // Apply repair operator: either standard (RepairOperator) or absence-aware (AbsenceAwareRepairOperator)
-        size_t total_standard = repair_operators.size();
-        size_t repair_stat_idx;
+        // Ngưỡng chấp nhận tính trước để repair dừng sớm khi lời giải chắc chắn bị từ chối
+        Num bound = acceptance_criterion->acceptance_bound(current_obj, best_obj, rng);
+        std::optional<double> cutoff;
+        if (params.repair_cutoff) {
+            cutoff = bound;
+        }
 
-        try {
-            if (current_repair_idx < total_standard) {
-                // Standard repair operator (uses rng only)
-                auto &repair_op = repair_operators[current_repair_idx];
-                repair_op->repair(new_solution, rng);
-                repair_stat_idx = current_repair_idx;
-            } else {
-                // Absence-aware repair operator
-                size_t absence_idx = current_repair_idx - total_standard;
-                auto &absence_op = absence_repair_operators[absence_idx];
-                absence_op->repair(new_solution, absence_counter, rng);
-                repair_stat_idx = current_repair_idx;
+        // Lời giải được xét acceptance: current_solution, hoặc scratch của lane tốt nhất
+        Solution *candidate = &current_solution;
+        std::optional<size_t> winner;
+        bool aborted = false;
+
+        if (!speculative_lanes.empty()) {
+            winner = run_speculative_candidates(destroy_size, cutoff);
+            if (!winner) {
+                finish_speculative(std::nullopt);
+                if (params.verbose && iter % 10 == 0) {
+                    std::cout << "Warning: All speculative repairs failed at iteration " << iter << "\n";
+                }
+                continue;
             }
-        } catch (const std::exception &e) {
-            // Repair failed - skip this iteration
-            if (params.verbose && iter % 10 == 0) {
-                std::cout << "Warning: Repair failed at iteration " << iter
-                          << ": " << e.what() << "\n";
+            candidate = &speculative_lanes[*winner].scratch;
+            aborted = speculative_lanes[*winner].aborted;
+            current_destroy_idx = speculative_lanes[*winner].destroy_idx;
+            current_repair_idx = speculative_lanes[*winner].repair_idx;
+        } else {
+            current_solution.begin_transaction();
+            std::mt19937 &destroy_rng = params.deterministic ? operator_streams.destroy[current_destroy_idx] : rng;
+            std::mt19937 &repair_rng = params.deterministic ? operator_streams.repair[current_repair_idx] : rng;
+
+            // Apply destroy operator
+            auto &destroy_op = destroy_operators[current_destroy_idx];
+            destroy_op->destroy(current_solution, destroy_size, destroy_rng);
+
+            // Apply repair operator: either standard (RepairOperator) or absence-aware (AbsenceAwareRepairOperator)
+            try {
+                aborted = apply_repair(current_repair_idx, repair_operators, absence_repair_operators,
+                                       current_solution, cutoff, repair_rng);
+            } catch (const std::exception &e) {
+                // Repair failed - skip this iteration
+                current_solution.rollback_transaction();
+                if (params.verbose && iter % 10 == 0) {
+                    std::cout << "Warning: Repair failed at iteration " << iter
+                              << ": " << e.what() << "\n";
+                }
+                rotate_operators();
+                continue;
             }
-            rotate_operators();
-            continue;
         }
 
         if (time_limit.is_finished()) {
+            if (speculative_lanes.empty()) {
+                current_solution.rollback_transaction();
+            } else {
+                finish_speculative(std::nullopt);
+            }
             if (params.verbose) {
                 std::cout << "\nTerminating: Time limit reached after repair at iteration " << iter << "\n";
             }
             break;
         }
 
-        // Update absence counter based on what's unassigned
-        absence_counter.update(new_solution);
+        // Repair dừng sớm: lời giải dở dang không được tính vào absence counter và được
+        // coi là objective vô cùng (accept() luôn từ chối, không thể là best mới).
+        // Các lane speculative đã được tính trong run_speculative_candidates().
+        if (speculative_lanes.empty()) {
+            if (aborted) {
+                stats.aborted_repairs++;
+            } else {
+                absence_counter.update(current_solution);
+            }
+        }
 
         // Evaluate new solution
-        Num new_obj = new_solution.objective();
-        Num current_obj = current_solution.objective();
-        Num best_obj = best_solution.objective();
+        Num new_obj = aborted ? std::numeric_limits<Num>::infinity() : candidate->objective();
 
         // Check acceptance
         bool improved = new_obj < current_obj;
         bool new_best = new_obj < best_obj;
         bool accepted = acceptance_criterion->accept(new_obj, current_obj, best_obj, rng);
 
-        // Update solutions
-        if (accepted) {
-            current_solution = new_solution;
-            iterations_without_improvement = new_best ? 0 : iterations_without_improvement + 1;
+        if (speculative_lanes.empty()) {
+            double elapsed_ms = std::chrono::duration<double, std::milli>(
+                                    std::chrono::steady_clock::now() - iteration_start)
+                                    .count();
+            double improvement = improved ? static_cast<double>(current_obj - new_obj) : 0.0;
+            record_operator_use(current_destroy_idx, current_repair_idx, improvement, new_best, elapsed_ms);
         } else {
-            iterations_without_improvement++;
+            // Mỗi lane ghi nhận cải thiện của chính nó so với current, theo thứ tự lane
+            for (size_t k = 0; k < speculative_lanes.size(); ++k) {
+                const auto &lane = speculative_lanes[k];
+                if (lane.failed) {
+                    continue;
+                }
+                double improvement = !lane.aborted && lane.objective < current_obj
+                                         ? static_cast<double>(current_obj - lane.objective)
+                                         : 0.0;
+                record_operator_use(lane.destroy_idx, lane.repair_idx, improvement, k == *winner && new_best,
+                                    lane.elapsed_ms);
+            }
         }
 
+        // Snapshot best trước khi commit/rollback: chỉ các route đã thay đổi được trích xuất lại
         if (new_best) {
-            best_solution = new_solution;
+            best_snapshot.capture(*candidate);
+            stats.best_trace.emplace_back(
+                std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start_time).count(),
+                new_obj);
 
             if (params.verbose) {
                 std::cout << "*** NEW BEST at iteration " << iter
                           << ": " << best_obj << " -> " << new_obj
                           << " (improvement: " << (best_obj - new_obj) << ")\n";
             }
+            if (new_best_callback) {
+                new_best_callback(new_obj);
+            }
+        }
+
+        // Update solutions
+        if (speculative_lanes.empty()) {
+            if (accepted) {
+                current_solution.commit_transaction();
+            } else {
+                current_solution.rollback_transaction();
+            }
+        } else {
+            finish_speculative(accepted ? winner : std::nullopt);
+        }
+        if (accepted) {
+            iterations_without_improvement = new_best ? 0 : iterations_without_improvement + 1;
+        } else {
+            iterations_without_improvement++;
         }
 
         // Update statistics
-        update_statistics(iter, new_solution, accepted, improved, new_best);
+        update_statistics(iter, new_obj, accepted, improved, new_best);
 
         // Log iteration
-        log_iteration(iter, new_solution, accepted);
+        log_iteration(iter, new_obj, accepted);
 
-        // Rotate operators for next iteration
-        rotate_operators();
+        // Rotate operators for next iteration (lane speculative tự chọn khi bắt đầu iteration)
+        if (speculative_lanes.empty()) {
+            rotate_operators();
+        }
 
         // Check termination criteria
         if (iterations_without_improvement >= params.max_non_improving_iterations) {
@@ -497,6 +855,19 @@ Solution LNSSolver::solve(const Solution &initial_solution) {
     std::chrono::duration<double> elapsed = end_time - start_time;
     stats.total_time_seconds = elapsed.count();
     stats.final_objective = current_solution.objective();
+    stats.insertion_stats = insertion_cache->stats();
+    for (const auto &lane : speculative_lanes) {
+        stats.insertion_stats += lane.insertion_cache->stats();
+    }
+    for (size_t i = 0; i < stats.destroy_stats.size(); ++i) {
+        stats.destroy_stats[i].weight = destroy_weights.weights()[i];
+    }
+    for (size_t i = 0; i < stats.repair_stats.size(); ++i) {
+        stats.repair_stats[i].weight = repair_weights.weights()[i];
+    }
+
+    // Dựng lại best solution từ snapshot
+    best_snapshot.restore_into(best_solution);
 
     if (params.verbose) {
         stats.print_summary();
@@ -0,0 +1,172 @@
+#include "pdptw/solver/parallel_lns_solver.hpp"
+#include <algorithm>
+#include <exception>
+#include <iostream>
+#include <limits>
+#include <thread>
+
+namespace pdptw {
+
+ParallelLNSSolver::ParallelLNSSolver(const PDPTWInstance &inst, const ParallelLNSSolverParams &params)
+    : instance_(inst),
+      params_(params),
+      global_best_objective_(std::numeric_limits<Num>::infinity()) {
+    params_.num_threads = std::max<size_t>(1, params_.num_threads);
+}
+
+LNSSolverParams ParallelLNSSolver::worker_params(const ParallelLNSSolverParams &params, size_t worker) {
+    LNSSolverParams p = params.base;
+    p.seed = params.base.seed + static_cast<unsigned>(worker);
+    p.verbose = false;
+    // Trọng số operator theo thời gian đo phụ thuộc tải của các thread khác
+    p.adaptive_weights.per_millisecond = false;
+
+    // Worker lẻ đổi SA <-> RTR (temperature mặc định của CLI); mỗi cặp worker tăng nhiệt độ
+    // ban đầu thêm 25% để các worker khám phá với mức chấp nhận khác nhau
+    if (params.mix_acceptance && worker % 2 == 1) {
+        if (p.acceptance_type == LNSSolverParams::AcceptanceType::SIMULATED_ANNEALING) {
+            p.acceptance_type = LNSSolverParams::AcceptanceType::RECORD_TO_RECORD;
+            p.initial_temperature = 0.0333;
+            p.final_temperature = 0.0;
+        } else if (p.acceptance_type == LNSSolverParams::AcceptanceType::RECORD_TO_RECORD) {
+            p.acceptance_type = LNSSolverParams::AcceptanceType::SIMULATED_ANNEALING;
+            p.initial_temperature = 0.5;
+            p.final_temperature = 0.05;
+        }
+    }
+    p.initial_temperature *= 1.0 + 0.25 * static_cast<double>(worker / 2);
+    return p;
+}
+
+void ParallelLNSSolver::publish_objective(Num objective) {
+    Num current = global_best_objective_.load(std::memory_order_relaxed);
+    while (objective < current &&
+           !global_best_objective_.compare_exchange_weak(current, objective, std::memory_order_relaxed)) {
+    }
+}
+
+const Solution *ParallelLNSSolver::synchronize(size_t worker, const Solution &best) {
+    std::unique_lock<std::mutex> lock(sync_mutex_);
+
+    // Best kém hơn best toàn cục thì không thể thắng vòng này: bỏ qua bản sao
+    if (best.objective() <= best_objective()) {
+        candidates_[worker].emplace(best);
+    }
+
+    const size_t generation = generation_;
+    arrived_++;
+    try_complete_round();
+    sync_cv_.wait(lock, [&] { return generation_ != generation; });
+
+    if (shared_best_ && shared_best_->objective() < best.objective()) {
+        restarts_++;
+        return &*shared_best_;
+    }
+    return nullptr;
+}
+
+void ParallelLNSSolver::depart(size_t worker, Solution result) {
+    std::lock_guard<std::mutex> lock(sync_mutex_);
+    candidates_[worker].emplace(std::move(result));
+    finished_[worker] = true;
+    active_workers_--;
+    try_complete_round();
+}
+
+void ParallelLNSSolver::try_complete_round() {
+    if (arrived_ == 0 || arrived_ < active_workers_) {
+        return;
+    }
+
+    // Best chung = ứng viên objective nhỏ nhất, hoà thì worker chỉ số nhỏ hơn
+    std::optional<size_t> winner;
+    for (size_t w = 0; w < candidates_.size(); ++w) {
+        if (candidates_[w] && (!winner || candidates_[w]->objective() < candidates_[*winner]->objective())) {
+            winner = w;
+        }
+    }
+    if (winner && (!shared_best_ || candidates_[*winner]->objective() < shared_best_->objective())) {
+        shared_best_.emplace(*candidates_[*winner]);
+    }
+
+    for (size_t w = 0; w < candidates_.size(); ++w) {
+        if (!finished_[w]) {
+            candidates_[w].reset();
+        }
+    }
+    arrived_ = 0;
+    generation_++;
+    sync_cv_.notify_all();
+}
+
+Solution ParallelLNSSolver::solve(const Solution &initial_solution) {
+    const size_t n = params_.num_threads;
+    global_best_objective_.store(initial_solution.objective(), std::memory_order_relaxed);
+    active_workers_ = n;
+    arrived_ = 0;
+    generation_ = 0;
+    candidates_.assign(n, std::nullopt);
+    finished_.assign(n, false);
+    shared_best_.reset();
+    restarts_ = 0;
+    worker_stats_.assign(n, LNSStatistics());
+
+    if (params_.base.verbose) {
+        std::cout << "\nStarting parallel LNS: " << n << " workers, sync every "
+                  << params_.sync_interval << " iterations\n";
+    }
+
+    std::vector<std::exception_ptr> errors(n);
+    std::vector<std::thread> threads;
+    threads.reserve(n);
+    for (size_t w = 0; w < n; ++w) {
+        threads.emplace_back([this, w, &initial_solution, &errors] {
+            Solution result = initial_solution;
+            try {
+                LNSSolver solver(instance_, worker_params(params_, w));
+                solver.set_new_best_callback([this](Num objective) { publish_objective(objective); });
+                if (params_.sync_interval > 0) {
+                    solver.set_sync(params_.sync_interval, [this, w](int, const Solution &best) {
+                        return synchronize(w, best);
+                    });
+                }
+                result = solver.solve(initial_solution);
+                worker_stats_[w] = solver.get_statistics();
+            } catch (...) {
+                errors[w] = std::current_exception();
+            }
+            // Luôn rời điểm đồng bộ để các worker khác không chờ mãi
+            depart(w, std::move(result));
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    for (const auto &error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    // Kết quả = kết quả cuối tốt nhất, hoà thì worker chỉ số nhỏ hơn
+    best_worker_ = 0;
+    for (size_t w = 1; w < n; ++w) {
+        if (candidates_[w]->objective() < candidates_[best_worker_]->objective()) {
+            best_worker_ = w;
+        }
+    }
+
+    if (params_.base.verbose) {
+        for (size_t w = 0; w < n; ++w) {
+            const auto &s = worker_stats_[w];
+            std::cout << "Worker " << w << ": iterations=" << s.total_iterations
+                      << ", best=" << candidates_[w]->objective()
+                      << (w == best_worker_ ? " (selected)" : "") << "\n";
+        }
+        std::cout << "Restarts from shared best: " << restarts_ << "\n";
+    }
+
+    return *candidates_[best_worker_];
+}
+
+} // namespace pdptw
@@ -0,0 +1,102 @@
+#include "pdptw/utils/mapped_file.hpp"
+
+#include <stdexcept>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace pdptw::utils {
+
+#ifdef _WIN32
+
+std::shared_ptr<const MappedFile> MappedFile::open(const std::string &path) {
+    std::shared_ptr<MappedFile> file(new MappedFile());
+
+    HANDLE handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Cannot open file: " + path);
+    }
+    file->file_handle_ = handle;
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(handle, &file_size)) {
+        throw std::runtime_error("Cannot stat file: " + path);
+    }
+    file->size_ = static_cast<size_t>(file_size.QuadPart);
+    if (file->size_ == 0) {
+        return file;
+    }
+
+    HANDLE mapping = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        throw std::runtime_error("Cannot map file: " + path);
+    }
+    file->mapping_handle_ = mapping;
+
+    void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view == nullptr) {
+        throw std::runtime_error("Cannot map file: " + path);
+    }
+    file->data_ = static_cast<const std::byte *>(view);
+    return file;
+}
+
+MappedFile::~MappedFile() {
+    if (data_ != nullptr) {
+        UnmapViewOfFile(data_);
+    }
+    if (mapping_handle_ != nullptr) {
+        CloseHandle(mapping_handle_);
+    }
+    if (file_handle_ != nullptr) {
+        CloseHandle(file_handle_);
+    }
+}
+
+#else
+
+std::shared_ptr<const MappedFile> MappedFile::open(const std::string &path) {
+    std::shared_ptr<MappedFile> file(new MappedFile());
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open file: " + path);
+    }
+
+    struct stat st {};
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Cannot stat file: " + path);
+    }
+    file->size_ = static_cast<size_t>(st.st_size);
+    if (file->size_ == 0) {
+        ::close(fd);
+        return file;
+    }
+
+    void *addr = ::mmap(nullptr, file->size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // mapping vẫn giữ file sau khi đóng fd
+    if (addr == MAP_FAILED) {
+        throw std::runtime_error("Cannot map file: " + path);
+    }
+    file->data_ = static_cast<const std::byte *>(addr);
+    return file;
+}
+
+MappedFile::~MappedFile() {
+    if (data_ != nullptr) {
+        ::munmap(const_cast<std::byte *>(data_), size_);
+    }
+}
+
+#endif
+
+} // namespace pdptw::utils
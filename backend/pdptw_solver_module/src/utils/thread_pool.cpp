@@ -0,0 +1,145 @@
+#include "pdptw/utils/thread_pool.hpp"
+#include <algorithm>
+#include <memory>
+
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif
+
+namespace pdptw::utils {
+
+namespace {
+
+thread_local bool in_parallel_region_ = false;
+
+std::mutex global_mutex_;
+std::unique_ptr<ThreadPool> global_pool_;
+
+} // namespace
+
+ThreadPool::ThreadPool(size_t num_threads) {
+    const size_t extra = num_threads > 1 ? num_threads - 1 : 0;
+    workers_.reserve(extra);
+    for (size_t w = 1; w <= extra; ++w) {
+        workers_.emplace_back([this, w] { worker_loop(w); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto &worker : workers_) {
+        worker.join();
+    }
+}
+
+bool ThreadPool::in_parallel_region() {
+    return in_parallel_region_;
+}
+
+ThreadPool &ThreadPool::global() {
+    std::lock_guard<std::mutex> lock(global_mutex_);
+    if (!global_pool_) {
+        global_pool_ = std::make_unique<ThreadPool>(default_threads());
+    }
+    return *global_pool_;
+}
+
+void ThreadPool::set_global_threads(size_t num_threads) {
+    std::lock_guard<std::mutex> lock(global_mutex_);
+    global_pool_.reset();
+    global_pool_ = std::make_unique<ThreadPool>(std::max<size_t>(1, num_threads));
+}
+
+size_t ThreadPool::default_threads() {
+#ifdef USE_OPENMP
+    return static_cast<size_t>(std::max(1, omp_get_max_threads()));
+#else
+    return std::max(1u, std::thread::hardware_concurrency());
+#endif
+}
+
+void ThreadPool::run_chunks(size_t worker) {
+    in_parallel_region_ = true;
+    try {
+        while (true) {
+            size_t begin = next_.fetch_add(grain_, std::memory_order_relaxed);
+            if (begin >= size_) {
+                break;
+            }
+            (*body_)(begin, std::min(size_, begin + grain_), worker);
+        }
+    } catch (...) {
+        // Bỏ các khối còn lại, giữ exception đầu tiên cho thread gọi
+        next_.store(size_, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!error_) {
+            error_ = std::current_exception();
+        }
+    }
+    in_parallel_region_ = false;
+}
+
+void ThreadPool::worker_loop(size_t worker) {
+    uint64_t seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+            if (stop_) {
+                return;
+            }
+            seen = generation_;
+        }
+
+        run_chunks(worker);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (--active_ == 0) {
+            done_.notify_one();
+        }
+    }
+}
+
+void ThreadPool::parallel_for(size_t n, size_t grain, RangeBody body) {
+    if (n == 0) {
+        return;
+    }
+    grain = std::max<size_t>(1, grain);
+
+    std::unique_lock<std::mutex> submit(submit_mutex_, std::defer_lock);
+    if (workers_.empty() || n <= grain || in_parallel_region_ || !submit.try_lock()) {
+        body(0, n, 0);
+        return;
+    }
+
+    body_ = &body;
+    size_ = n;
+    grain_ = grain;
+    next_.store(0, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        error_ = nullptr;
+        active_ = workers_.size();
+        ++generation_;
+    }
+    wake_.notify_all();
+
+    run_chunks(0);
+
+    std::exception_ptr error;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [&] { return active_ == 0; });
+        error = error_;
+        body_ = nullptr;
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+} // namespace pdptw::utils
@@ -35,7 +35,8 @@ TEST(DestroyTest, RouteRemoval_Single) {
 
     // Remove requests from one route
     RouteRemovalOperator destroy_op;
-    destroy_op.destroy(solution, 1); // Remove 1 request
+    std::mt19937 rng(42);
+    destroy_op.destroy(solution, 1, rng); // Remove 1 request
 
     // Should remove all requests from one route (1 request)
     // Requests removed via unassigned_requests
@@ -72,7 +73,8 @@ TEST(DestroyTest, RouteRemoval_Multiple) {
 
     // Remove requests from routes
     RouteRemovalOperator destroy_op;
-    destroy_op.destroy(solution, 2); // Remove 2 requests
+    std::mt19937 rng(42);
+    destroy_op.destroy(solution, 2, rng); // Remove 2 requests
 
     // Should remove requests (exact count depends on route selection)
     // Requests removed via unassigned_requests
@@ -97,10 +99,11 @@ TEST(DestroyTest, WorstRemoval_CostCalculation) {
     solution.unassigned_requests().remove(pickup1);
 
     WorstRemovalOperator destroy_op;
+    std::mt19937 rng(42);
 
     // Calculate cost contributions
     // This is tested implicitly through destroy behavior
-    destroy_op.destroy(solution, 1);
+    destroy_op.destroy(solution, 1, rng);
 
     // Requests removed via unassigned_requests
     EXPECT_EQ(solution.unassigned_requests().count(), 1);
@@ -123,7 +126,8 @@ TEST(DestroyTest, WorstRemoval_SelectsWorst) {
 
     // Remove worst request
     WorstRemovalOperator destroy_op;
-    destroy_op.destroy(solution, 1);
+    std::mt19937 rng(42);
+    destroy_op.destroy(solution, 1, rng);
 
     // Requests removed via unassigned_requests
     EXPECT_EQ(solution.unassigned_requests().count(), 1);
@@ -142,17 +146,44 @@ TEST(DestroyTest, WorstRemoval_Randomization) {
     }
 
     WorstRemovalOperator destroy_op;
+    std::mt19937 rng(42);
 
     // Remove multiple times, should get some variety due to randomization
     // Note: With void return, we verify via solution state changes
     for (int i = 0; i < 5; ++i) {
         Solution sol_copy = solution;
-        destroy_op.destroy(sol_copy, 1);
+        destroy_op.destroy(sol_copy, 1, rng);
         // Verify request was removed via unassigned count
         EXPECT_GE(sol_copy.unassigned_requests().count(), 1);
     }
 }
 
+TEST(DestroyTest, WorstRemoval_SameRngSameRemoval) {
+    auto instance = create_test_instance(5);
+    Solution solution(instance);
+
+    size_t vn_start = 0;
+    for (size_t r = 0; r < 5; ++r) {
+        size_t pickup = instance.pickup_id_of_request(r);
+        size_t insert_after = vn_start + r * 2;
+        solution.relink_when_inserting_pd(insert_after, pickup, insert_after, insert_after + 1);
+        solution.unassigned_requests().remove(pickup);
+    }
+
+    // rng truyền theo lần gọi: cùng trạng thái rng thì loại bỏ cùng các request
+    WorstRemovalOperator destroy_op;
+    std::mt19937 rng1(7);
+    std::mt19937 rng2(7);
+    Solution copy1 = solution;
+    Solution copy2 = solution;
+    destroy_op.destroy(copy1, 2, rng1);
+    destroy_op.destroy(copy2, 2, rng2);
+    for (size_t r = 0; r < 5; ++r) {
+        EXPECT_EQ(copy1.is_request_assigned(r), copy2.is_request_assigned(r));
+    }
+    EXPECT_EQ(copy1.unassigned_requests().count(), 2);
+}
+
 // ============================================================================
 // AdjacentStringRemoval Tests
 // ============================================================================
@@ -181,7 +212,8 @@ TEST(DestroyTest, AdjacentString_RemovesRelated) {
     }
 
     AdjacentStringRemovalOperator destroy_op;
-    destroy_op.destroy(solution, 2);
+    std::mt19937 rng(42);
+    destroy_op.destroy(solution, 2, rng);
 
     // Should remove related requests
     // Requests removed via unassigned_requests
@@ -202,10 +234,11 @@ TEST(DestroyTest, AdjacentString_RandomSeed) {
 
     // Different runs should potentially select different strings
     // Note: With void return, we verify via solution state changes
+    std::mt19937 rng(42);
     for (int i = 0; i < 5; ++i) {
         Solution sol_copy = solution;
         AdjacentStringRemovalOperator destroy_op;
-        destroy_op.destroy(sol_copy, 3);
+        destroy_op.destroy(sol_copy, 3, rng);
         // Verify requests were removed via unassigned count
         EXPECT_GE(sol_copy.unassigned_requests().count(), 2);
     }
@@ -228,13 +261,14 @@ TEST(DestroyTest, AbsenceRemoval_UsesCounter) {
     counter.update(solution); // Request 1 will have absence = 1
 
     AbsenceRemovalOperator destroy_op(counter);
+    std::mt19937 rng(42);
 
     // Insert second request now
     size_t pickup1 = instance.pickup_id_of_request(1);
     solution.relink_when_inserting_pd(2, pickup1, 2, 3);
 
     // Remove based on absence
-    destroy_op.destroy(solution, 1);
+    destroy_op.destroy(solution, 1, rng);
 
     // Requests removed via unassigned_requests
     // Should prefer request 1 (higher absence count)
@@ -266,7 +300,8 @@ TEST(DestroyTest, AbsenceRemoval_RemovesLongestAbsent) {
 
     // Remove based on absence
     AbsenceRemovalOperator destroy_op(counter);
-    destroy_op.destroy(solution, 1);
+    std::mt19937 rng(42);
+    destroy_op.destroy(solution, 1, rng);
 
     // Requests removed via unassigned_requests
     // Should prefer request 2 (highest absence count)
@@ -0,0 +1,924 @@
+#include "pdptw/construction/insertion.hpp"
+#include "pdptw/construction/insertion_cache.hpp"
+#include "pdptw/construction/regret_heap.hpp"
+#include "pdptw/lns/absence_counter.hpp"
+#include "pdptw/problem/granular_neighborhood.hpp"
+#include "pdptw/problem/travel_matrix.hpp"
+#include "pdptw/refn/ref_batch.hpp"
+#include "pdptw/solution/datastructure.hpp"
+#include "pdptw/solution/k_ejection.hpp"
+#include "pdptw/solution/permutation.hpp"
+#include "pdptw/utils/thread_pool.hpp"
+#include "pdptw/utils/validator.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <gtest/gtest.h>
+#include <new>
+#include <random>
+#include <stdexcept>
+
+// Đếm số lần cấp phát (mọi thread) trong lúc bật, để kiểm tra các đường "không cấp phát"
+namespace {
+std::atomic<bool> count_allocations{false};
+std::atomic<size_t> allocation_count{0};
+} // namespace
+
+void *operator new(std::size_t size) {
+    if (count_allocations.load(std::memory_order_relaxed)) {
+        allocation_count.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (void *ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::size_t) noexcept { std::free(ptr); }
+
+using namespace pdptw;
+using namespace pdptw::problem;
+using namespace pdptw::solution;
+using namespace pdptw::construction;
+
+namespace {
+
+// Instance ngẫu nhiên có time window hẹp để có cả vị trí khả thi lẫn không khả thi
+// (skew_times: time = distance + 1 trên các cung i < j, ma trận time không đối xứng)
+PDPTWInstance make_random_instance(size_t num_vehicles, size_t num_requests, unsigned seed,
+                                   bool skew_times = false) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> coord(0.0, 100.0);
+    std::uniform_real_distribution<double> ready(0.0, 400.0);
+    std::uniform_real_distribution<double> width(40.0, 200.0);
+    std::uniform_int_distribution<int> demand(5, 30);
+
+    std::vector<Node> nodes;
+    for (size_t v = 0; v < num_vehicles; ++v) {
+        nodes.emplace_back(v * 2, 0, 0, NodeType::Depot, 50.0, 50.0, 0, 0.0, 1000.0, 0.0);
+        nodes.emplace_back(v * 2 + 1, 0, 0, NodeType::Depot, 50.0, 50.0, 0, 0.0, 1000.0, 0.0);
+    }
+    for (size_t r = 0; r < num_requests; ++r) {
+        size_t pickup_id = num_vehicles * 2 + r * 2;
+        int q = demand(rng);
+        double pickup_ready = ready(rng);
+        double pickup_due = pickup_ready + width(rng);
+        nodes.emplace_back(pickup_id, r + 1, r + 1, NodeType::Pickup, coord(rng), coord(rng),
+                           q, pickup_ready, pickup_due, 3.0);
+        nodes.emplace_back(pickup_id + 1, r + 1, r + 1, NodeType::Delivery, coord(rng), coord(rng),
+                           -q, pickup_ready, pickup_due + width(rng), 3.0);
+    }
+
+    const size_t n = nodes.size();
+    auto matrix = std::make_shared<TravelMatrix>(n);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+            double d = std::round(std::hypot(nodes[i].x() - nodes[j].x(), nodes[i].y() - nodes[j].y()));
+            matrix->set_distance(i, j, d);
+            matrix->set_time(i, j, skew_times && i < j ? d + 1.0 : d);
+        }
+    }
+
+    std::vector<Vehicle> vehicles(num_vehicles, Vehicle(60, 1000.0));
+    return PDPTWInstance("evaluator_test", num_requests, num_vehicles,
+                         std::move(nodes), std::move(vehicles), matrix);
+}
+
+// Đánh giá tham chiếu: từng cặp vị trí qua is_feasible_insertion (cùng thứ tự duyệt)
+std::vector<InsertionCandidate> reference_insertions(const Solution &sol, size_t request_id, size_t vehicle_id) {
+    std::vector<InsertionCandidate> out;
+    const size_t depot_end = vehicle_id * 2 + 1;
+    for (size_t p = vehicle_id * 2; p != depot_end; p = sol.succ(p)) {
+        for (size_t d = p; d != depot_end; d = sol.succ(d)) {
+            if (Insertion::is_feasible_insertion(sol, request_id, vehicle_id, p, d)) {
+                out.emplace_back(request_id, vehicle_id, p, d,
+                                 Insertion::calculate_insertion_cost(sol, request_id, vehicle_id, p, d));
+            }
+        }
+    }
+    return out;
+}
+
+// Dựng solution bằng cách chèn tham chiếu tốt nhất cho num_inserted request đầu
+Solution build_reference_solution(const PDPTWInstance &instance, size_t num_inserted) {
+    Solution sol(instance);
+    for (size_t r = 0; r < num_inserted; ++r) {
+        std::vector<InsertionCandidate> all;
+        for (size_t v = 0; v < instance.num_vehicles(); ++v) {
+            auto in_route = reference_insertions(sol, r, v);
+            all.insert(all.end(), in_route.begin(), in_route.end());
+        }
+        if (!all.empty()) {
+            Insertion::insert_request(sol, *std::min_element(all.begin(), all.end()));
+        }
+    }
+    return sol;
+}
+
+} // namespace
+
+TEST(InsertionEvaluatorTest, MatchesPairwiseEvaluation) {
+    size_t total_feasible = 0;
+    size_t total_pairs = 0;
+
+    for (unsigned seed : {1u, 7u, 42u}) {
+        auto instance = make_random_instance(3, 40, seed);
+        Solution sol = build_reference_solution(instance, 30);
+        ASSERT_GT(sol.number_of_non_empty_routes(), 0u);
+
+        for (size_t r = 0; r < instance.num_requests(); ++r) {
+            if (sol.is_request_assigned(r)) {
+                continue;
+            }
+            for (size_t v = 0; v < instance.num_vehicles(); ++v) {
+                auto expected = reference_insertions(sol, r, v);
+                std::vector<InsertionCandidate> actual;
+                total_pairs += Insertion::find_insertions_in_route(sol, r, v, actual);
+
+                ASSERT_EQ(actual.size(), expected.size()) << "seed " << seed << " request " << r << " vehicle " << v;
+                for (size_t i = 0; i < expected.size(); ++i) {
+                    EXPECT_EQ(actual[i].vehicle_id, expected[i].vehicle_id);
+                    EXPECT_EQ(actual[i].pickup_after, expected[i].pickup_after);
+                    EXPECT_EQ(actual[i].delivery_after, expected[i].delivery_after);
+                    EXPECT_EQ(actual[i].cost_increase, expected[i].cost_increase);
+                    EXPECT_TRUE(actual[i].feasible);
+                }
+                total_feasible += expected.size();
+            }
+        }
+    }
+
+    // Cả hai nhánh (khả thi và bị loại) đều phải được dùng tới
+    EXPECT_GT(total_feasible, 0u);
+    EXPECT_GT(total_pairs, total_feasible);
+}
+
+TEST(InsertionEvaluatorTest, BestInsertionUnchangedOnEmptyRoutes) {
+    auto instance = make_random_instance(2, 5, 3);
+    Solution sol(instance);
+
+    for (size_t r = 0; r < instance.num_requests(); ++r) {
+        std::vector<InsertionCandidate> actual;
+        Insertion::find_insertions_in_route(sol, r, 0, actual);
+        auto expected = reference_insertions(sol, r, 0);
+        ASSERT_EQ(actual.size(), expected.size());
+        if (!expected.empty()) {
+            EXPECT_EQ(actual[0].pickup_after, 0u);
+            EXPECT_EQ(actual[0].delivery_after, 0u);
+            EXPECT_EQ(actual[0].cost_increase, expected[0].cost_increase);
+        }
+    }
+}
+
+namespace {
+
+// So sánh cache với tìm kiếm không cache cho mọi request chưa gán
+void expect_cache_matches(InsertionCache &cache, const Solution &sol) {
+    auto unassigned = sol.unassigned_requests().iter_request_ids();
+    for (size_t r : unassigned) {
+        auto expected = Insertion::find_best_insertion(sol, r);
+        auto actual = cache.find_best_insertion(sol, r);
+        ASSERT_EQ(actual.feasible, expected.feasible) << "request " << r;
+        if (expected.feasible) {
+            EXPECT_EQ(actual.cost_increase, expected.cost_increase);
+            EXPECT_TRUE(Insertion::is_feasible_insertion(sol, r, actual.vehicle_id,
+                                                         actual.pickup_after, actual.delivery_after));
+        }
+    }
+
+    auto expected = Insertion::calculate_regret(sol, unassigned, 2);
+    auto actual = cache.calculate_regret(sol, unassigned, 2);
+    ASSERT_EQ(actual.size(), expected.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        EXPECT_EQ(actual[i].request_id, expected[i].request_id);
+        EXPECT_EQ(actual[i].feasible, expected[i].feasible);
+        EXPECT_EQ(actual[i].regret_value, expected[i].regret_value);
+        if (expected[i].feasible) {
+            EXPECT_EQ(actual[i].cost_increase, expected[i].cost_increase);
+        }
+    }
+}
+
+} // namespace
+
+TEST(InsertionCacheTest, MatchesUncachedSearchAcrossEdits) {
+    auto instance = make_random_instance(3, 40, 11);
+    Solution sol = build_reference_solution(instance, 25);
+    InsertionCache cache;
+
+    expect_cache_matches(cache, sol);
+    size_t misses_after_first_pass = cache.misses();
+
+    // Chèn lần lượt: mỗi lần chỉ route vừa đổi phải tính lại
+    size_t inserted = 0;
+    for (size_t r : sol.unassigned_requests().iter_request_ids()) {
+        auto candidate = cache.find_best_insertion(sol, r);
+        if (!candidate.feasible) {
+            continue;
+        }
+        Insertion::insert_request(sol, candidate);
+        expect_cache_matches(cache, sol);
+        if (++inserted == 5) {
+            break;
+        }
+    }
+    ASSERT_GT(inserted, 0u);
+    EXPECT_GT(cache.hits(), 0u);
+    EXPECT_GT(cache.misses(), misses_after_first_pass);
+
+    // Thay đổi bị rollback: route_version trở về giá trị cũ, cache vẫn phải đúng
+    sol.begin_transaction();
+    sol.unassign_request(instance.pickup_id_of_request(0));
+    expect_cache_matches(cache, sol);
+    sol.rollback_transaction();
+    expect_cache_matches(cache, sol);
+
+    // Bản copy có uid khác: cache được làm mới
+    Solution copy = sol;
+    copy.unassign_request(instance.pickup_id_of_request(1));
+    expect_cache_matches(cache, copy);
+    expect_cache_matches(cache, sol);
+}
+
+TEST(InsertionEvaluatorTest, PruningAccountsForEveryPair) {
+    auto instance = make_random_instance(3, 40, 5);
+    Solution sol = build_reference_solution(instance, 30);
+
+    size_t total_pruned = 0;
+    for (size_t r = 0; r < instance.num_requests(); ++r) {
+        if (sol.is_request_assigned(r)) {
+            continue;
+        }
+        for (size_t v = 0; v < instance.num_vehicles(); ++v) {
+            InsertionStats stats;
+            std::vector<InsertionCandidate> out;
+            size_t checked = Insertion::find_insertions_in_route(sol, r, v, out, &stats);
+
+            // Mỗi cặp vị trí hoặc được đánh giá hoặc được đếm là bị loại
+            size_t m = sol.position(v * 2 + 1);
+            EXPECT_EQ(stats.positions_checked, checked);
+            EXPECT_EQ(stats.positions_checked + stats.positions_pruned, m * (m + 1) / 2);
+            EXPECT_EQ(stats.routes_scanned + stats.routes_pruned, 1u);
+            total_pruned += stats.positions_pruned;
+        }
+    }
+    EXPECT_GT(total_pruned, 0u);
+}
+
+TEST(InsertionEvaluatorTest, EmptyRoutesSharedPerVehicleClass) {
+    auto base = make_random_instance(4, 10, 9);
+    std::vector<Vehicle> vehicles = {Vehicle(60, 1000.0), Vehicle(60, 1000.0),
+                                     Vehicle(15, 1000.0), Vehicle(60, 1000.0)};
+    // Mọi depot dùng chung một địa điểm như các reader
+    std::vector<LocationId> locations = base.node_locations();
+    for (size_t i = 0; i < base.num_vehicles() * 2; ++i) {
+        locations[i] = 0;
+    }
+    PDPTWInstance instance("vehicle_classes", base.num_requests(), base.num_vehicles(),
+                           base.nodes(), vehicles, base.shared_travel_matrix(), locations);
+
+    ASSERT_EQ(instance.num_vehicle_classes(), 2u);
+    EXPECT_EQ(instance.vehicle_class(0), instance.vehicle_class(1));
+    EXPECT_EQ(instance.vehicle_class(0), instance.vehicle_class(3));
+    EXPECT_NE(instance.vehicle_class(0), instance.vehicle_class(2));
+
+    Solution sol(instance);
+    for (size_t r = 0; r < instance.num_requests(); ++r) {
+        InsertionStats stats;
+        auto best = Insertion::find_best_insertion(sol, r, InsertionStrategy::BestCost, &stats);
+
+        InsertionCandidate expected;
+        for (size_t v = 0; v < instance.num_vehicles(); ++v) {
+            for (const auto &candidate : reference_insertions(sol, r, v)) {
+                if (candidate < expected) {
+                    expected = candidate;
+                }
+            }
+        }
+        ASSERT_EQ(best.feasible, expected.feasible) << "request " << r;
+        if (expected.feasible) {
+            EXPECT_EQ(best.vehicle_id, expected.vehicle_id);
+            EXPECT_EQ(best.cost_increase, expected.cost_increase);
+        }
+        // Một route rỗng mỗi lớp được duyệt, hai route còn lại dùng lại kết quả
+        EXPECT_EQ(stats.routes_scanned + stats.routes_pruned, instance.num_vehicles());
+        EXPECT_GE(stats.routes_pruned, 2u);
+    }
+}
+
+TEST(InsertionCacheTest, EmptyRoutesShareOneEntryPerVehicleClass) {
+    auto base = make_random_instance(6, 20, 17);
+    std::vector<Vehicle> vehicles = {Vehicle(60, 1000.0), Vehicle(15, 1000.0), Vehicle(60, 1000.0),
+                                     Vehicle(60, 1000.0), Vehicle(15, 1000.0), Vehicle(60, 1000.0)};
+    std::vector<LocationId> locations = base.node_locations();
+    for (size_t i = 0; i < base.num_vehicles() * 2; ++i) {
+        locations[i] = 0;
+    }
+    PDPTWInstance instance("vehicle_classes", base.num_requests(), base.num_vehicles(),
+                           base.nodes(), vehicles, base.shared_travel_matrix(), locations);
+    ASSERT_EQ(instance.num_vehicle_classes(), 2u);
+
+    Solution sol(instance);
+    InsertionCache cache;
+
+    // top-2 của cache phải trùng Insertion::find_top_insertions (kể cả vehicle của route rỗng)
+    auto expect_top_matches = [&] {
+        auto requests = sol.unassigned_requests().iter_request_ids();
+        std::vector<InsertionTopK> tops(requests.size(), InsertionTopK(2));
+        cache.find_top_insertions(sol, requests, tops);
+        for (size_t i = 0; i < requests.size(); ++i) {
+            InsertionTopK expected(2);
+            Insertion::find_top_insertions(sol, requests[i], expected);
+            ASSERT_EQ(tops[i].size(), expected.size()) << "request " << requests[i];
+            for (size_t j = 0; j < expected.size(); ++j) {
+                EXPECT_EQ(tops[i][j].vehicle_id, expected[j].vehicle_id);
+                EXPECT_EQ(tops[i][j].pickup_after, expected[j].pickup_after);
+                EXPECT_EQ(tops[i][j].cost_increase, expected[j].cost_increase);
+            }
+        }
+        EXPECT_LE(cache.slot_capacity(), instance.num_vehicle_classes() + instance.num_vehicles());
+    };
+
+    // Mọi route rỗng: chỉ một entry mỗi lớp xe
+    expect_top_matches();
+    EXPECT_EQ(cache.slot_capacity(), instance.num_vehicle_classes());
+
+    // Route lần lượt có request (nhận slot riêng) ...
+    for (size_t r = 0; r < instance.num_requests(); ++r) {
+        auto candidate = cache.find_best_insertion(sol, r);
+        if (candidate.feasible) {
+            Insertion::insert_request(sol, candidate);
+            expect_top_matches();
+        }
+    }
+    ASSERT_GT(sol.number_of_non_empty_routes(), 1u);
+
+    // ... rồi rỗng trở lại (slot được trả và dùng lại)
+    const size_t capacity = cache.slot_capacity();
+    size_t route_id = sol.iter_route_ids().front();
+    sol.unassign_complete_route(route_id);
+    expect_top_matches();
+    auto candidate = cache.find_best_insertion(sol, instance.num_requests() - 1);
+    if (candidate.feasible) {
+        Insertion::insert_request(sol, candidate);
+    }
+    expect_top_matches();
+    EXPECT_EQ(cache.slot_capacity(), capacity);
+}
+
+TEST(GranularNeighborhoodTest, NeighborsAreNearestCompatibleNodes) {
+    auto instance = make_random_instance(3, 40, 21);
+    GranularNeighborhood granular(instance, 8);
+    const size_t first_request_node = instance.num_vehicles() * 2;
+
+    EXPECT_TRUE(granular.neighbors(0).empty());
+    for (size_t i = first_request_node; i < instance.nodes().size(); ++i) {
+        const auto &neighbors = granular.neighbors(i);
+        EXPECT_LE(neighbors.size(), 8u);
+        EXPECT_TRUE(std::is_sorted(neighbors.begin(), neighbors.end()));
+        for (size_t j : neighbors) {
+            EXPECT_GE(j, first_request_node);
+            EXPECT_NE(j, i);
+            EXPECT_NE(j, i ^ 1);
+            EXPECT_TRUE(granular.is_neighbor(i, j));
+        }
+        // Khe kề node cặp và route rỗng luôn hợp lệ
+        EXPECT_TRUE(granular.allows_gap(i, i ^ 1, 1));
+        EXPECT_TRUE(granular.allows_gap(i, 0, 1));
+    }
+}
+
+TEST(GranularNeighborhoodTest, UnboundedNeighborhoodMatchesFullSearch) {
+    auto instance = make_random_instance(3, 40, 13);
+    Solution sol = build_reference_solution(instance, 30);
+
+    // k đủ lớn: mọi node tương thích đều là láng giềng, nên không mất vị trí khả thi nào
+    GranularNeighborhood granular(instance, instance.nodes().size());
+    for (size_t r = 0; r < instance.num_requests(); ++r) {
+        if (sol.is_request_assigned(r)) {
+            continue;
+        }
+        for (size_t v = 0; v < instance.num_vehicles(); ++v) {
+            std::vector<InsertionCandidate> full;
+            std::vector<InsertionCandidate> restricted;
+            Insertion::find_insertions_in_route(sol, r, v, full);
+            Insertion::find_insertions_in_route(sol, r, v, restricted, nullptr, &granular);
+            ASSERT_EQ(restricted.size(), full.size()) << "request " << r << " vehicle " << v;
+        }
+
+        size_t pickup_id = instance.pickup_id_of_request(r);
+        std::mt19937 rng_full(r);
+        std::mt19937 rng_granular(r);
+        auto full = PermutationOps::find_random_insert_for_request(sol, pickup_id, rng_full);
+        auto restricted = PermutationOps::find_random_insert_for_request(sol, pickup_id, rng_granular, &granular);
+        ASSERT_EQ(restricted.has_value(), full.has_value());
+        if (full) {
+            EXPECT_EQ(restricted->pickup_after, full->pickup_after);
+            EXPECT_EQ(restricted->delivery_before, full->delivery_before);
+        }
+    }
+}
+
+TEST(GranularNeighborhoodTest, SmallNeighborhoodRestrictsPositions) {
+    auto instance = make_random_instance(3, 40, 17);
+    Solution sol = build_reference_solution(instance, 30);
+    GranularNeighborhood granular(instance, 3);
+
+    InsertionStats full_stats;
+    InsertionStats granular_stats;
+    for (size_t r = 0; r < instance.num_requests(); ++r) {
+        if (sol.is_request_assigned(r)) {
+            continue;
+        }
+        size_t pickup_id = instance.pickup_id_of_request(r);
+        for (size_t v = 0; v < instance.num_vehicles(); ++v) {
+            std::vector<InsertionCandidate> full;
+            std::vector<InsertionCandidate> restricted;
+            Insertion::find_insertions_in_route(sol, r, v, full, &full_stats);
+            Insertion::find_insertions_in_route(sol, r, v, restricted, &granular_stats, &granular);
+            EXPECT_LE(restricted.size(), full.size());
+
+            // Mỗi vị trí granular là vị trí khả thi với pickup đặt kề láng giềng
+            for (const auto &candidate : restricted) {
+                EXPECT_TRUE(Insertion::is_feasible_insertion(sol, r, v, candidate.pickup_after,
+                                                             candidate.delivery_after));
+                EXPECT_TRUE(granular.allows_gap(pickup_id, candidate.pickup_after,
+                                                sol.succ(candidate.pickup_after)));
+            }
+        }
+    }
+    EXPECT_LT(granular_stats.positions_checked, full_stats.positions_checked);
+    EXPECT_GT(granular_stats.routes_pruned, full_stats.routes_pruned);
+}
+
+TEST(InsertionEvaluatorTest, CostMatchesDistanceDeltaAfterInsertion) {
+    auto instance = make_random_instance(3, 40, 11);
+    Solution base = build_reference_solution(instance, 25);
+
+    size_t adjacent = 0;
+    size_t separated = 0;
+    for (size_t r = 0; r < instance.num_requests(); ++r) {
+        if (base.is_request_assigned(r)) {
+            continue;
+        }
+        for (size_t v = 0; v < instance.num_vehicles(); ++v) {
+            std::vector<InsertionCandidate> candidates;
+            Insertion::find_insertions_in_route(base, r, v, candidates);
+            for (const auto &candidate : candidates) {
+                Solution sol = base;
+                Insertion::insert_request(sol, candidate);
+                EXPECT_NEAR(candidate.cost_increase, sol.total_cost() - base.total_cost(), 1e-6)
+                    << "request " << r << " vehicle " << v << " pickup_after " << candidate.pickup_after
+                    << " delivery_after " << candidate.delivery_after;
+                (candidate.delivery_after == candidate.pickup_after ? adjacent : separated) += 1;
+            }
+        }
+    }
+
+    // Cả trường hợp delivery ngay sau pickup lẫn tách rời đều phải được kiểm tra
+    EXPECT_GT(adjacent, 0u);
+    EXPECT_GT(separated, 0u);
+}
+
+TEST(InsertionEvaluatorTest, BatchBackendsMatchScalar) {
+    std::vector<EvaluationBackend> backends = {EvaluationBackend::Batch};
+    if (refn::avx2_available()) {
+        backends.push_back(EvaluationBackend::BatchAvx2);
+    }
+    const EvaluationBackend saved = Insertion::evaluation_backend();
+
+    for (unsigned seed : {1u, 7u, 42u}) {
+        auto instance = make_random_instance(3, 40, seed);
+        Solution sol = build_reference_solution(instance, 30);
+
+        for (size_t r = 0; r < instance.num_requests(); ++r) {
+            if (sol.is_request_assigned(r)) {
+                continue;
+            }
+            for (size_t v = 0; v < instance.num_vehicles(); ++v) {
+                Insertion::set_evaluation_backend(EvaluationBackend::Scalar);
+                std::vector<InsertionCandidate> expected;
+                size_t expected_checked = Insertion::find_insertions_in_route(sol, r, v, expected);
+
+                for (auto backend : backends) {
+                    Insertion::set_evaluation_backend(backend);
+                    std::vector<InsertionCandidate> actual;
+                    EXPECT_EQ(Insertion::find_insertions_in_route(sol, r, v, actual), expected_checked);
+                    ASSERT_EQ(actual.size(), expected.size()) << "seed " << seed << " request " << r << " vehicle " << v;
+                    for (size_t i = 0; i < expected.size(); ++i) {
+                        EXPECT_EQ(actual[i].pickup_after, expected[i].pickup_after);
+                        EXPECT_EQ(actual[i].delivery_after, expected[i].delivery_after);
+                        EXPECT_EQ(actual[i].cost_increase, expected[i].cost_increase);
+                    }
+                }
+            }
+        }
+    }
+
+    Insertion::set_evaluation_backend(saved);
+}
+
+TEST(InstanceTraitsTest, DetectsMatrixAndDemandTraits) {
+    auto instance = make_random_instance(2, 10, 3);
+    EXPECT_TRUE(instance.traits().symmetric);
+    EXPECT_TRUE(instance.traits().time_equals_distance);
+    EXPECT_FALSE(instance.traits().capacity_unbounded);
+
+    auto skewed = make_random_instance(2, 10, 3, true);
+    EXPECT_FALSE(skewed.traits().symmetric);
+    EXPECT_FALSE(skewed.traits().time_equals_distance);
+
+    InstanceTraits allowed;
+    allowed.symmetric = true;
+    instance.restrict_traits(allowed);
+    EXPECT_TRUE(instance.traits().symmetric);
+    EXPECT_FALSE(instance.traits().time_equals_distance);
+    EXPECT_EQ(to_string(instance.traits()), "symmetric");
+    instance.restrict_traits(InstanceTraits());
+    EXPECT_FALSE(instance.traits().any());
+    EXPECT_EQ(to_string(instance.traits()), "none");
+}
+
+TEST(InstanceTraitsTest, MatrixTraitsCachedOnSharedMatrix) {
+    auto instance = make_random_instance(2, 10, 3);
+    auto matrix = instance.shared_travel_matrix();
+    auto rebuild = [&instance, &matrix]() {
+        return PDPTWInstance("shared", instance.num_requests(), instance.num_vehicles(), instance.nodes(),
+                             instance.vehicles(), matrix);
+    };
+
+    // Instance mới trên cùng ma trận dùng kết quả đã cache thay vì quét lại
+    matrix->set_traits(MatrixTraits{});
+    EXPECT_FALSE(rebuild().traits().symmetric);
+    EXPECT_FALSE(TravelMatrix(*matrix).traits().symmetric); // bản copy giữ cache
+
+    // Ghi vào ma trận xoá cache: lần sau quét lại
+    matrix->set_arc(0, 1, matrix->get_distance(0, 1), matrix->get_time(0, 1));
+    EXPECT_TRUE(rebuild().traits().symmetric);
+    EXPECT_TRUE(rebuild().traits().time_equals_distance);
+}
+
+TEST(InsertionEvaluatorTest, SpecializedEvaluatorsMatchGeneric) {
+    const bool saved = Insertion::specialized_evaluation();
+
+    // Mỗi tập trait chọn một nhóm biến thể; route nhẹ tải (max_load + demand <= 60) đi
+    // qua biến thể bỏ kiểm tra capacity kể cả khi không còn trait nào
+    std::vector<InstanceTraits> masks(4);
+    masks[0].symmetric = masks[0].time_equals_distance = true;
+    masks[1].symmetric = true;
+    masks[2].time_equals_distance = true;
+
+    for (unsigned seed : {1u, 7u, 42u}) {
+        for (bool skew : {false, true}) {
+            for (const auto &mask : masks) {
+                auto instance = make_random_instance(3, 40, seed, skew);
+                instance.restrict_traits(mask);
+                Solution sol = build_reference_solution(instance, 30);
+
+                for (size_t r = 0; r < instance.num_requests(); ++r) {
+                    if (sol.is_request_assigned(r)) {
+                        continue;
+                    }
+                    for (size_t v = 0; v < instance.num_vehicles(); ++v) {
+                        Insertion::set_specialized_evaluation(false);
+                        std::vector<InsertionCandidate> expected;
+                        size_t expected_checked = Insertion::find_insertions_in_route(sol, r, v, expected);
+
+                        Insertion::set_specialized_evaluation(true);
+                        std::vector<InsertionCandidate> actual;
+                        EXPECT_EQ(Insertion::find_insertions_in_route(sol, r, v, actual), expected_checked);
+                        ASSERT_EQ(actual.size(), expected.size()) << "seed " << seed << " request " << r << " vehicle " << v;
+                        for (size_t i = 0; i < expected.size(); ++i) {
+                            EXPECT_EQ(actual[i].pickup_after, expected[i].pickup_after);
+                            EXPECT_EQ(actual[i].delivery_after, expected[i].delivery_after);
+                            EXPECT_EQ(actual[i].cost_increase, expected[i].cost_increase);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    Insertion::set_specialized_evaluation(saved);
+}
+
+TEST(ThreadPoolTest, CoversRangeOnceAndRethrows) {
+    utils::ThreadPool pool(4);
+    std::vector<std::atomic<int>> hits(1000);
+    pool.parallel_for(hits.size(), 7, [&](size_t begin, size_t end, size_t worker) {
+        EXPECT_LT(worker, pool.num_threads());
+        for (size_t i = begin; i < end; ++i) {
+            hits[i].fetch_add(1);
+        }
+    });
+    EXPECT_TRUE(std::all_of(hits.begin(), hits.end(), [](const std::atomic<int> &h) { return h.load() == 1; }));
+
+    // Lời gọi lồng chạy tuần tự ngay trong worker
+    std::atomic<size_t> nested{0};
+    pool.parallel_for(8, 1, [&](size_t begin, size_t end, size_t) {
+        for (size_t i = begin; i < end; ++i) {
+            pool.parallel_for(10, 1, [&](size_t b, size_t e, size_t inner_worker) {
+                EXPECT_EQ(inner_worker, 0u);
+                nested += e - b;
+            });
+        }
+    });
+    EXPECT_EQ(nested.load(), 80u);
+
+    EXPECT_THROW(pool.parallel_for(100, 1, [](size_t begin, size_t, size_t) {
+        if (begin == 42) {
+            throw std::runtime_error("boom");
+        }
+    }),
+                 std::runtime_error);
+}
+
+TEST(InsertionEvaluatorTest, ParallelSearchMatchesSerial) {
+    auto instance = make_random_instance(6, 60, 5);
+    Solution sol = build_reference_solution(instance, 40);
+    std::vector<size_t> unassigned;
+    for (size_t r = 0; r < instance.num_requests(); ++r) {
+        if (!sol.is_request_assigned(r)) {
+            unassigned.push_back(r);
+        }
+    }
+    ASSERT_GT(unassigned.size(), 1u);
+
+    const size_t saved_cutoff = Insertion::parallel_cutoff();
+    Insertion::set_parallel_cutoff(std::numeric_limits<size_t>::max());
+    InsertionStats serial_stats;
+    auto serial = Insertion::calculate_regret(sol, unassigned, 3, &serial_stats);
+    std::vector<InsertionCandidate> serial_best;
+    for (size_t r : unassigned) {
+        serial_best.push_back(Insertion::find_best_insertion(sol, r));
+    }
+
+    utils::ThreadPool::set_global_threads(4);
+    Insertion::set_parallel_cutoff(0);
+    InsertionStats parallel_stats;
+    auto parallel = Insertion::calculate_regret(sol, unassigned, 3, &parallel_stats);
+
+    ASSERT_EQ(parallel.size(), serial.size());
+    for (size_t i = 0; i < serial.size(); ++i) {
+        EXPECT_EQ(parallel[i].request_id, serial[i].request_id);
+        EXPECT_EQ(parallel[i].vehicle_id, serial[i].vehicle_id);
+        EXPECT_EQ(parallel[i].pickup_after, serial[i].pickup_after);
+        EXPECT_EQ(parallel[i].delivery_after, serial[i].delivery_after);
+        EXPECT_EQ(parallel[i].cost_increase, serial[i].cost_increase);
+        EXPECT_EQ(parallel[i].regret_value, serial[i].regret_value);
+    }
+    EXPECT_EQ(parallel_stats.positions_checked, serial_stats.positions_checked);
+    EXPECT_EQ(parallel_stats.positions_pruned, serial_stats.positions_pruned);
+
+    for (size_t i = 0; i < unassigned.size(); ++i) {
+        auto best = Insertion::find_best_insertion(sol, unassigned[i]);
+        EXPECT_EQ(best.vehicle_id, serial_best[i].vehicle_id);
+        EXPECT_EQ(best.pickup_after, serial_best[i].pickup_after);
+        EXPECT_EQ(best.delivery_after, serial_best[i].delivery_after);
+        EXPECT_EQ(best.cost_increase, serial_best[i].cost_increase);
+    }
+
+    Insertion::set_parallel_cutoff(saved_cutoff);
+    utils::ThreadPool::set_global_threads(utils::ThreadPool::default_threads());
+}
+
+TEST(InsertionEvaluatorTest, WarmParallelTopInsertionsDoNotAllocate) {
+    auto instance = make_random_instance(6, 60, 5);
+    Solution sol = build_reference_solution(instance, 40);
+    std::vector<size_t> unassigned;
+    for (size_t r = 0; r < instance.num_requests(); ++r) {
+        if (!sol.is_request_assigned(r)) {
+            unassigned.push_back(r);
+        }
+    }
+    size_t non_empty_routes = 0;
+    for (size_t v = 0; v < instance.num_vehicles(); ++v) {
+        non_empty_routes += sol.is_route_empty(v) ? 0 : 1;
+    }
+    ASSERT_GT(non_empty_routes, 1u); // để đi qua nhánh song song
+
+    const size_t saved_cutoff = Insertion::parallel_cutoff();
+    utils::ThreadPool::set_global_threads(4);
+    Insertion::set_parallel_cutoff(0);
+
+    // Lượt đầu làm ấm các bộ đệm thread_local; lượt sau không được cấp phát
+    InsertionTopK top(3);
+    for (size_t r : unassigned) {
+        Insertion::find_top_insertions(sol, r, top);
+    }
+    allocation_count = 0;
+    count_allocations = true;
+    for (size_t r : unassigned) {
+        Insertion::find_top_insertions(sol, r, top);
+    }
+    count_allocations = false;
+    EXPECT_EQ(allocation_count.load(), 0u);
+
+    Insertion::set_parallel_cutoff(saved_cutoff);
+    utils::ThreadPool::set_global_threads(utils::ThreadPool::default_threads());
+}
+
+TEST(InsertionEvaluatorTest, TopKMatchesSortedCandidates) {
+    auto instance = make_random_instance(4, 50, 9);
+    Solution sol = build_reference_solution(instance, 35);
+
+    InsertionTopK top;
+    size_t checked_requests = 0;
+    for (size_t r = 0; r < instance.num_requests(); ++r) {
+        if (sol.is_request_assigned(r)) {
+            continue;
+        }
+        // Danh sách đầy đủ theo thứ tự vehicle, sắp ổn định theo cost
+        std::vector<InsertionCandidate> all;
+        for (size_t v = 0; v < instance.num_vehicles(); ++v) {
+            Insertion::find_insertions_in_route(sol, r, v, all);
+        }
+        std::stable_sort(all.begin(), all.end());
+
+        for (size_t k = 1; k <= InsertionTopK::kMaxK; ++k) {
+            top.reset(k);
+            Insertion::find_top_insertions(sol, r, top);
+            ASSERT_EQ(top.size(), std::min(k, all.size()));
+            for (size_t i = 0; i < top.size(); ++i) {
+                EXPECT_EQ(top[i].vehicle_id, all[i].vehicle_id);
+                EXPECT_EQ(top[i].pickup_after, all[i].pickup_after);
+                EXPECT_EQ(top[i].delivery_after, all[i].delivery_after);
+                EXPECT_EQ(top[i].cost_increase, all[i].cost_increase);
+            }
+        }
+        ++checked_requests;
+    }
+    EXPECT_GT(checked_requests, 0u);
+}
+
+namespace {
+
+// Chèn regret tham chiếu: tính lại regret của mọi request sau mỗi lần chèn
+std::vector<InsertionCandidate> reference_regret_sequence(Solution &sol, std::vector<size_t> pending, size_t k) {
+    std::vector<InsertionCandidate> sequence;
+    while (!pending.empty()) {
+        auto regret = Insertion::calculate_regret(sol, pending, k);
+        auto chosen = *std::min_element(regret.begin(), regret.end(),
+                                        [](const InsertionCandidate &a, const InsertionCandidate &b) {
+                                            if (a.regret_value != b.regret_value) {
+                                                return a.regret_value > b.regret_value;
+                                            }
+                                            if (a.cost_increase != b.cost_increase) {
+                                                return a.cost_increase < b.cost_increase;
+                                            }
+                                            return a.request_id < b.request_id;
+                                        });
+        Insertion::insert_request(sol, chosen);
+        pending.erase(std::find(pending.begin(), pending.end(), chosen.request_id));
+        sequence.push_back(chosen);
+    }
+    return sequence;
+}
+
+} // namespace
+
+TEST(RegretHeapTest, MatchesFullRecompute) {
+    auto instance = make_random_instance(5, 60, 13);
+    const Solution start = build_reference_solution(instance, 20);
+    std::vector<size_t> pending = start.unassigned_requests().iter_request_ids();
+    ASSERT_GT(pending.size(), 10u);
+    const size_t saved_cutoff = Insertion::parallel_cutoff();
+
+    for (size_t k = 2; k <= InsertionTopK::kMaxK; ++k) {
+        Solution expected_sol = start;
+        auto expected = reference_regret_sequence(expected_sol, pending, k);
+
+        // 0: tìm trực tiếp, 1: qua cache, 2: tìm trực tiếp trên 4 thread
+        for (int mode = 0; mode < 3; ++mode) {
+            const bool use_cache = mode == 1;
+            utils::ThreadPool::set_global_threads(mode == 2 ? 4 : 1);
+            Insertion::set_parallel_cutoff(mode == 2 ? 0 : saved_cutoff);
+            Solution sol = start;
+            InsertionCache cache;
+            RegretHeap heap(k);
+            heap.reset(sol, pending, use_cache ? &cache : nullptr);
+
+            std::vector<InsertionCandidate> actual;
+            while (!heap.empty()) {
+                actual.push_back(heap.top());
+                if (heap.top().feasible) {
+                    heap.insert_top(sol);
+                } else {
+                    heap.pop();
+                }
+            }
+
+            ASSERT_EQ(actual.size(), expected.size()) << "k=" << k << " mode=" << mode;
+            for (size_t i = 0; i < expected.size(); ++i) {
+                EXPECT_EQ(actual[i].request_id, expected[i].request_id);
+                EXPECT_EQ(actual[i].feasible, expected[i].feasible);
+                EXPECT_EQ(actual[i].regret_value, expected[i].regret_value);
+                if (expected[i].feasible) {
+                    EXPECT_EQ(actual[i].vehicle_id, expected[i].vehicle_id);
+                    EXPECT_EQ(actual[i].pickup_after, expected[i].pickup_after);
+                    EXPECT_EQ(actual[i].delivery_after, expected[i].delivery_after);
+                    EXPECT_EQ(actual[i].cost_increase, expected[i].cost_increase);
+                }
+            }
+            EXPECT_EQ(sol.unassigned_requests().count(), expected_sol.unassigned_requests().count());
+            EXPECT_GT(heap.route_refreshes(), 0u);
+        }
+    }
+
+    Insertion::set_parallel_cutoff(saved_cutoff);
+    utils::ThreadPool::set_global_threads(utils::ThreadPool::default_threads());
+}
+
+TEST(KEjectionTest, ResultAppliesToRealSolution) {
+    size_t applied = 0;
+    for (unsigned seed : {1u, 7u, 42u}) {
+        // Request id (r) khác pickup id (2 * num_vehicles + 2r), nên lẫn lộn hai loại id sẽ lộ ra
+        auto instance = make_random_instance(2, 30, seed);
+        Solution sol = build_reference_solution(instance, instance.num_requests());
+        lns::AbsenceCounter absence(instance.num_requests());
+        std::mt19937 rng(seed);
+
+        // Áp dụng như AGES: đẩy các request ra rồi chèn vào vị trí trả về, trên solution thật
+        auto apply = [&](size_t pickup_id, const auto &result) {
+            Solution applied_sol = sol;
+            for (const auto &ejection : result.ejections) {
+                ASSERT_TRUE(instance.is_pickup(ejection.pickup_id));
+                ASSERT_TRUE(applied_sol.is_request_assigned(instance.request_id(ejection.pickup_id)));
+                applied_sol.unassign_request(ejection.pickup_id);
+            }
+            ASSERT_EQ(result.insertion.pickup_id, pickup_id);
+            PermutationOps::insert(applied_sol, result.insertion);
+            EXPECT_TRUE(applied_sol.is_request_assigned(instance.request_id(pickup_id)));
+            EXPECT_TRUE(utils::validate_solution(instance, applied_sol).is_valid) << "seed " << seed;
+            ++applied;
+        };
+
+        for (size_t r = 0; r < instance.num_requests(); ++r) {
+            if (sol.is_request_assigned(r)) {
+                continue;
+            }
+            size_t pickup_id = instance.pickup_id_of_request(r);
+            if (auto one = KEjectionOps::find_best_insertion_k_ejection_1(sol, pickup_id, rng, absence)) {
+                apply(pickup_id, *one);
+            }
+            if (auto two = KEjectionOps::find_best_insertion_k_ejection_2(sol, pickup_id, rng, absence)) {
+                EXPECT_NE(two->ejections[0].pickup_id, two->ejections[1].pickup_id);
+                apply(pickup_id, *two);
+            }
+        }
+    }
+    EXPECT_GT(applied, 0u);
+}
+
+TEST(PermutationOpsTest, RouteScanMatchesPairwiseEvaluation) {
+    size_t separated = 0;
+    size_t shifts = 0;
+    for (unsigned seed : {1u, 7u, 42u}) {
+        auto instance = make_random_instance(3, 40, seed);
+        Solution sol = build_reference_solution(instance, 30);
+
+        for (size_t r = 0; r < instance.num_requests(); ++r) {
+            if (sol.is_request_assigned(r)) {
+                continue;
+            }
+            size_t pickup_id = instance.pickup_id_of_request(r);
+            for (size_t v = 0; v < instance.num_vehicles(); ++v) {
+                // PDInsertion chèn delivery trước delivery_before = succ(delivery_after);
+                // kết quả được sắp theo cost nên đưa về thứ tự duyệt của tham chiếu trước khi so
+                auto expected = reference_insertions(sol, r, v);
+                auto actual = PermutationOps::find_all_inserts_for_request_in_route(sol, pickup_id, v);
+                std::vector<size_t> order(instance.nodes().size());
+                size_t position = 0;
+                for (size_t node = instance.vn_id_of(v); node != instance.vn_id_of(v) + 1; node = sol.succ(node)) {
+                    order[node] = position++;
+                }
+                order[instance.vn_id_of(v) + 1] = position;
+                std::sort(actual.begin(), actual.end(), [&](const PDInsertion &a, const PDInsertion &b) {
+                    return std::make_pair(order[a.pickup_after], order[a.delivery_before]) <
+                           std::make_pair(order[b.pickup_after], order[b.delivery_before]);
+                });
+
+                ASSERT_EQ(actual.size(), expected.size()) << "seed " << seed << " request " << r << " vehicle " << v;
+                for (size_t i = 0; i < expected.size(); ++i) {
+                    EXPECT_EQ(actual[i].vn_id, instance.vn_id_of(v));
+                    EXPECT_EQ(actual[i].pickup_after, expected[i].pickup_after);
+                    EXPECT_EQ(actual[i].delivery_before, sol.succ(expected[i].delivery_after));
+                    EXPECT_NEAR(actual[i].cost, expected[i].cost_increase, 1e-6);
+                    separated += expected[i].delivery_after != expected[i].pickup_after;
+                }
+            }
+        }
+
+        // random_shift chỉ dời request đã chèn và phải giữ solution khả thi
+        std::mt19937 rng(seed);
+        for (int i = 0; i < 50; ++i) {
+            shifts += PermutationOps::random_shift(sol, rng);
+            ASSERT_TRUE(utils::validate_solution(instance, sol).is_valid) << "seed " << seed << " shift " << i;
+        }
+    }
+
+    // Phải có vị trí mà delivery cách pickup ít nhất một node (đoạn pickup..delivery được nới)
+    EXPECT_GT(separated, 0u);
+    EXPECT_GT(shifts, 0u);
+}
@@ -1,8 +1,12 @@
 #include "pdptw/construction/constructor.hpp"
+#include "pdptw/io/instance_cache.hpp"
 #include "pdptw/io/li_lim_reader.hpp"
+#include "pdptw/io/matrix_parser.hpp"
+#include "pdptw/io/sartori_buriol_reader.hpp"
 #include "pdptw/io/sintef_solution.hpp"
 #include "pdptw/solver/lns_solver.hpp"
 #include "pdptw/utils/validator.hpp"
+#include <filesystem>
 #include <fstream>
 #include <gtest/gtest.h>
 #include <sstream>
@@ -105,6 +109,21 @@ TEST_F(IOTest, LoadInstance_TravelMatrix) {
     EXPECT_NEAR(static_cast<double>(dist), 10.0, 1e-6);
 }
 
+TEST_F(IOTest, LoadInstance_DepotsShareOneLocation) {
+    create_test_instance();
+    auto instance = load_li_lim_instance(test_instance_path, 5);
+
+    // Matrix grows with distinct locations (depot + 4 tasks), not with fleet size
+    EXPECT_EQ(instance.travel_matrix().size(), 5);
+    for (size_t v = 0; v < instance.num_vehicles(); ++v) {
+        EXPECT_EQ(instance.location_of(2 * v), 0u);
+        EXPECT_EQ(instance.location_of(2 * v + 1), 0u);
+    }
+    EXPECT_NEAR(instance.distance(8, 10), 10.0, 1e-6);  // last vehicle's depot -> first pickup
+    EXPECT_NEAR(instance.distance(12, 13), 10.0, 1e-6); // second request pickup -> delivery
+    EXPECT_NEAR(instance.distance(9, 8), 0.0, 1e-6);
+}
+
 TEST_F(IOTest, LoadInstance_WithMaxVehicles) {
     create_test_instance();
 
@@ -115,6 +134,162 @@ TEST_F(IOTest, LoadInstance_WithMaxVehicles) {
     EXPECT_EQ(instance.num_requests(), 2);
 }
 
+// ==================== Binary Instance Cache Tests ====================
+
+TEST_F(IOTest, InstanceCache_RoundTrip) {
+    create_test_instance();
+    auto parsed = load_li_lim_instance(test_instance_path, 3);
+
+    auto cache_dir = std::filesystem::temp_directory_path() / "pdptw_cache_test";
+    std::filesystem::remove_all(cache_dir);
+    std::filesystem::create_directories(cache_dir);
+
+    uint64_t hash = hash_file(test_instance_path);
+    std::string cache_path = instance_cache_path(cache_dir.string(), test_instance_path, hash, 3);
+    write_instance_cache(cache_path, parsed, hash, 3);
+
+    auto cached = load_instance_cache(cache_path, hash, 3);
+    ASSERT_TRUE(cached.has_value());
+    EXPECT_EQ(cached->name(), parsed.name());
+    EXPECT_EQ(cached->num_requests(), parsed.num_requests());
+    EXPECT_EQ(cached->num_vehicles(), parsed.num_vehicles());
+    ASSERT_EQ(cached->nodes().size(), parsed.nodes().size());
+    EXPECT_TRUE(cached->travel_matrix().is_borrowed());
+
+    // arc_as đọc thẳng vùng mmap qua con trỏ kiểu giá trị: phải căn chỉnh theo precision
+    const auto &matrix = cached->travel_matrix();
+    const size_t value_align = matrix.storage().precision == MatrixPrecision::Float64 ? alignof(double)
+                                                                                      : alignof(uint32_t);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(matrix.data()) % value_align, 0u);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(matrix.data()) % 64, 0u);
+    EXPECT_EQ(cached->traits().symmetric, parsed.traits().symmetric);
+    EXPECT_EQ(cached->traits().time_equals_distance, parsed.traits().time_equals_distance);
+
+    for (size_t i = 0; i < parsed.nodes().size(); ++i) {
+        EXPECT_EQ(cached->nodes()[i].node_type(), parsed.nodes()[i].node_type());
+        EXPECT_EQ(cached->nodes()[i].demand(), parsed.nodes()[i].demand());
+        EXPECT_DOUBLE_EQ(cached->nodes()[i].ready(), parsed.nodes()[i].ready());
+        EXPECT_DOUBLE_EQ(cached->nodes()[i].due(), parsed.nodes()[i].due());
+        for (size_t j = 0; j < parsed.nodes().size(); ++j) {
+            EXPECT_DOUBLE_EQ(cached->distance(i, j), parsed.distance(i, j));
+            EXPECT_DOUBLE_EQ(cached->time(i, j), parsed.time(i, j));
+        }
+    }
+
+    // Hash hoặc max_vehicles khác → cache không được dùng
+    EXPECT_FALSE(load_instance_cache(cache_path, hash + 1, 3).has_value());
+    EXPECT_FALSE(load_instance_cache(cache_path, hash, 4).has_value());
+
+    // Traits của ma trận lấy từ header, không quét lại ma trận đã mmap
+    ASSERT_TRUE(parsed.traits().symmetric);
+    parsed.shared_travel_matrix()->set_traits(MatrixTraits{});
+    write_instance_cache(cache_path, parsed, hash, 3);
+    auto from_header = load_instance_cache(cache_path, hash, 3);
+    ASSERT_TRUE(from_header.has_value());
+    EXPECT_FALSE(from_header->traits().symmetric);
+    EXPECT_FALSE(from_header->traits().time_equals_distance);
+
+    std::filesystem::remove_all(cache_dir);
+}
+
+TEST_F(IOTest, InstanceCache_ParsesOnlyOnMiss) {
+    create_test_instance();
+    auto cache_dir = std::filesystem::temp_directory_path() / "pdptw_cache_test_miss";
+    std::filesystem::remove_all(cache_dir);
+
+    int parse_calls = 0;
+    auto parse = [&]() {
+        ++parse_calls;
+        return load_li_lim_instance(test_instance_path);
+    };
+
+    auto first = load_instance_with_cache(test_instance_path, cache_dir.string(), 0, parse);
+    auto second = load_instance_with_cache(test_instance_path, cache_dir.string(), 0, parse);
+    EXPECT_EQ(parse_calls, 1);
+    EXPECT_EQ(second.num_requests(), first.num_requests());
+    EXPECT_TRUE(second.travel_matrix().is_borrowed());
+
+    // Source file thay đổi → parse lại
+    {
+        std::ofstream file(test_instance_path, std::ios::app);
+        file << "\n";
+    }
+    load_instance_with_cache(test_instance_path, cache_dir.string(), 0, parse);
+    EXPECT_EQ(parse_calls, 2);
+
+    std::filesystem::remove_all(cache_dir);
+}
+
+// ==================== EDGES Matrix Parser Tests ====================
+
+TEST_F(IOTest, MatrixParser_IntegerMatrixUsesUInt32) {
+    std::string text = "0 5 7\n5 0 +3\r\n7 3 0 99\ntrailing";
+    auto result = parse_square_matrix(text.data(), text.data() + text.size(), 3);
+
+    const auto &matrix = *result.matrix;
+    EXPECT_EQ(matrix.storage(), (MatrixStorage{MatrixPrecision::UInt32, true}));
+    EXPECT_DOUBLE_EQ(matrix.get_distance(0, 2), 7.0);
+    EXPECT_DOUBLE_EQ(matrix.get_time(1, 2), 3.0);
+    EXPECT_DOUBLE_EQ(matrix.get_distance(2, 1), 3.0);
+    EXPECT_EQ(std::string(result.end), "trailing");
+}
+
+TEST_F(IOTest, MatrixParser_FractionalValuesNarrowInPlace) {
+    std::string halves = "0 1.5\n2.25 0\n";
+    auto as_float = parse_square_matrix(halves.data(), halves.data() + halves.size(), 2);
+    EXPECT_EQ(as_float.matrix->storage().precision, MatrixPrecision::Float32);
+    EXPECT_EQ(as_float.matrix->memory_bytes(), 4 * sizeof(float));
+    EXPECT_DOUBLE_EQ(as_float.matrix->get_distance(1, 0), 2.25);
+
+    std::string tenths = "0 0.1\n-4 0\n";
+    auto as_double = parse_square_matrix(tenths.data(), tenths.data() + tenths.size(), 2);
+    EXPECT_EQ(as_double.matrix->storage().precision, MatrixPrecision::Float64);
+    EXPECT_DOUBLE_EQ(as_double.matrix->get_distance(0, 1), 0.1);
+    EXPECT_DOUBLE_EQ(as_double.matrix->get_distance(1, 0), -4.0);
+}
+
+TEST_F(IOTest, MatrixParser_ReportsBadValuesAndMissingRows) {
+    std::string bad = "0 1 2\n1 0 x\n2 1 0\n";
+    try {
+        parse_square_matrix(bad.data(), bad.data() + bad.size(), 3);
+        FAIL() << "Expected std::runtime_error";
+    } catch (const std::runtime_error &e) {
+        EXPECT_STREQ(e.what(), "Failed to parse edge value at 1,2");
+    }
+
+    std::string short_row = "0 1 2\n1 0\n2 1 0\n";
+    EXPECT_THROW(parse_square_matrix(short_row.data(), short_row.data() + short_row.size(), 3),
+                 std::runtime_error);
+
+    std::string missing_row = "0 1\n";
+    EXPECT_THROW(parse_square_matrix(missing_row.data(), missing_row.data() + missing_row.size(), 2),
+                 std::runtime_error);
+}
+
+TEST_F(IOTest, LoadSartoriInstance_ParsesEdges) {
+    {
+        std::ofstream file(test_instance_path);
+        file << "NAME: tiny\nLOCATION: Test\nCOMMENT: test\nTYPE: PDPTW\nSIZE: 3\n"
+             << "DISTRIBUTION: none\nDEPOT: central\nROUTE-TIME: 100\nTIME-WINDOW: 10\n"
+             << "CAPACITY: 10\nNODES\n"
+             << "0 0 0 0 0 100 0 0 0\n"
+             << "1 0 0 5 0 50 2 0 2\n"
+             << "2 0 0 -5 0 80 2 1 0\n"
+             << "EDGES\n"
+             << "0 4 6\n4 0 3\n6 3 0\n";
+    }
+
+    auto instance = load_sartori_buriol_instance(test_instance_path, 2);
+    EXPECT_EQ(instance.num_requests(), 1);
+    EXPECT_EQ(instance.travel_matrix().size(), 3);
+    EXPECT_EQ(instance.travel_matrix().storage().precision, MatrixPrecision::UInt32);
+
+    // Nodes: 4 depot (2 xe), pickup = 4, delivery = 5
+    EXPECT_DOUBLE_EQ(instance.distance(0, 4), 4.0);
+    EXPECT_DOUBLE_EQ(instance.time(4, 5), 3.0);
+    EXPECT_DOUBLE_EQ(instance.distance(5, 3), 6.0);
+}
+
 // ==================== SINTEF Solution Writer Tests ====================
 
 TEST_F(IOTest, WriteSolution_BasicFormat) {
@@ -1,6 +1,9 @@
 #include "pdptw/construction/constructor.hpp"
+#include "pdptw/decomposition/recombiner.hpp"
+#include "pdptw/decomposition/splitter.hpp"
 #include "pdptw/problem/travel_matrix.hpp"
 #include "pdptw/solver/lns_solver.hpp"
+#include "pdptw/solver/parallel_lns_solver.hpp"
 #include "pdptw/utils/validator.hpp"
 #include <chrono>
 #include <gtest/gtest.h>
@@ -102,6 +105,35 @@ TEST_F(LNSSolverTest, OnlyImprovementsAcceptance) {
     EXPECT_EQ(oi.get_temperature(), 0.0);
 }
 
+TEST_F(LNSSolverTest, AcceptanceBoundMatchesAccept) {
+    std::mt19937 rng(42);
+
+    // SA: accept() dùng số ngẫu nhiên đã rút trong acceptance_bound()
+    SimulatedAnnealing sa(10.0, 0.01, 100);
+    int accepts = 0;
+    for (int i = 0; i < 200; ++i) {
+        Num bound = sa.acceptance_bound(100, 90, rng);
+        EXPECT_GE(bound, 100);
+        EXPECT_FALSE(sa.accept(bound + 1e-6, 100, 90, rng));
+        bound = sa.acceptance_bound(100, 90, rng);
+        EXPECT_TRUE(sa.accept(bound - 1e-6, 100, 90, rng));
+        sa.acceptance_bound(100, 90, rng);
+        accepts += sa.accept(105, 100, 90, rng) ? 1 : 0;
+    }
+    // P(accept delta = 5, T = 10) = exp(-0.5) ~ 0.61
+    EXPECT_GT(accepts, 90);
+    EXPECT_LT(accepts, 150);
+
+    RecordToRecordTravel rtr(0.1, 0.01, 100);
+    Num bound = rtr.acceptance_bound(100, 90, rng);
+    EXPECT_NEAR(bound, 99, 1e-9);
+    EXPECT_TRUE(rtr.accept(bound - 1e-6, 100, 90, rng));
+    EXPECT_FALSE(rtr.accept(bound + 1e-6, 100, 90, rng));
+
+    OnlyImprovements oi;
+    EXPECT_EQ(oi.acceptance_bound(100, 90, rng), 100);
+}
+
 // ============================================================================
 // LNS Solver Basic Tests
 // ============================================================================
@@ -212,7 +244,7 @@ TEST_F(LNSSolverTest, StatisticsTracking) {
 
     // Check operator statistics
     EXPECT_EQ(stats.destroy_stats.size(), 4u); // 4 destroy operators
-    EXPECT_EQ(stats.repair_stats.size(), 4u);  // 4 repair operators
+    EXPECT_EQ(stats.repair_stats.size(), 5u);  // 5 repair operators
 
     // Each operator should have been used
     int total_destroy_uses = 0;
@@ -269,20 +301,94 @@ TEST_F(LNSSolverTest, OperatorRotation) {
     LNSSolverParams params;
     params.max_iterations = 20;
     params.verbose = false;
+    params.operator_selection = LNSSolverParams::OperatorSelection::ROUND_ROBIN;
 
     LNSSolver solver(*instance, params);
     solver.solve(initial);
 
     const auto &stats = solver.get_statistics();
 
-    // With round-robin rotation over 20 iterations and 4 operators each,
-    // each operator should be used 5 times
+    // With round-robin rotation over 20 iterations, each of the 4 destroy
+    // operators is used 5 times and each of the 5 repair operators 4 times
     for (const auto &ds : stats.destroy_stats) {
         EXPECT_EQ(ds.times_used, 5);
     }
     for (const auto &rs : stats.repair_stats) {
-        EXPECT_EQ(rs.times_used, 5);
+        EXPECT_EQ(rs.times_used, 4);
+    }
+}
+
+TEST_F(LNSSolverTest, AdaptiveWeightsRewardImprovementPerMillisecond) {
+    lns::AdaptiveWeightsParams p;
+    p.segment_length = 4;
+    p.reaction = 0.5;
+    p.min_weight = 0.1;
+    lns::AdaptiveOperatorWeights weights(3, p);
+
+    // Op 0: 10 / 2 ms, op 1: 10 / 8 ms (reward 1/4 của op 0), op 2 không được dùng
+    weights.record(0, 10.0, 1.0);
+    weights.record(0, 0.0, 1.0);
+    weights.record(1, 10.0, 4.0);
+    EXPECT_EQ(weights.segments(), 0u);
+    weights.record(1, 0.0, 4.0);
+    EXPECT_EQ(weights.segments(), 1u);
+    EXPECT_DOUBLE_EQ(weights.weights()[0], 1.0);
+    EXPECT_DOUBLE_EQ(weights.weights()[1], 0.5 + 0.5 * 0.25);
+    EXPECT_DOUBLE_EQ(weights.weights()[2], 1.0);
+
+    // Segment không có cải thiện: giữ nguyên; không cải thiện mãi thì chạm sàn
+    for (int i = 0; i < 4; ++i) {
+        weights.record(1, 0.0, 1.0);
+    }
+    EXPECT_DOUBLE_EQ(weights.weights()[1], 0.625);
+    for (int s = 0; s < 20; ++s) {
+        weights.record(0, 1.0, 1.0);
+        weights.record(0, 1.0, 1.0);
+        weights.record(1, 0.0, 1.0);
+        weights.record(2, 0.0, 1.0);
     }
+    EXPECT_DOUBLE_EQ(weights.weights()[0], 1.0);
+    EXPECT_DOUBLE_EQ(weights.weights()[1], 0.1);
+    EXPECT_DOUBLE_EQ(weights.weights()[2], 0.1);
+
+    // Roulette tỉ lệ với trọng số: 1 : 0.1 : 0.1
+    std::mt19937 rng(7);
+    std::vector<int> picks(3, 0);
+    for (int i = 0; i < 12000; ++i) {
+        picks[weights.select(rng)]++;
+    }
+    EXPECT_NEAR(picks[0] / 12000.0, 1.0 / 1.2, 0.02);
+    EXPECT_NEAR(picks[1] / 12000.0, 0.1 / 1.2, 0.02);
+}
+
+TEST_F(LNSSolverTest, AdaptiveSelectionExposesWeights) {
+    Solution initial = construction::Constructor::construct(*instance);
+
+    LNSSolverParams params;
+    params.max_iterations = 50;
+    params.verbose = false;
+    params.operator_selection = LNSSolverParams::OperatorSelection::ADAPTIVE;
+    params.adaptive_weights.segment_length = 10;
+
+    LNSSolver solver(*instance, params);
+    solver.solve(initial);
+
+    const auto &stats = solver.get_statistics();
+    int total_repair_uses = 0;
+    for (const auto &rs : stats.repair_stats) {
+        total_repair_uses += rs.times_used;
+        EXPECT_GE(rs.weight, params.adaptive_weights.min_weight);
+        EXPECT_LE(rs.weight, 1.0);
+        EXPECT_GE(rs.total_ms, 0.0);
+    }
+    EXPECT_EQ(total_repair_uses, stats.total_iterations);
+
+    // Trace best bắt đầu từ lời giải ban đầu, kết thúc ở best cuối
+    ASSERT_FALSE(stats.best_trace.empty());
+    EXPECT_EQ(stats.best_trace.front().second, stats.initial_objective);
+    EXPECT_EQ(stats.best_trace.back().second, stats.best_objective);
+    EXPECT_EQ(stats.time_to_target(stats.initial_objective), 0.0);
+    EXPECT_LT(stats.time_to_target(stats.best_objective - 1), 0.0);
 }
 
 TEST_F(LNSSolverTest, DeterministicWithSameSeed) {
@@ -303,3 +409,174 @@ TEST_F(LNSSolverTest, DeterministicWithSameSeed) {
     // Should get identical results
     EXPECT_EQ(result1.objective(), result2.objective());
 }
+
+TEST_F(LNSSolverTest, SpeculativeCandidatesDeterministicWithSameSeed) {
+    Solution initial = construction::Constructor::construct(*instance);
+
+    LNSSolverParams params;
+    params.max_iterations = 40;
+    params.verbose = false;
+    params.seed = 99;
+    params.speculative_candidates = 4;
+    // Reward mặc định theo lần dùng nên chọn adaptive vẫn tái lập được
+    params.operator_selection = LNSSolverParams::OperatorSelection::ADAPTIVE;
+
+    LNSSolver solver1(*instance, params);
+    Solution result1 = solver1.solve(initial);
+    LNSSolver solver2(*instance, params);
+    Solution result2 = solver2.solve(initial);
+
+    EXPECT_EQ(result1.objective(), result2.objective());
+    EXPECT_LE(result1.objective(), initial.objective());
+    EXPECT_TRUE(utils::validate_solution(*instance, result1).is_valid);
+
+    // Mỗi iteration dùng 4 cặp operator (một cặp mỗi lane)
+    const auto &stats = solver1.get_statistics();
+    int destroy_uses = 0;
+    for (const auto &ds : stats.destroy_stats) {
+        destroy_uses += ds.times_used;
+    }
+    EXPECT_EQ(destroy_uses, 4 * stats.total_iterations);
+}
+
+TEST_F(LNSSolverTest, ParallelSolverDeterministicWithSameSeed) {
+    Solution initial = construction::Constructor::construct(*instance);
+
+    ParallelLNSSolverParams params;
+    params.base.max_iterations = 60;
+    params.base.verbose = false;
+    params.base.seed = 7;
+    params.base.operator_selection = LNSSolverParams::OperatorSelection::ADAPTIVE;
+    params.num_threads = 3;
+    params.sync_interval = 10;
+
+    // Worker khác seed, worker lẻ đổi kiểu acceptance
+    auto w0 = ParallelLNSSolver::worker_params(params, 0);
+    auto w1 = ParallelLNSSolver::worker_params(params, 1);
+    EXPECT_EQ(w0.seed, 7u);
+    EXPECT_EQ(w1.seed, 8u);
+    EXPECT_EQ(w1.acceptance_type, LNSSolverParams::AcceptanceType::RECORD_TO_RECORD);
+
+    ParallelLNSSolver solver1(*instance, params);
+    Solution result1 = solver1.solve(initial);
+    ParallelLNSSolver solver2(*instance, params);
+    Solution result2 = solver2.solve(initial);
+
+    EXPECT_EQ(result1.objective(), result2.objective());
+    EXPECT_EQ(solver1.best_worker(), solver2.best_worker());
+    EXPECT_EQ(solver1.restarts(), solver2.restarts());
+    EXPECT_EQ(solver1.worker_statistics().size(), 3u);
+    EXPECT_LE(result1.objective(), initial.objective());
+    EXPECT_DOUBLE_EQ(solver1.best_objective(), result1.objective());
+    EXPECT_TRUE(utils::validate_solution(*instance, result1).is_valid);
+}
+
+TEST_F(LNSSolverTest, DeterministicModeReproducesTrajectory) {
+    Solution initial = construction::Constructor::construct(*instance);
+
+    for (size_t candidates : {size_t(1), size_t(3)}) {
+        LNSSolverParams params;
+        params.max_iterations = 60;
+        params.verbose = false;
+        params.seed = 2024;
+        params.deterministic = true;
+        params.speculative_candidates = candidates;
+        params.operator_selection = LNSSolverParams::OperatorSelection::ADAPTIVE;
+
+        LNSSolver solver1(*instance, params);
+        solver1.solve(initial);
+        LNSSolver solver2(*instance, params);
+        solver2.solve(initial);
+
+        // Cùng quỹ đạo: cùng chuỗi best, cùng số lần dùng và trọng số từng operator
+        const auto &s1 = solver1.get_statistics();
+        const auto &s2 = solver2.get_statistics();
+        EXPECT_EQ(s1.total_iterations, s2.total_iterations);
+        EXPECT_EQ(s1.accepted_solutions, s2.accepted_solutions);
+        ASSERT_EQ(s1.best_trace.size(), s2.best_trace.size());
+        for (size_t i = 0; i < s1.best_trace.size(); ++i) {
+            EXPECT_EQ(s1.best_trace[i].second, s2.best_trace[i].second);
+        }
+        for (size_t i = 0; i < s1.destroy_stats.size(); ++i) {
+            EXPECT_EQ(s1.destroy_stats[i].times_used, s2.destroy_stats[i].times_used);
+            EXPECT_EQ(s1.destroy_stats[i].weight, s2.destroy_stats[i].weight);
+        }
+        for (size_t i = 0; i < s1.repair_stats.size(); ++i) {
+            EXPECT_EQ(s1.repair_stats[i].times_used, s2.repair_stats[i].times_used);
+            EXPECT_EQ(s1.repair_stats[i].weight, s2.repair_stats[i].weight);
+        }
+    }
+}
+
+TEST_F(LNSSolverTest, RouteSnapshotCopiesOnlyChangedRoutes) {
+    Solution solution = construction::Constructor::construct(*instance);
+
+    RouteSnapshot snapshot;
+    EXPECT_TRUE(snapshot.empty());
+
+    snapshot.capture(solution);
+    EXPECT_EQ(snapshot.routes_copied(), instance->num_vehicles());
+    EXPECT_DOUBLE_EQ(snapshot.objective(), solution.objective());
+
+    // Không có route nào thay đổi
+    snapshot.capture(solution);
+    EXPECT_EQ(snapshot.routes_copied(), 0u);
+
+    // Rollback trả lại version cũ nên cũng không cần trích xuất lại
+    solution.begin_transaction();
+    solution.unassign_request(instance->pickup_id_of_request(0));
+    solution.rollback_transaction();
+    snapshot.capture(solution);
+    EXPECT_EQ(snapshot.routes_copied(), 0u);
+
+    solution.unassign_request(instance->pickup_id_of_request(0));
+    snapshot.capture(solution);
+    EXPECT_EQ(snapshot.routes_copied(), 1u);
+
+    Solution restored(*instance);
+    snapshot.restore_into(restored);
+    EXPECT_DOUBLE_EQ(restored.objective(), solution.objective());
+    EXPECT_EQ(restored.unassigned_requests().count(), 1);
+    EXPECT_EQ(restored.iter_route(0), solution.iter_route(0));
+}
+
+// ============================================================================
+// Decomposition Tests
+// ============================================================================
+
+TEST_F(LNSSolverTest, PartialInstanceSurvivesMove) {
+    Solution solution = construction::Constructor::construct(*instance);
+    std::mt19937 rng(42);
+
+    auto partials = decomposition::SolutionSplitter(solution).split(decomposition::SplitSettings{}, rng);
+    ASSERT_EQ(partials.size(), 1u);
+    Num objective = partials[0].initial_solution.objective();
+
+    // initial_solution trỏ tới instance của partial: địa chỉ phải giữ nguyên sau khi move
+    decomposition::PartialInstance moved = std::move(partials[0]);
+    EXPECT_EQ(&moved.initial_solution.instance(), moved.instance.get());
+    EXPECT_EQ(moved.initial_solution.objective(), objective);
+    EXPECT_EQ(moved.initial_solution.to_description().itineraries().size(), moved.instance->num_vehicles());
+}
+
+TEST_F(LNSSolverTest, GreedyMergeKeepsRequestsLeftUnassigned) {
+    Solution solution = construction::Constructor::construct(*instance);
+    ASSERT_EQ(solution.unassigned_requests().count(), 0u);
+    std::mt19937 rng(42);
+
+    auto partials = decomposition::SolutionSplitter(solution).split(decomposition::SplitSettings{}, rng);
+    ASSERT_EQ(partials.size(), 1u);
+
+    // Giả lập LNS con để lại 1 request chưa chèn
+    auto &partial = partials[0];
+    size_t partial_pickup = partial.instance->pickup_id_of_request(0);
+    partial.initial_solution.unassign_request(partial_pickup);
+    size_t full_pickup = partial.partial_to_full_nodes[partial_pickup];
+
+    decomposition::SolutionRecombiner recombiner(*instance);
+    Solution combined = recombiner.recombine(partials, {}, decomposition::RecombineMode::GreedyMerge, rng);
+
+    EXPECT_TRUE(combined.unassigned_requests().contains(full_pickup));
+    EXPECT_EQ(combined.unassigned_requests().count(), 1u);
+    EXPECT_TRUE(combined.is_request_assigned(1 - instance->request_id(full_pickup)));
+}
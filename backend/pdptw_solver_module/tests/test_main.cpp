@@ -11,6 +11,8 @@
 #include "pdptw/solution/datastructure.hpp"
 #include "test_helpers.hpp"
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
 #include <memory>
 
 using namespace pdptw::problem;
@@ -133,6 +135,97 @@ TEST(TravelMatrixTest, SetAndGet) {
     EXPECT_DOUBLE_EQ(tm.get_distance(0, 1), 25.3);
 }
 
+TEST(TravelMatrixTest, UncheckedArcMatchesCheckedAccess) {
+    using namespace pdptw::problem;
+
+    TravelMatrix tm(4);
+    for (size_t i = 0; i < 4; ++i) {
+        for (size_t j = 0; j < 4; ++j) {
+            tm.set_distance(i, j, static_cast<double>(10 * i + j));
+            tm.set_time(i, j, static_cast<double>(100 * i + j));
+        }
+    }
+
+    EXPECT_DOUBLE_EQ(tm.arc(2, 3).distance, tm.get_distance(2, 3));
+    EXPECT_DOUBLE_EQ(tm.arc(3, 1).time, tm.get_time(3, 1));
+    EXPECT_THROW(tm.get_distance(4, 0), std::out_of_range);
+    EXPECT_THROW(tm.set_time(0, 4, 1.0), std::out_of_range);
+}
+
+TEST(TravelMatrixTest, CompactStorageModes) {
+    using namespace pdptw::problem;
+
+    MatrixStorageDetector integral;
+    integral.observe(12.0, 12.0);
+    integral.observe(7.0, 7.0);
+    EXPECT_EQ(integral.storage().precision, MatrixPrecision::UInt32);
+    EXPECT_TRUE(integral.storage().shared_time_distance);
+
+    MatrixStorageDetector halves;
+    halves.observe(1.5, 3.0);
+    EXPECT_EQ(halves.storage().precision, MatrixPrecision::Float32);
+    EXPECT_FALSE(halves.storage().shared_time_distance);
+
+    MatrixStorageDetector euclidean;
+    euclidean.observe(std::sqrt(2.0), std::sqrt(2.0));
+    EXPECT_EQ(euclidean.storage().precision, MatrixPrecision::Float64);
+
+    TravelMatrix shared(3, MatrixStorage{MatrixPrecision::UInt32, true});
+    shared.set_arc(0, 2, 42.0, 42.0);
+    EXPECT_DOUBLE_EQ(shared.arc(0, 2).distance, 42.0);
+    EXPECT_DOUBLE_EQ(shared.arc(0, 2).time, 42.0);
+    EXPECT_EQ(shared.memory_bytes(), 3u * 3u * sizeof(uint32_t));
+    EXPECT_THROW(shared.set_arc(0, 1, 1.0, 2.0), std::invalid_argument);
+    EXPECT_THROW(shared.set_distance(0, 1, 2.5), std::invalid_argument);
+
+    TravelMatrix narrow(2, MatrixStorage{MatrixPrecision::Float32, false});
+    narrow.set_arc(1, 0, 0.25, 0.5);
+    EXPECT_DOUBLE_EQ(narrow.get_distance(1, 0), 0.25);
+    EXPECT_DOUBLE_EQ(narrow.get_time(1, 0), 0.5);
+
+    // narrow_to thu gọn tại chỗ: cùng buffer, không cấp phát lại
+    TravelMatrix wide(2, MatrixStorage{MatrixPrecision::Float64, false});
+    wide.set_arc(0, 1, 1.5, 2.5);
+    const std::byte *before = wide.data();
+    wide.narrow_to(MatrixPrecision::Float32);
+    EXPECT_EQ(wide.data(), before);
+    EXPECT_EQ(wide.memory_bytes(), 2u * 2u * 2u * sizeof(float));
+    EXPECT_DOUBLE_EQ(wide.get_distance(0, 1), 1.5);
+    EXPECT_DOUBLE_EQ(wide.get_time(0, 1), 2.5);
+}
+
+TEST(TravelMatrixTest, TypedArcMatchesDispatchedArc) {
+    using namespace pdptw::problem;
+
+    TravelMatrix fixed(2, MatrixStorage{MatrixPrecision::UInt32, false});
+    fixed.set_arc(0, 1, 7.0, 9.0);
+    EXPECT_DOUBLE_EQ(fixed.arc_as<MatrixPrecision::UInt32>(0, 1).distance, 7.0);
+    EXPECT_DOUBLE_EQ(fixed.arc_as<MatrixPrecision::UInt32>(0, 1).time, 9.0);
+
+    // with_matrix_precision chọn đúng arc_as theo storage của ma trận
+    for (auto precision : {MatrixPrecision::Float64, MatrixPrecision::Float32, MatrixPrecision::UInt32}) {
+        TravelMatrix tm(3, MatrixStorage{precision, false});
+        tm.set_arc(2, 1, 4.0, 6.0);
+        TravelArc arc = with_matrix_precision(precision, [&](auto p) {
+            return tm.arc_as<decltype(p)::value>(2, 1);
+        });
+        EXPECT_DOUBLE_EQ(arc.distance, tm.arc(2, 1).distance);
+        EXPECT_DOUBLE_EQ(arc.time, tm.arc(2, 1).time);
+    }
+}
+
+TEST(TravelMatrixTest, BorrowRejectsMisalignedData) {
+    using namespace pdptw::problem;
+
+    alignas(8) std::byte storage[8 * 5] = {};
+    EXPECT_NO_THROW(TravelMatrix::borrow(2, MatrixStorage{MatrixPrecision::Float64, true}, storage, nullptr));
+    EXPECT_THROW(TravelMatrix::borrow(2, MatrixStorage{MatrixPrecision::Float64, true}, storage + 4, nullptr),
+                 std::invalid_argument);
+    EXPECT_NO_THROW(TravelMatrix::borrow(2, MatrixStorage{MatrixPrecision::Float32, true}, storage + 4, nullptr));
+    EXPECT_THROW(TravelMatrix::borrow(2, MatrixStorage{MatrixPrecision::UInt32, true}, storage + 2, nullptr),
+                 std::invalid_argument);
+}
+
 // PDPTWInstance tests
 TEST(PDPTWInstanceTest, BasicCreation) {
     using namespace pdptw::problem;
@@ -372,6 +465,166 @@ TEST(SolutionTest, ClearSolution) {
     EXPECT_EQ(solution.unassigned_requests().count(), instance.num_requests());
 }
 
+TEST(SolutionTest, RouteLookupFollowsLinks) {
+    using namespace pdptw::problem;
+    using namespace pdptw::solution;
+
+    auto instance = create_simple_instance();
+    Solution solution(instance);
+    solution.set({{0, 4, 5, 1}, {2, 6, 7, 3}});
+
+    EXPECT_TRUE(solution.is_request_assigned(0));
+    EXPECT_EQ(solution.route_of_request(0), 0);
+    EXPECT_EQ(solution.route_of_request(1), 1);
+    EXPECT_EQ(solution.route_of_node(7), 1);
+    EXPECT_EQ(solution.route_of_node(3), 1); // Depot thuộc vehicle của nó
+
+    // Chuyển request 0 sang route 1
+    solution.unassign_request(4);
+    EXPECT_FALSE(solution.is_request_assigned(0));
+    EXPECT_THROW(solution.route_of_request(0), std::runtime_error);
+    EXPECT_THROW(solution.route_of_node(5), std::runtime_error);
+    // Node vừa gỡ dùng cùng sentinel với node chưa từng gán: vn_id = chính nó
+    EXPECT_EQ(solution.vn_id(4), 4);
+    EXPECT_EQ(solution.vn_id(5), 5);
+
+    solution.relink_when_inserting_pd(2, 4, 7, 3);
+    solution.validate_between(7, 3);
+    EXPECT_EQ(solution.route_of_request(0), 1);
+    EXPECT_EQ(solution.route_of_node(5), 1);
+
+    // Copy giữ nguyên tra cứu; clear() gỡ mọi request
+    Solution copy = solution;
+    EXPECT_EQ(copy.route_of_node(4), 1);
+    copy.clear();
+    EXPECT_FALSE(copy.is_request_assigned(1));
+}
+
+TEST(SolutionTest, RoutePositionsAndPrecedence) {
+    using namespace pdptw::problem;
+    using namespace pdptw::solution;
+
+    auto instance = create_simple_instance();
+    Solution solution(instance);
+    solution.set({{0, 4, 6, 5, 7, 1}});
+
+    EXPECT_EQ(solution.position(0), 0);
+    EXPECT_EQ(solution.position(6), 2);
+    EXPECT_EQ(solution.position(1), 5);
+    EXPECT_TRUE(solution.is_before(4, 7));
+    EXPECT_FALSE(solution.is_before(7, 4));
+    EXPECT_FALSE(solution.is_before(4, 3)); // Khác route
+
+    // Gỡ request 0: vị trí phía sau được đánh lại
+    solution.begin_transaction();
+    solution.unassign_request(4);
+    EXPECT_EQ(solution.position(6), 1);
+    EXPECT_EQ(solution.position(7), 2);
+    EXPECT_EQ(solution.position(1), 3);
+
+    // Rollback trả lại vị trí cũ
+    solution.rollback_transaction();
+    EXPECT_EQ(solution.position(6), 2);
+    EXPECT_EQ(solution.position(1), 5);
+
+    solution.clear();
+    EXPECT_EQ(solution.position(1), 1);
+}
+
+TEST(SolutionTest, TransactionRollbackRestoresState) {
+    using namespace pdptw::problem;
+    using namespace pdptw::solution;
+
+    auto instance = create_simple_instance();
+    Solution solution(instance);
+    solution.set({{0, 4, 5, 1}});
+
+    const double objective = solution.objective();
+    const uint64_t version0 = solution.route_version(0);
+    const uint64_t version1 = solution.route_version(1);
+
+    // Chuyển request 0 từ vehicle 0 sang vehicle 1 (route 0 thành rỗng) rồi rollback
+    solution.begin_transaction();
+    EXPECT_THROW(solution.begin_transaction(), std::logic_error);
+    solution.unassign_request(4);
+    solution.relink_when_inserting_pd(2, 4, 2, 3);
+    solution.validate_between(2, 3);
+    solution.unassigned_requests().remove(4);
+
+    EXPECT_TRUE(solution.is_route_empty(0));
+    EXPECT_FALSE(solution.is_route_empty(1));
+    EXPECT_NE(solution.route_version(0), version0);
+    EXPECT_GT(solution.journaled_nodes(), 0u);
+
+    solution.rollback_transaction();
+
+    EXPECT_FALSE(solution.in_transaction());
+    EXPECT_FALSE(solution.is_route_empty(0));
+    EXPECT_TRUE(solution.is_route_empty(1));
+    EXPECT_EQ(solution.iter_route_by_vn_id(0), (std::vector<size_t>{0, 4, 5, 1}));
+    EXPECT_EQ(solution.succ(2), 3);
+    EXPECT_EQ(solution.unassigned_requests().count(), 1);
+    EXPECT_TRUE(solution.unassigned_requests().contains(6));
+    EXPECT_DOUBLE_EQ(solution.objective(), objective);
+    EXPECT_EQ(solution.route_version(0), version0);
+    EXPECT_EQ(solution.route_version(1), version1);
+
+    // Commit giữ nguyên thay đổi
+    solution.begin_transaction();
+    solution.unassign_request(4);
+    solution.commit_transaction();
+
+    EXPECT_TRUE(solution.is_route_empty(0));
+    EXPECT_EQ(solution.unassigned_requests().count(), instance.num_requests());
+}
+
+TEST(SolutionTest, ReplayRoutesCopiesJournaledRoutes) {
+    using namespace pdptw::problem;
+    using namespace pdptw::solution;
+
+    auto instance = create_simple_instance();
+    Solution target(instance);
+    target.set({{0, 4, 5, 1}, {2, 6, 7, 3}});
+    Solution source = target;
+    const uint64_t uid = target.uid();
+
+    // Chuyển request 0 sang sau request 1 trên vehicle 1 (route 0 thành rỗng)
+    source.begin_transaction();
+    source.unassign_request(4);
+    source.relink_when_inserting_pd(2, 4, 7, 3);
+    source.validate_between(7, 3);
+    source.unassigned_requests().remove(4);
+    std::vector<size_t> changed = source.journaled_routes();
+    std::sort(changed.begin(), changed.end());
+    EXPECT_EQ(changed, (std::vector<size_t>{0, 1}));
+    source.commit_transaction();
+
+    // Replay trong transaction rồi rollback: target trở lại như cũ
+    const double objective = target.objective();
+    target.begin_transaction();
+    target.replay_routes(source, changed);
+    EXPECT_TRUE(target.is_route_empty(0));
+    target.rollback_transaction();
+    EXPECT_EQ(target.iter_route(0), (std::vector<size_t>{0, 4, 5, 1}));
+    EXPECT_EQ(target.objective(), objective);
+
+    target.replay_routes(source, changed);
+    EXPECT_EQ(target.uid(), uid);
+    EXPECT_TRUE(target.is_route_empty(0));
+    EXPECT_EQ(target.iter_route(1), source.iter_route(1));
+    EXPECT_EQ(target.iter_route_ids(), (std::vector<size_t>{1}));
+    EXPECT_EQ(target.unassigned_requests().count(), 0u);
+    EXPECT_EQ(target.objective(), source.objective());
+    EXPECT_EQ(target.route_of_request(0), 1u);
+    EXPECT_TRUE(target.is_before(6, 4));
+
+    // Request bị gỡ ở source thì vào bank của target
+    source.unassign_complete_route(1);
+    target.replay_routes(source, {1});
+    EXPECT_EQ(target.unassigned_requests().count(), instance.num_requests());
+    EXPECT_EQ(target.objective(), source.objective());
+}
+
 TEST(SolutionTest, ObjectiveCalculation) {
     using namespace pdptw::problem;
     using namespace pdptw::solution;
@@ -400,6 +653,66 @@ TEST(SolutionTest, ObjectiveCalculation) {
     EXPECT_GT(cost, 0.0);    // Some travel cost
 }
 
+TEST(SolutionTest, RouteSummariesMatchRecomputation) {
+    using namespace pdptw::problem;
+    using namespace pdptw::solution;
+
+    auto instance = create_simple_instance();
+    Solution solution(instance);
+
+    // Tính lại từ đầu trên toàn bộ route và so với giá trị được duy trì
+    auto expect_consistent = [&] {
+        double distance = 0.0;
+        std::vector<size_t> route_ids;
+        for (size_t route_id = 0; route_id < instance.num_vehicles(); ++route_id) {
+            if (!solution.is_route_empty(route_id)) {
+                distance += solution.fw_data()[(route_id * 2) + 1].data.distance;
+                route_ids.push_back(route_id);
+            }
+        }
+        size_t unassigned = 0;
+        for (size_t request_id = 0; request_id < instance.num_requests(); ++request_id) {
+            unassigned += solution.unassigned_requests().contains_request(request_id) ? 1 : 0;
+        }
+        EXPECT_EQ(solution.total_cost(), distance);
+        EXPECT_EQ(solution.iter_route_ids(), route_ids);
+        EXPECT_EQ(solution.number_of_non_empty_routes(), route_ids.size());
+        EXPECT_EQ(solution.unassigned_requests().count(), unassigned);
+        EXPECT_EQ(solution.objective(), distance + unassigned * solution.unassigned_requests().penalty_per_entry());
+    };
+
+    expect_consistent();
+    solution.set({{0, 4, 5, 1}});
+    expect_consistent();
+    EXPECT_EQ(solution.number_of_non_empty_routes(), 1u);
+
+    // Chuyển request 0 sang vehicle 1 rồi rollback
+    const double objective = solution.objective();
+    solution.begin_transaction();
+    solution.unassign_request(4);
+    expect_consistent();
+    solution.relink_when_inserting_pd(2, 4, 2, 3);
+    solution.validate_between(2, 3);
+    solution.unassigned_requests().remove(4);
+    expect_consistent();
+    EXPECT_EQ(solution.iter_route_ids(), (std::vector<size_t>{1}));
+    solution.rollback_transaction();
+    expect_consistent();
+    EXPECT_EQ(solution.objective(), objective);
+
+    solution.unassign_complete_route(0);
+    expect_consistent();
+    EXPECT_EQ(solution.total_cost(), 0.0);
+
+    solution.set({{0, 4, 5, 1}, {2, 6, 7, 3}});
+    expect_consistent();
+    EXPECT_EQ(solution.number_of_non_empty_routes(), 2u);
+
+    solution.clear();
+    expect_consistent();
+    EXPECT_TRUE(solution.iter_route_ids().empty());
+}
+
 TEST(SolutionTest, IterateRoute) {
     using namespace pdptw::problem;
     using namespace pdptw::solution;
@@ -811,6 +1124,13 @@ TEST(REFNodeVecTest, ConstructionFromInstance) {
     EXPECT_EQ(node_vec[2].succ, 3);
     EXPECT_EQ(node_vec[3].vn_id, 2);
     EXPECT_EQ(node_vec[3].pred, 2);
+
+    // Request nodes chưa gán: cùng trạng thái như sau reset() (vn_id = succ = pred = chính nó)
+    for (size_t i = 2 * instance.num_vehicles(); i < node_vec.size(); ++i) {
+        EXPECT_EQ(node_vec[i].vn_id, i);
+        EXPECT_EQ(node_vec[i].succ, i);
+        EXPECT_EQ(node_vec[i].pred, i);
+    }
 }
 
 TEST(REFNodeVecTest, Reset) {
@@ -920,6 +1240,27 @@ TEST(REFNodeVecTest, IteratorSupport) {
     EXPECT_EQ(count, node_vec.size());
 }
 
+TEST(REFNodeVecTest, SharedNodesAndState) {
+    auto instance = create_simple_instance();
+    pdptw::solution::Solution solution(instance);
+
+    // fw/bw và bản copy dùng chung một mảng REFNode
+    pdptw::solution::Solution copy = solution;
+    EXPECT_EQ(solution.fw_data().shared_nodes(), solution.bw_data().shared_nodes());
+    EXPECT_EQ(solution.fw_data().shared_nodes(), copy.fw_data().shared_nodes());
+
+    pdptw::solution::REFNodeVec node_vec(instance);
+    auto saved = node_vec.state(4);
+    node_vec.relink(0, 4, 0, 1);
+    node_vec.extend_forward_unchecked(0, 4, instance);
+    EXPECT_EQ(node_vec.succ(0), 4);
+
+    node_vec.restore(4, saved);
+    EXPECT_EQ(node_vec.succ(4), 4);
+    EXPECT_EQ(node_vec.pred(4), 4);
+    EXPECT_EQ(node_vec.data(4).current_load, node_vec.node(4).demand);
+}
+
 // ============================================================================
 // BlockNode Tests
 // ============================================================================
@@ -1,12 +1,14 @@
 #include "pdptw/construction/constructor.hpp"
 #include "pdptw/lns/absence_counter.hpp"
 #include "pdptw/lns/repair/absence_based_regret.hpp"
+#include "pdptw/lns/repair/blink_insertion.hpp"
 #include "pdptw/lns/repair/greedy_insertion.hpp"
 #include "pdptw/lns/repair/hardest_first_insertion.hpp"
 #include "pdptw/lns/repair/regret_insertion.hpp"
 #include "pdptw/problem/pdptw.hpp"
 #include "pdptw/problem/travel_matrix.hpp"
 #include "pdptw/solution/datastructure.hpp"
+#include <cmath>
 #include <gtest/gtest.h>
 #include <memory>
 #include <random>
@@ -119,6 +121,83 @@ TEST_F(RepairTest, RegretInsertion_HandlesEmptySolution) {
     EXPECT_LT(solution.unassigned_requests().count(), 3);
 }
 
+// ==================== BlinkInsertion Tests ====================
+
+TEST_F(RepairTest, BlinkInsertion_OpensEmptyRouteOnlyAsFallback) {
+    Solution solution(*instance);
+    std::mt19937 rng(42);
+
+    // Không blink: request đầu mở một route, các request sau vừa route đó nên không mở thêm
+    BlinkInsertionOperator blink(0.0);
+    blink.repair(solution, rng);
+
+    EXPECT_EQ(solution.unassigned_requests().count(), 0);
+    EXPECT_EQ(solution.number_of_non_empty_routes(), 1);
+}
+
+TEST_F(RepairTest, BlinkInsertion_SkipsBlinkedPositions) {
+    Solution solution(*instance);
+    std::mt19937 rng(42);
+
+    // Blink mọi vị trí: chỉ chèn được bằng cách mở route rỗng (không blink), mỗi xe một request
+    BlinkInsertionOperator always_blink(1.0);
+    always_blink.repair(solution, rng);
+    EXPECT_EQ(solution.unassigned_requests().count(), 1);
+    EXPECT_EQ(solution.number_of_non_empty_routes(), 2);
+
+    // Tỉ lệ blink vừa phải: vẫn chèn được trên nhiều seed
+    for (unsigned seed : {1u, 7u, 123u}) {
+        Solution sol(*instance);
+        std::mt19937 seeded(seed);
+        BlinkInsertionOperator blink(0.3);
+        blink.repair(sol, seeded);
+        EXPECT_LT(sol.unassigned_requests().count(), 3);
+    }
+}
+
+TEST_F(RepairTest, BlinkInsertion_TriesEmptyRouteOfEveryVehicleClass) {
+    // Xe 0 không đủ tải cho request nào, xe 1 thì đủ: hai vehicle class khác nhau
+    std::vector<Vehicle> vehicles = {Vehicle(10, 1000), Vehicle(100, 1000)};
+    auto mixed = create_instance_with("mixed", 2, 3, vehicles, instance->nodes(), instance->shared_travel_matrix());
+    ASSERT_EQ(mixed.num_vehicle_classes(), 2u);
+
+    Solution solution(mixed);
+    std::mt19937 rng(42);
+    BlinkInsertionOperator blink(0.0);
+    blink.repair(solution, rng);
+
+    EXPECT_EQ(solution.unassigned_requests().count(), 0);
+    EXPECT_TRUE(solution.is_route_empty(0));
+    EXPECT_FALSE(solution.is_route_empty(1));
+}
+
+TEST_F(RepairTest, BlinkInsertion_ReusesSharedInsertionCache) {
+    auto cache = std::make_shared<InsertionCache>();
+    GreedyInsertionOperator greedy;
+    greedy.set_insertion_cache(cache);
+    BlinkInsertionOperator blink(0.0);
+    blink.set_insertion_cache(cache);
+
+    Solution solution(*instance);
+    std::mt19937 rng(42);
+    greedy.repair(solution, rng);
+    ASSERT_EQ(solution.unassigned_requests().count(), 0);
+    solution.unassign_request(instance->pickup_id_of_request(1));
+    Solution uncached = solution;
+
+    // Entry do greedy tính cho route không đổi được dùng lại, kết quả như khi không có cache
+    const size_t hits_before = cache->hits();
+    std::mt19937 rng_shared(7);
+    blink.repair(solution, rng_shared);
+    EXPECT_GT(cache->hits(), hits_before);
+
+    BlinkInsertionOperator fresh(0.0);
+    std::mt19937 rng_fresh(7);
+    fresh.repair(uncached, rng_fresh);
+    EXPECT_EQ(solution.unassigned_requests().count(), 0);
+    EXPECT_DOUBLE_EQ(solution.objective(), uncached.objective());
+}
+
 // ==================== HardestFirstInsertion Tests ====================
 
 TEST_F(RepairTest, HardestFirst_UsesAbsenceCounter) {
@@ -184,6 +263,125 @@ TEST_F(RepairTest, AbsenceRegret_DifferentAbsenceCounts) {
     EXPECT_LE(solution.unassigned_requests().count(), 2);
 }
 
+// ==================== Cost Cutoff Tests ====================
+
+TEST_F(RepairTest, CostCutoff_StopsAfterExceedingBound) {
+    std::mt19937 rng(42);
+    AbsenceCounter absence(3);
+    std::vector<std::unique_ptr<RepairOperator>> standard;
+    standard.push_back(std::make_unique<GreedyInsertionOperator>());
+    standard.push_back(std::make_unique<RegretInsertionOperator>());
+    standard.push_back(std::make_unique<BlinkInsertionOperator>(0.0));
+    std::vector<std::unique_ptr<AbsenceAwareRepairOperator>> absence_aware;
+    absence_aware.push_back(std::make_unique<HardestFirstInsertionOperator>());
+    absence_aware.push_back(std::make_unique<AbsenceBasedRegretOperator>());
+
+    // Route một request dài 30 > ngưỡng 25: dừng ngay sau lần chèn đầu
+    auto check = [&](auto &op, auto &&run) {
+        Solution cut(*instance);
+        op.set_cost_cutoff(25.0);
+        run(cut);
+        EXPECT_TRUE(op.aborted());
+        EXPECT_EQ(cut.unassigned_requests().count(), 2);
+
+        // Ngưỡng đủ lớn (hoặc không có ngưỡng): chạy hết như trước
+        for (std::optional<double> cutoff : {std::optional<double>(1e9), std::optional<double>()}) {
+            Solution full(*instance);
+            op.set_cost_cutoff(cutoff);
+            run(full);
+            EXPECT_FALSE(op.aborted());
+            EXPECT_EQ(full.unassigned_requests().count(), 0);
+        }
+    };
+    for (auto &op : standard) {
+        check(*op, [&](Solution &sol) { op->repair(sol, rng); });
+    }
+    for (auto &op : absence_aware) {
+        check(*op, [&](Solution &sol) { op->repair(sol, absence, rng); });
+    }
+}
+
+// Ngưỡng chỉ an toàn khi ma trận thoả bất đẳng thức tam giác: khi đó mọi lần repair bị
+// dừng sớm, nếu chạy hết cũng cho objective vượt ngưỡng (tức là sẽ bị từ chối)
+TEST_F(RepairTest, CostCutoff_AbortedRepairWouldBeRejected) {
+    // Instance Euclid không làm tròn, time window rộng
+    const size_t num_vehicles = 4;
+    const size_t num_requests = 16;
+    std::mt19937 gen(7);
+    std::uniform_real_distribution<double> coord(0.0, 100.0);
+    std::vector<Node> nodes;
+    for (size_t v = 0; v < num_vehicles; ++v) {
+        nodes.emplace_back(v * 2, 0, 0, NodeType::Depot, 50.0, 50.0, 0, 0.0, 10000.0, 0.0);
+        nodes.emplace_back(v * 2 + 1, 0, 0, NodeType::Depot, 50.0, 50.0, 0, 0.0, 10000.0, 0.0);
+    }
+    for (size_t r = 0; r < num_requests; ++r) {
+        size_t pickup_id = nodes.size();
+        nodes.emplace_back(pickup_id, r + 1, r + 1, NodeType::Pickup, coord(gen), coord(gen), 10, 0.0, 10000.0, 0.0);
+        nodes.emplace_back(pickup_id + 1, r + 1, r + 1, NodeType::Delivery, coord(gen), coord(gen), -10, 0.0,
+                           10000.0, 0.0);
+    }
+    auto matrix = std::make_shared<TravelMatrix>(nodes.size());
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        for (size_t j = 0; j < nodes.size(); ++j) {
+            double d = std::hypot(nodes[i].x() - nodes[j].x(), nodes[i].y() - nodes[j].y());
+            matrix->set_arc(i, j, d, d);
+        }
+    }
+    PDPTWInstance euclid("euclid", num_requests, num_vehicles, nodes,
+                         std::vector<Vehicle>(num_vehicles, Vehicle(30, 10000.0)), matrix);
+
+    // Điểm xuất phát: lời giải đầy đủ rồi gỡ một nửa số request
+    Solution start(euclid);
+    {
+        std::mt19937 rng(1);
+        GreedyInsertionOperator().repair(start, rng);
+        for (size_t r = 0; r < num_requests; r += 2) {
+            start.unassign_request(euclid.pickup_id_of_request(r));
+        }
+    }
+
+    AbsenceCounter absence(num_requests);
+    std::vector<std::unique_ptr<RepairOperator>> standard;
+    standard.push_back(std::make_unique<GreedyInsertionOperator>());
+    standard.push_back(std::make_unique<RegretInsertionOperator>());
+    standard.push_back(std::make_unique<BlinkInsertionOperator>(0.3));
+    std::vector<std::unique_ptr<AbsenceAwareRepairOperator>> absence_aware;
+    absence_aware.push_back(std::make_unique<HardestFirstInsertionOperator>());
+    absence_aware.push_back(std::make_unique<AbsenceBasedRegretOperator>());
+
+    size_t aborted_runs = 0;
+    auto check = [&](auto &op, auto &&run) {
+        for (unsigned seed = 0; seed < 4; ++seed) {
+            Solution full = start;
+            op.set_cost_cutoff(std::nullopt);
+            std::mt19937 full_rng(seed);
+            run(full, full_rng);
+
+            // Ngưỡng trải từ dưới chi phí hiện tại đến trên objective của lần chạy hết
+            for (double fraction : {0.9, 1.0, 1.05, 1.1, 1.2, 1.5}) {
+                const double bound = start.total_cost() * fraction;
+                Solution cut = start;
+                op.set_cost_cutoff(bound);
+                std::mt19937 cut_rng(seed);
+                run(cut, cut_rng);
+                if (op.aborted()) {
+                    ++aborted_runs;
+                    EXPECT_GT(full.objective(), bound);
+                } else {
+                    EXPECT_DOUBLE_EQ(cut.objective(), full.objective());
+                }
+            }
+        }
+    };
+    for (auto &op : standard) {
+        check(*op, [&](Solution &sol, std::mt19937 &rng) { op->repair(sol, rng); });
+    }
+    for (auto &op : absence_aware) {
+        check(*op, [&](Solution &sol, std::mt19937 &rng) { op->repair(sol, absence, rng); });
+    }
+    EXPECT_GT(aborted_runs, 0u);
+}
+
 // ==================== Integration Tests ====================
 
 TEST_F(RepairTest, AllOperators_WorkOnSameSolution) {
@@ -206,6 +404,14 @@ TEST_F(RepairTest, AllOperators_WorkOnSameSolution) {
         EXPECT_LT(sol.unassigned_requests().count(), 3);
     }
 
+    // Test blink
+    {
+        Solution sol(*instance);
+        BlinkInsertionOperator op;
+        op.repair(sol, rng);
+        EXPECT_LT(sol.unassigned_requests().count(), 3);
+    }
+
     // Test hardest-first
     {
         Solution sol(*instance);
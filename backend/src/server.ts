@@ -71,7 +71,10 @@ const jobQueue = new JobQueue({
 
 // Initialize Solver Worker
 const solverWorker = new SolverWorker(PDPTW_SOLVER_PATH, {
-    baseWorkDir: process.env.APP_WORK_DIR
+    baseWorkDir: process.env.APP_WORK_DIR,
+    instanceCacheDir: process.env.INSTANCE_CACHE_DIR,
+    instanceCacheMaxBytes: parseInt(process.env.INSTANCE_CACHE_MAX_MB || '2048', 10) * 1024 * 1024,
+    instanceCacheMaxAge: parseInt(process.env.INSTANCE_CACHE_MAX_AGE || '604800000', 10)
 });
 
 // Setup job processing
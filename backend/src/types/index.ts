@@ -137,6 +137,9 @@ export interface JobQueueOptions {
 export interface SolverWorkerOptions {
     baseWorkDir?: string;
     maxBuffer?: number;
+    instanceCacheDir?: string; // Thư mục cache .pdptwbin dùng chung giữa các job (--instance-cache)
+    instanceCacheMaxBytes?: number; // Tổng dung lượng tối đa của cache, xoá file dùng lâu nhất trước
+    instanceCacheMaxAge?: number; // ms, xoá file không được dùng lâu hơn
 }
 
 export interface JobCallbacks {
@@ -11,6 +11,9 @@ export class SolverWorker {
     private solverPath: string;
     private baseWorkDir: string;
     private maxBuffer: number;
+    private instanceCacheDir?: string;
+    private instanceCacheMaxBytes: number;
+    private instanceCacheMaxAge: number;
     private runningProcesses: Map<string, ChildProcess>;
 
     constructor(solverPath: string, options: SolverWorkerOptions = {}) {
@@ -18,6 +21,9 @@ export class SolverWorker {
         // Use backend/storage folder for temp files
         this.baseWorkDir = options.baseWorkDir || path.resolve(__dirname, '../../storage/temp');
         this.maxBuffer = options.maxBuffer || 10 * 1024 * 1024; // 10MB
+        this.instanceCacheDir = options.instanceCacheDir || undefined;
+        this.instanceCacheMaxBytes = options.instanceCacheMaxBytes ?? 2 * 1024 * 1024 * 1024; // 2GB
+        this.instanceCacheMaxAge = options.instanceCacheMaxAge ?? 7 * 24 * 60 * 60 * 1000; // 7 days
         this.runningProcesses = new Map();
 
         try {
@@ -101,6 +107,8 @@ export class SolverWorker {
             }
 
             onFail(error instanceof Error ? error.message : String(error));
+        } finally {
+            this.pruneInstanceCache();
         }
     }
 
@@ -198,6 +206,11 @@ export class SolverWorker {
             args.push('--format', params.format);
         }
 
+        // Binary instance cache shared across jobs (skips re-parsing unchanged instances)
+        if (this.instanceCacheDir) {
+            args.push('--instance-cache', this.instanceCacheDir);
+        }
+
         // Dynamic re-optimization parameters
         if (params.dynamic) {
             args.push('--dynamic');
@@ -370,6 +383,55 @@ export class SolverWorker {
         }
     }
 
+    /**
+     * Giới hạn thư mục instance cache: solver không bao giờ xoá file .pdptwbin, mtime là lần
+     * dùng gần nhất (solver cập nhật khi cache hit). Xoá file quá hạn tuổi, rồi xoá file dùng
+     * lâu nhất tới khi tổng dung lượng vừa giới hạn. File .tmp* là lần ghi dở của solver.
+     */
+    private pruneInstanceCache(): void {
+        if (!this.instanceCacheDir) return;
+
+        let names: string[];
+        try {
+            names = fs.readdirSync(this.instanceCacheDir);
+        } catch {
+            return; // Chưa có job nào ghi cache
+        }
+
+        const now = Date.now();
+        const files: { filePath: string; size: number; mtime: number }[] = [];
+        for (const name of names) {
+            if (!/\.pdptwbin(\.tmp\d+)?$/.test(name)) continue;
+            const filePath = path.join(this.instanceCacheDir, name);
+            try {
+                const stat = fs.statSync(filePath);
+                if (stat.isFile()) {
+                    files.push({ filePath, size: stat.size, mtime: stat.mtimeMs });
+                }
+            } catch {
+                // File vừa bị xoá bởi tiến trình khác
+            }
+        }
+
+        // Mới dùng nhất trước: giữ lại tới khi vượt dung lượng
+        files.sort((a, b) => b.mtime - a.mtime);
+        let keptBytes = 0;
+        for (const file of files) {
+            const expired = now - file.mtime > this.instanceCacheMaxAge;
+            if (!expired && keptBytes + file.size <= this.instanceCacheMaxBytes) {
+                keptBytes += file.size;
+                continue;
+            }
+            try {
+                fs.rmSync(file.filePath, { force: true });
+                console.log(`[SolverWorker] Pruned instance cache ${file.filePath}`);
+            } catch (err) {
+                // Windows không xoá được file đang được map: để lần dọn sau
+                console.warn(`[SolverWorker] Failed to prune ${file.filePath}:`, err instanceof Error ? err.message : String(err));
+            }
+        }
+    }
+
     /**
      * Validate solver executable
      */